@@ -2,36 +2,26 @@
 #include "main.h"
 #include "config.h"
 #include "database.h"
+#include "session_manager.h"
 #include "trade_points.h"
 #include "application_flow.h"
 #include "excel_generate.h"
 #include "user_data_types.h"
 #include "application_status.h"
 #include "message_to_client.h"
+#include "scheduled_jobs.h"
 #include <sstream>
 #include <random>
 #include <chrono>
-#include <cstdio>
 #include "logger.h"
+#include "metrics.h"
+#include "tracing.h"
 
-// Вспомогательный класс для замера времени выполнения
-class Timer {
-public:
-    Timer(TgBot::Bot& bot, int64_t chat_id) : bot_(bot), chat_id_(chat_id), start_(std::chrono::high_resolution_clock::now()) {}
-    ~Timer() {
-        auto end = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<double> diff = end - start_;
-        std::stringstream ss;
-        ss.precision(3);
-        ss << "Операция выполнена за " << std::fixed << diff.count() << " сек.";
-        LOG(LogLevel::INFO, "Timer for chat_id " << chat_id_ << ": " << ss.str());
-        bot_.getApi().sendMessage(chat_id_, ss.str());
-    }
-private:
-    TgBot::Bot& bot_;
-    int64_t chat_id_;
-    std::chrono::time_point<std::chrono::high_resolution_clock> start_;
-};
+// Гистограмма длительности операций админ-панели (время выгружается через /metrics)
+static Histogram& adminOperationLatency(const std::string& operation) {
+    return MetricsRegistry::instance().histogram("bot_admin_operation_duration_seconds",
+                                                 "Duration of admin panel operations", {{"operation", operation}});
+}
 
 // Обработка ввода имени администратора
 void handle_admin_name_input_message(TgBot::Bot& bot, TgBot::Message::Ptr message) {
@@ -45,7 +35,6 @@ void handle_admin_name_input_message(TgBot::Bot& bot, TgBot::Message::Ptr messag
     } else {
         user.admin_name = message->text;
         user.state = UserState::AWAITING_APPROVAL;
-        db_save_user_state(chat_id, user.state);
         send_approval_request(bot, chat_id, user.admin_name, user.admin_trade_point);
         LOG(LogLevel::INFO, "Admin registration: Request sent for name '" << user.admin_name << "', TP '" << user.admin_trade_point << "'");
     }
@@ -57,13 +46,14 @@ void handle_admin_otp_input_message(TgBot::Bot& bot, TgBot::Message::Ptr message
     UserData& user = user_session_data[chat_id];
 
     LOG(LogLevel::INFO, "Admin login: Received OTP input '" << message->text << "' from ID " << chat_id);
-    Timer timer(bot, chat_id);
-    if (admin_otps.count(chat_id) && admin_otps[chat_id] == message->text) {
+    ScopedLatency timer(adminOperationLatency("otp_login"));
+    const std::string otp = SessionManager::instance().getOtp(chat_id);
+    if (!otp.empty() && otp == message->text) {
         bot.getApi().sendMessage(chat_id, "Доступ разрешен. Добро пожаловать!");
-        admin_otps.erase(chat_id);
+        SessionManager::instance().removeOtp(chat_id);
+        cancelOtpExpiry(chat_id);
 
         admin_work_mode[chat_id] = AdminWorkMode::ADMIN_VIEW;
-        db_save_admin_work_mode(chat_id, AdminWorkMode::ADMIN_VIEW);
 
         sendAdminPanel(bot, chat_id);
         LOG(LogLevel::INFO, "Admin login: OTP successful for ID " << chat_id);
@@ -74,6 +64,31 @@ void handle_admin_otp_input_message(TgBot::Bot& bot, TgBot::Message::Ptr message
     }
 }
 
+static const char* const kReportPeriodPrefix = "Отчёт ";
+
+// Отчёт собирается в памяти и отправляется без временного файла
+static void send_report(TgBot::Bot& bot, int64_t chat_id, const std::string& trade_point, const ReportDateRange& range) {
+    bot.getApi().sendMessage(chat_id, "Начинаю генерацию отчета...");
+    ScopedLatency timer(adminOperationLatency("excel_report"));
+    try {
+        ReportFile report = generate_excel_report(trade_point, range);
+        if (report.rows == 0) {
+            bot.getApi().sendMessage(chat_id, "За выбранный период заявок нет.", false, 0, nullptr, "");
+            return;
+        }
+        bot.getApi().sendMessage(chat_id, "Отчет готов! Отправляю файл...", false, 0, nullptr, "");
+        auto file = std::make_shared<TgBot::InputFile>();
+        file->fileName = std::move(report.file_name);
+        file->mimeType = std::move(report.mime_type);
+        file->data = std::move(report.data);
+        bot.getApi().sendDocument(chat_id, file);
+        LOG(LogLevel::INFO, "Admin panel: report (" << report.rows << " rows) sent for TP '" << trade_point << "' by ID " << chat_id);
+    } catch (const std::exception& e) {
+        bot.getApi().sendMessage(chat_id, std::string("Ошибка при создании отчета: ") + e.what(), false, 0, nullptr, "");
+        LOG(LogLevel::L_ERROR, "Admin panel: Exception during report generation for TP '" << trade_point << "' by ID " << chat_id << ": " << e.what());
+    }
+}
+
 // Обработка кнопок из админ-панели
 void handle_admin_buttons_message(TgBot::Bot& bot, TgBot::Message::Ptr message) {
     int64_t chat_id = message->chat->id;
@@ -92,22 +107,15 @@ void handle_admin_buttons_message(TgBot::Bot& bot, TgBot::Message::Ptr message)
         sendApplicationsForReview(bot, chat_id, trade_point);
         LOG(LogLevel::INFO, "Admin panel: Viewing applications for TP '" << trade_point << "' by ID " << chat_id);
     } else if (message->text == "Выгрузить в Excel") {
-        bot.getApi().sendMessage(chat_id, "Начинаю генерацию отчета...");
-        Timer timer(bot, chat_id);
-        try {
-            std::string report_path = generate_excel_report(trade_point);
-            if (!report_path.empty()) {
-                bot.getApi().sendMessage(chat_id, "Отчет готов! Отправляю файл...", false, 0, nullptr, "");
-                bot.getApi().sendDocument(chat_id, TgBot::InputFile::fromFile(report_path, "application/vnd.openxmlformats-officedocument.spreadsheetml.sheet"));
-                remove(report_path.c_str());
-                LOG(LogLevel::INFO, "Admin panel: Excel report generated and sent for TP '" << trade_point << "' by ID " << chat_id);
-            } else {
-                 bot.getApi().sendMessage(chat_id, "Не удалось создать отчет.", false, 0, nullptr, "");
-                 LOG(LogLevel::L_ERROR, "Admin panel: Failed to generate Excel report for TP '" << trade_point << "' by ID " << chat_id);
-            }
-        } catch (const std::exception& e) {
-            bot.getApi().sendMessage(chat_id, std::string("Ошибка при создании отчета: ") + e.what(), false, 0, nullptr, "");
-            LOG(LogLevel::L_ERROR, "Admin panel: Exception during Excel report generation for TP '" << trade_point << "' by ID " << chat_id << ": " << e.what());
+        send_report(bot, chat_id, trade_point, {});
+    } else if (message->text == "Отчёт за период") {
+        bot.getApi().sendMessage(chat_id, "Отправьте период в виде:\n" + std::string(kReportPeriodPrefix) + "2026-09-01 2026-09-30\n(даты включительно, одна дата - отчёт за день)", false, 0, nullptr, "");
+    } else if (message->text.rfind(kReportPeriodPrefix, 0) == 0) {
+        ReportDateRange range;
+        if (parse_report_date_range(std::string_view(message->text).substr(std::string_view(kReportPeriodPrefix).size()), range)) {
+            send_report(bot, chat_id, trade_point, range);
+        } else {
+            bot.getApi().sendMessage(chat_id, "Неверный период. Пример: " + std::string(kReportPeriodPrefix) + "2026-09-01 2026-09-30", false, 0, nullptr, "");
         }
     } else if (message->text == "Выход из панели") {
         sendMainMenu(bot, chat_id);
@@ -119,6 +127,7 @@ void handle_admin_buttons_message(TgBot::Bot& bot, TgBot::Message::Ptr message)
 }
 
 void handle_admin_panel_message(TgBot::Bot& bot, TgBot::Message::Ptr message) {
+    TRACE_SPAN("handler", __func__);
     int64_t chat_id = message->chat->id;
     UserData& user = user_session_data[chat_id];
 
@@ -145,10 +154,8 @@ void handle_admin_panel_message(TgBot::Bot& bot, TgBot::Message::Ptr message) {
 
 void sendAdminPanel(TgBot::Bot& bot, int64_t chat_id) {
     user_session_data[chat_id].state = UserState::ADMIN_PANEL;
-    db_save_user_state(chat_id, user_session_data[chat_id].state);
 
     admin_work_mode[chat_id] = AdminWorkMode::ADMIN_VIEW;
-    db_save_admin_work_mode(chat_id, AdminWorkMode::ADMIN_VIEW);
 
     auto keyboard = std::make_shared<TgBot::ReplyKeyboardMarkup>();
     keyboard->resizeKeyboard = true;
@@ -163,6 +170,9 @@ void sendAdminPanel(TgBot::Bot& bot, int64_t chat_id) {
     auto excel_btn = std::make_shared<TgBot::KeyboardButton>();
     excel_btn->text = "Выгрузить в Excel";
     row2.push_back(excel_btn);
+    auto period_btn = std::make_shared<TgBot::KeyboardButton>();
+    period_btn->text = "Отчёт за период";
+    row2.push_back(period_btn);
     keyboard->keyboard.push_back(row2);
 
     std::vector<TgBot::KeyboardButton::Ptr> row3;
@@ -177,7 +187,12 @@ void sendAdminPanel(TgBot::Bot& bot, int64_t chat_id) {
 
 
 void sendApplicationsForReview(TgBot::Bot& bot, int64_t chat_id, const std::string& trade_point) {
-    auto requests = db_get_apps_data_for_report(trade_point);
+    // Курсор без дублей (DUPLICATE_OF); строки копируются, сообщения отправляются уже после чтения
+    std::vector<ApplicationDataForReport> requests;
+    db_for_each_report_row(trade_point, "", "", [&requests](const ApplicationDataForReport& app) {
+        requests.push_back(app);
+        return true;
+    });
     LOG(LogLevel::INFO, "Found " << requests.size() << " applications for TP '" << trade_point << "'");
 
     if (requests.empty()) {
@@ -229,7 +244,6 @@ void sendApplicationsForReview(TgBot::Bot& bot, int64_t chat_id, const std::stri
 
 void start_admin_registration(TgBot::Bot& bot, int64_t chat_id) {
     user_session_data[chat_id].state = UserState::AWAITING_ADMIN_TRADE_POINT_CHOICE;
-    db_save_user_state(chat_id, user_session_data[chat_id].state);
     std::vector<std::string> codes = get_all_trade_point_codes();
     LOG(LogLevel::INFO, "Started admin registration for ID " << chat_id << ". Found " << codes.size() << " trade points.");
 
@@ -258,7 +272,8 @@ void send_approval_request(TgBot::Bot& bot, int64_t new_admin_id, const std::str
 
 void send_otp(TgBot::Bot& bot, int64_t admin_id, const std::string& reason) {
     std::string otp = std::to_string(std::mt19937(std::random_device()())() % 900000 + 100000);
-    admin_otps[admin_id] = otp;
+    SessionManager::instance().setOtp(admin_id, otp);
+    scheduleOtpExpiry(admin_id);
     LOG(LogLevel::INFO, "Generated OTP '" << otp << "' for admin ID " << admin_id << " for reason: " << reason);
 
     std::stringstream text;
@@ -270,6 +285,7 @@ void send_otp(TgBot::Bot& bot, int64_t admin_id, const std::string& reason) {
 }
 
 void handle_admin_callbacks(TgBot::Bot& bot, TgBot::CallbackQuery::Ptr query) {
+    TRACE_SPAN("handler", __func__);
     int64_t chat_id = query->message->chat->id;
     int32_t message_id = query->message->messageId;
     UserData& user = user_session_data[chat_id];
@@ -279,7 +295,6 @@ void handle_admin_callbacks(TgBot::Bot& bot, TgBot::CallbackQuery::Ptr query) {
     if (query->data.rfind("admin_tp_", 0) == 0) {
         user.admin_trade_point = query->data.substr(9);
         user.state = UserState::AWAITING_ADMIN_NAME;
-        db_save_user_state(chat_id, user.state);
         bot.getApi().answerCallbackQuery(query->id);
         bot.getApi().editMessageText("Точка " + user.admin_trade_point + " выбрана. Теперь введите ваше имя:", chat_id, message_id);
         LOG(LogLevel::INFO, "Admin registration: TP selected '" << user.admin_trade_point << "' by ID " << chat_id);
@@ -349,7 +364,6 @@ void handle_admin_callbacks(TgBot::Bot& bot, TgBot::CallbackQuery::Ptr query) {
         db_update_chat_status(app_id, ChatStatus::InProgress, chat_id);
 
         user.state = UserState::ADMIN_REPLYING_TO_USER;
-        db_save_user_state(chat_id, user.state);
         auto keyboard = std::make_shared<TgBot::ReplyKeyboardMarkup>();
         keyboard->resizeKeyboard = true;
         auto cancel_btn = std::make_shared<TgBot::KeyboardButton>();
@@ -0,0 +1,150 @@
+#include "application_fingerprint.h"
+#include "utils.h"
+#include <openssl/sha.h>
+
+namespace
+{
+    // Служебные слова адреса после приведения к нижнему регистру. Слова с меткой задают тип
+    // следующего за ними номера и заменяются меткой перед ним ("корп. 12" -> "k12", "кв. 12" -> "a12"),
+    // чтобы номера корпуса и квартиры не совпадали; слова без метки отбрасываются
+    struct AddressWord
+    {
+        std::string_view word;
+        std::string_view tag;
+    };
+    const AddressWord kAddressWords[] = {{"г", ""}, {"гор", ""}, {"город", ""}, {"ул", ""}, {"улица", ""},
+                                         {"пр", ""}, {"пр-т", ""}, {"проспект", ""}, {"пер", ""}, {"переулок", ""},
+                                         {"д", "h"}, {"дом", "h"}, {"к", "k"}, {"корп", "k"}, {"корпус", "k"},
+                                         {"стр", "s"}, {"строение", "s"}, {"кв", "a"}, {"квартира", "a"},
+                                         {"не", ""}, {"указана", ""}};
+
+    const AddressWord *findAddressWord(std::string_view word)
+    {
+        for (const AddressWord &w : kAddressWords)
+        {
+            if (w.word == word)
+            {
+                return &w;
+            }
+        }
+        return nullptr;
+    }
+
+    // Символ text[i..] в нижнем регистре дописывается к word, если это буква, цифра или дефис
+    // (кириллица - двухбайтовые последовательности D0/D1); прочее - разделитель слов.
+    // Возвращает длину символа в байтах.
+    size_t appendLower(std::string_view text, size_t i, std::string &word, bool &is_word)
+    {
+        const unsigned char c = static_cast<unsigned char>(text[i]);
+        is_word = true;
+        if ((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || c == '-')
+        {
+            word += static_cast<char>(c);
+            return 1;
+        }
+        if (c >= 'A' && c <= 'Z')
+        {
+            word += static_cast<char>(c - 'A' + 'a');
+            return 1;
+        }
+        if ((c == 0xD0 || c == 0xD1) && i + 1 < text.size())
+        {
+            const unsigned char n = static_cast<unsigned char>(text[i + 1]);
+            if ((c == 0xD0 && n == 0x81) || (c == 0xD1 && n == 0x91)) // Ё, ё -> е
+            {
+                word += "\xD0\xB5";
+            }
+            else if (c == 0xD0 && n >= 0x90 && n <= 0x9F) // А-П
+            {
+                word += '\xD0';
+                word += static_cast<char>(n + 0x20);
+            }
+            else if (c == 0xD0 && n >= 0xA0 && n <= 0xAF) // Р-Я
+            {
+                word += '\xD1';
+                word += static_cast<char>(n - 0x20);
+            }
+            else
+            {
+                word.append(text.data() + i, 2);
+            }
+            return 2;
+        }
+        // Пунктуация, пробелы (в том числе юникодные) и прочие символы
+        is_word = false;
+        return c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : c >= 0xC0 ? 2 : 1;
+    }
+}
+
+std::string canonicalText(std::string_view text, bool drop_address_words)
+{
+    std::string result;
+    std::string word;
+    std::string_view tag; // метка последнего служебного слова, ставится перед следующим словом
+    auto flush = [&]()
+    {
+        if (word.empty())
+        {
+            return;
+        }
+        const AddressWord *address_word = drop_address_words ? findAddressWord(word) : nullptr;
+        if (address_word)
+        {
+            if (!address_word->tag.empty())
+            {
+                tag = address_word->tag;
+            }
+        }
+        else
+        {
+            if (!result.empty())
+            {
+                result += ' ';
+            }
+            result += tag;
+            result += word;
+            tag = {};
+        }
+        word.clear();
+    };
+    for (size_t i = 0; i < text.size();)
+    {
+        bool is_word = false;
+        i += appendLower(text, i, word, is_word);
+        if (!is_word)
+        {
+            flush();
+        }
+    }
+    flush();
+    return result;
+}
+
+std::string applicationFingerprint(std::string_view phone, std::string_view full_address, std::string_view tariff)
+{
+    std::string canonical;
+    NormalizedPhone normalized;
+    if (normalizePhone(phone, normalized))
+    {
+        canonical.assign(normalized.e164());
+    }
+    else
+    {
+        canonical = canonicalText(phone, false);
+    }
+    canonical += '\n';
+    canonical += canonicalText(full_address, true);
+    canonical += '\n';
+    canonical += canonicalText(tariff, false);
+
+    unsigned char digest[SHA256_DIGEST_LENGTH];
+    SHA256(reinterpret_cast<const unsigned char *>(canonical.data()), canonical.size(), digest);
+    static const char kHex[] = "0123456789abcdef";
+    std::string hex(2 * sizeof(digest), '0');
+    for (size_t i = 0; i < sizeof(digest); ++i)
+    {
+        hex[2 * i] = kHex[digest[i] >> 4];
+        hex[2 * i + 1] = kHex[digest[i] & 0x0F];
+    }
+    return hex;
+}
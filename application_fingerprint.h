@@ -0,0 +1,17 @@
+#pragma once
+#include <string>
+#include <string_view>
+
+/**
+ * Отпечаток заявки для поиска дублей: телефон (E.164), адрес и тариф после нормализации.
+ * Нормализация приводит текст к нижнему регистру (латиница и кириллица, ё -> е), режет его
+ * на слова из букв и цифр и отбрасывает служебные слова адреса ("г.", "ул.", "не указана"...);
+ * "д.", "корп.", "стр.", "кв." заменяются меткой при номере ("д. 5 кв. 12" -> "h5 a12"), поэтому
+ * заявки из WebApp и из анкеты в чате с одним адресом совпадают, а корпус 12 и квартира 12 - нет.
+ * Отпечаток - SHA-256 нормализованной строки в hex (64 символа), хранится в applications.FINGERPRINT.
+ */
+std::string applicationFingerprint(std::string_view phone, std::string_view full_address, std::string_view tariff);
+
+// Нормализованный текст: слова через один пробел; drop_address_words - убрать служебные слова адреса
+// (номер дома, корпуса, строения и квартиры получает метку h/k/s/a)
+std::string canonicalText(std::string_view text, bool drop_address_words);
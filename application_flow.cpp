@@ -1,8 +1,8 @@
 #include "application_flow.h"
 #include "main.h"
 #include "database.h"
+#include "session_manager.h"
 #include "trade_points.h"
-#include "utils.h"
 #include "config.h"
 #include "admin_panel.h"
 #include "faq_manager.h"
@@ -11,13 +11,16 @@
 #include "application_status.h"
 #include "message_to_client.h"
 #include "state_handler.h"
+#include "application_form.h"
 #include <sstream>
 #include <algorithm>
 #include "logger.h"
+#include "tracing.h"
 
 // Обработка кнопок главного меню.
 bool handle_main_menu_buttons(TgBot::Bot &bot, TgBot::Message::Ptr message)
 {
+    TRACE_SPAN("handler", __func__);
     int64_t chat_id = message->chat->id;
     UserData &user = user_session_data[chat_id];
 
@@ -29,7 +32,6 @@ bool handle_main_menu_buttons(TgBot::Bot &bot, TgBot::Message::Ptr message)
     if (message->text == "📝 Оставить заявку")
     {
         user_session_data[chat_id] = UserData();
-        db_save_user_state(chat_id, user_session_data[chat_id].state);
         sendTradePointSelection(bot, chat_id);
         return true;
     }
@@ -42,7 +44,6 @@ bool handle_main_menu_buttons(TgBot::Bot &bot, TgBot::Message::Ptr message)
     if (message->text == "🌐 Проверить возможность подключения")
     {
         user.state = UserState::AWAITING_ADDRESS_FOR_CHECK;
-        db_save_user_state(chat_id, user.state);
 
         auto removal_keyboard = std::make_shared<TgBot::ReplyKeyboardRemove>();
         bot.getApi().sendMessage(chat_id, "Убираю меню...", false, 0, removal_keyboard, "Markdown", true);
@@ -73,7 +74,6 @@ bool handle_main_menu_buttons(TgBot::Bot &bot, TgBot::Message::Ptr message)
         if (db_is_admin_approved(chat_id, trade_point))
         {
             user.state = UserState::AWAITING_ADMIN_PASSWORD;
-            db_save_user_state(chat_id, user.state);
             user.admin_trade_point = trade_point;
             send_otp(bot, chat_id, "входа в панель");
         }
@@ -102,6 +102,7 @@ bool handle_main_menu_buttons(TgBot::Bot &bot, TgBot::Message::Ptr message)
 // Обработка сообщений от клиента в зависимости от состояния.
 void handle_client_message(TgBot::Bot &bot, TgBot::Message::Ptr message)
 {
+    TRACE_SPAN("handler", __func__);
     int64_t chat_id = message->chat->id;
     UserData &user = user_session_data[chat_id];
 
@@ -117,19 +118,24 @@ void handle_client_message(TgBot::Bot &bot, TgBot::Message::Ptr message)
 
     if (message->text == "⬅️ Назад")
     {
+        // Шаги анкеты сами знают предыдущий шаг; false - возврат к выбору тарифа ниже
+        IStateHandler *handler = StateHandlerRegistry::instance().getHandler(user.state);
+        if (handler && handler->handleBack(bot, chat_id, user))
+        {
+            return;
+        }
         switch (user.state)
         {
         case UserState::VIEWING_TARIFF_DETAILS:
         case UserState::CHOOSING_TV:
         case UserState::ENTERING_NAME:
-            if (!user.selected_speed_option.value.empty())
+            if (user.tariff.has_speed())
             {
-                TgBot::InlineKeyboardMarkup::Ptr speed_keyboard = create_tariff_speed_buttons(user.selected_tariff.id);
+                TgBot::InlineKeyboardMarkup::Ptr speed_keyboard = create_tariff_speed_buttons(user.tariff.plan().id);
                 if (speed_keyboard)
                 {
-                    bot.getApi().sendMessage(chat_id, user.selected_tariff.get_tariff_description() + "\nВыберите желаемую скорость:", false, 0, nullptr, "Markdown", true);
+                    bot.getApi().sendMessage(chat_id, user.tariff.plan().get_tariff_description() + "\nВыберите желаемую скорость:", false, 0, nullptr, "Markdown", true);
                     user.state = UserState::VIEWING_TARIFF_DETAILS;
-                    db_save_user_state(chat_id, user.state);
                 }
                 else
                 {
@@ -141,30 +147,6 @@ void handle_client_message(TgBot::Bot &bot, TgBot::Message::Ptr message)
                 sendTariffSelection(bot, chat_id);
             }
             break;
-        case UserState::ENTERING_PHONE:
-            askForName(bot, chat_id);
-            break;
-        case UserState::CHOOSING_MESSENGER:
-            askForPhone(bot, chat_id);
-            break;
-        case UserState::ENTERING_EMAIL:
-            askForMessenger(bot, chat_id);
-            break;
-        case UserState::ENTERING_CITY:
-            askForEmail(bot, chat_id);
-            break;
-        case UserState::ENTERING_STREET:
-            askForCity(bot, chat_id);
-            break;
-        case UserState::ENTERING_HOUSE:
-            askForStreet(bot, chat_id);
-            break;
-        case UserState::ENTERING_HOUSE_BODY:
-            askForHouse(bot, chat_id);
-            break;
-        case UserState::ENTERING_APARTMENT:
-            askForHouseBody(bot, chat_id);
-            break;
         default:
             sendMainMenu(bot, chat_id);
             break;
@@ -181,217 +163,16 @@ void handle_client_message(TgBot::Bot &bot, TgBot::Message::Ptr message)
         return;
     }
 
-    switch (user.state)
+    // Анкета заявки и адрес для проверки - обработчики из StateHandlerRegistry (handler_registration.cpp)
+    if (IStateHandler *handler = StateHandlerRegistry::instance().getHandler(user.state))
     {
-    case UserState::AWAITING_ADDRESS_FOR_CHECK:
-    {
-        std::string address = message->text;
-        std::stringstream ss;
-        ss << "❗️*Запрос на проверку адреса!*\n\n"
-           << "👤 *Пользователь:* " << message->from->firstName << " " << message->from->lastName
-           << " (ID: `" << chat_id << "`)\n"
-           << "🏠 *Адрес:* " << address;
-        bot.getApi().sendMessage(config.main_admin_id, ss.str(), false, 0, nullptr, "Markdown");
-        bot.getApi().sendMessage(chat_id, "Спасибо! Ваш запрос на проверку адреса отправлен. Администратор свяжется с вами для уточнения деталей.");
-        sendMainMenu(bot, chat_id);
-        break;
-    }
-    case UserState::ENTERING_NAME:
-        if (isNotEmpty(message->text))
-        {
-            user.name = message->text;
-            askForPhone(bot, chat_id);
-        }
-        else
-        {
-            bot.getApi().sendMessage(chat_id, "Имя не может быть пустым.");
-        }
-        break;
-    case UserState::ENTERING_PHONE:
-    {
-        std::string phone_number = (message->contact != nullptr) ? message->contact->phoneNumber : message->text;
-        if (isValidPhone(phone_number))
-        {
-            user.phone = phone_number;
-            askForMessenger(bot, chat_id);
-        }
-        else
-        {
-            bot.getApi().sendMessage(chat_id, "Неверный формат. Введите 10 цифр или отправьте контакт.\nПример: 912 345 67 89");
-        }
-        break;
-    }
-    case UserState::ENTERING_EMAIL:
-        if (isValidEmail(message->text))
-        {
-            user.email = message->text;
-            askForCity(bot, chat_id);
-        }
-        else
-        {
-            bot.getApi().sendMessage(chat_id, "Неверный формат почты (например, user@example.com).");
-        }
-        break;
-    case UserState::ENTERING_CITY:
-        if (isNotEmpty(message->text))
-        {
-            user.city = message->text;
-            askForStreet(bot, chat_id);
-        }
-        else
-        {
-            bot.getApi().sendMessage(chat_id, "Название города не может быть пустым.");
-        }
-        break;
-    case UserState::ENTERING_STREET:
-        if (isNotEmpty(message->text))
-        {
-            user.street = message->text;
-            askForHouse(bot, chat_id);
-        }
-        else
-        {
-            bot.getApi().sendMessage(chat_id, "Название улицы не может быть пустым.");
-        }
-        break;
-    case UserState::ENTERING_HOUSE:
-        if (isNotEmpty(message->text))
-        {
-            user.house = message->text;
-            askForHouseBody(bot, chat_id);
-        }
-        else
-        {
-            bot.getApi().sendMessage(chat_id, "Номер дома не может быть пустым.");
-        }
-        break;
-    case UserState::ENTERING_HOUSE_BODY:
-        if (message->text != "Пропустить")
-        {
-            user.house_body = message->text;
-        }
-        else
-        {
-            user.house_body = "";
-        }
-        askForApartment(bot, chat_id);
-        break;
-    case UserState::ENTERING_APARTMENT:
-    {
-        if (message->text != "Пропустить")
-        {
-            user.apartment = message->text;
-        }
-        else
-        {
-            user.apartment = "не указана";
-        }
-
-        int total_monthly = std::stoi(user.selected_speed_option.price);
-        std::string rent_details = "";
-
-        if (!user.selected_tariff.router_rental.empty())
-        {
-            int router_cost = 0;
-            try
-            {
-                router_cost = std::stoi(user.selected_tariff.router_rental.substr(0, user.selected_tariff.router_rental.find(' ')));
-            }
-            catch (const std::exception &e)
-            {
-                LOG(LogLevel::L_ERROR, "Failed to parse router_rental price: " << user.selected_tariff.router_rental << " Error: " << e.what());
-            }
-            total_monthly += router_cost;
-            rent_details += user.selected_tariff.router_rental + " (роутер)";
-        }
-        if (user.needs_tv_box && !user.selected_tariff.tv_box_rental.empty())
-        {
-            int tv_box_cost = 0;
-            try
-            {
-                tv_box_cost = std::stoi(user.selected_tariff.tv_box_rental.substr(0, user.selected_tariff.tv_box_rental.find(' ')));
-            }
-            catch (const std::exception &e)
-            {
-                LOG(LogLevel::L_ERROR, "Failed to parse tv_box_rental price: " << user.selected_tariff.tv_box_rental << " Error: " << e.what());
-            }
-            total_monthly += tv_box_cost;
-            if (!rent_details.empty())
-                rent_details += " + ";
-            rent_details += user.selected_tariff.tv_box_rental + " (ТВ-приставка)";
-        }
-        if (rent_details.empty())
-        {
-            rent_details = "Нет";
-        }
-
-        int connection_fee = 0;
-        if (!user.selected_tariff.connection_fee.empty())
-        {
-            try
-            {
-                connection_fee = std::stoi(user.selected_tariff.connection_fee.substr(0, user.selected_tariff.connection_fee.find(' ')));
-            }
-            catch (const std::exception &e)
-            {
-                LOG(LogLevel::L_ERROR, "Failed to parse connection_fee price: " << user.selected_tariff.connection_fee << " Error: " << e.what());
-            }
-        }
-
-        std::stringstream client_invoice;
-        client_invoice << "*Ваша заявка сформирована:*\n\n"
-                       << "👤 *Имя:* " << user.name << "\n"
-                       << "📡 *Тариф:* " << user.final_tariff_string << "\n"
-                       << "🏠 *Адрес:* "
-                       << "г. " << user.city << ", ул. " << user.street << ", д. " << user.house;
-        if (!user.house_body.empty())
-            client_invoice << ", корп. " << user.house_body;
-        if (user.apartment != "не указана")
-            client_invoice << ", кв. " << user.apartment;
-        client_invoice << "\n\n*Расчет стоимости:*\n"
-                       << "Ежемесячная плата по тарифу: *" << user.selected_speed_option.price << " ₽*\n";
-        if (!user.selected_speed_option.promo_price_duration_months.empty())
-        {
-            client_invoice << "(акция: " << user.selected_speed_option.promo_price_duration_months << " мес, далее " << user.selected_speed_option.full_price << " ₽)\n";
-        }
-        client_invoice << "Аренда оборудования: *" << rent_details << "*\n"
-                       << "*Итого к оплате ежемесячно: " << total_monthly << " ₽*\n\n"
-                       << "*Единоразовый платеж за подключение: " << connection_fee << " ₽*";
-        bot.getApi().sendMessage(chat_id, client_invoice.str(), false, 0, nullptr, "Markdown");
-
-        std::string full_address = "г. " + user.city + ", ул. " + user.street + ", д. " + user.house;
-        if (!user.house_body.empty())
-        {
-            full_address += ", корп. " + user.house_body;
-        }
-        if (user.apartment != "не указана")
-        {
-            full_address += ", кв. " + user.apartment;
-        }
-
-        db_add_application(chat_id, user, full_address, total_monthly);
-
-        std::stringstream notification_text;
-        notification_text << "Имя: " << user.name << "\n"
-                          << "Телефон: " << user.phone << "\n"
-                          << "Тариф: " << user.final_tariff_string;
-        notifyAdminsOfNewApplication(bot, user.flyer_code, notification_text.str());
-
-        std::string final_message = "Ваша заявка принята. Скоро с вами свяжутся для уточнения деталей.\n\n"
-                                    "Для подключения интернета подойдите по адресу:\n*" +
-                                    user.office_address + "*\n\n"
-                                                          "**Не забудьте взять с собой паспорт!**";
-        bot.getApi().sendMessage(chat_id, final_message, false, 0, nullptr, "Markdown");
-        sendMainMenu(bot, chat_id);
-        break;
-    }
-    default:
-        break;
+        handler->handleMessage(bot, message, user);
     }
 }
 
 void handle_client_callback(TgBot::Bot &bot, TgBot::CallbackQuery::Ptr query)
 {
+    TRACE_SPAN("handler", __func__);
     int64_t chat_id = query->message->chat->id;
     int32_t message_id = query->message->messageId;
     UserData &user = user_session_data[chat_id];
@@ -442,22 +223,18 @@ void handle_client_callback(TgBot::Bot &bot, TgBot::CallbackQuery::Ptr query)
         bot.getApi().answerCallbackQuery(query->id);
 
         std::string tariff_id = query->data.substr(std::string("show_tariff_detail_").length());
-        TariffPlan selected_tariff = get_tariff_by_id(tariff_id);
-
-        if (selected_tariff.id.empty())
+        if (!user.tariff.select_tariff(tariff_id))
         {
             bot.getApi().sendMessage(chat_id, "Ошибка: тариф не найден.", false, 0, nullptr, "");
             sendTariffSelection(bot, chat_id);
             return;
         }
-
-        user.selected_tariff = selected_tariff;
+        const TariffPlan &selected_tariff = user.tariff.plan();
 
         TgBot::InlineKeyboardMarkup::Ptr speed_keyboard = create_tariff_speed_buttons(tariff_id);
 
         bot.getApi().editMessageText(selected_tariff.get_tariff_description(), chat_id, message_id, "", "Markdown", false, speed_keyboard);
         user.state = UserState::VIEWING_TARIFF_DETAILS;
-        db_save_user_state(chat_id, user.state);
         LOG(LogLevel::INFO, "User (ID: " << chat_id << ") is viewing details for tariff: " << selected_tariff.name);
         return;
     }
@@ -476,26 +253,13 @@ void handle_client_callback(TgBot::Bot &bot, TgBot::CallbackQuery::Ptr query)
         std::string speed_value = data_str.substr(first_underscore + 1, second_underscore - (first_underscore + 1));
         std::string speed_unit = data_str.substr(second_underscore + 1);
 
-        TariffPlan current_tariff = user.selected_tariff;
-        TariffSpeedOption selected_option;
-        bool found_speed = false;
-        for (const auto &opt : current_tariff.speeds)
-        {
-            if (opt.value == speed_value && opt.unit == speed_unit)
-            {
-                selected_option = opt;
-                found_speed = true;
-                break;
-            }
-        }
-
-        if (!found_speed)
+        if (!user.tariff.select_speed(speed_value, speed_unit))
         {
             bot.getApi().sendMessage(chat_id, "Ошибка: выбранная скорость не найдена для тарифа.", false, 0, nullptr, "");
             return;
         }
-
-        user.selected_speed_option = selected_option;
+        const TariffPlan &current_tariff = user.tariff.plan();
+        const TariffSpeedOption &selected_option = user.tariff.speed_option();
         user.final_tariff_string = current_tariff.name + " (" + selected_option.get_full_speed_text() + ")";
 
         bool needs_tv_box_choice = !current_tariff.tv_box_rental.empty();
@@ -503,7 +267,6 @@ void handle_client_callback(TgBot::Bot &bot, TgBot::CallbackQuery::Ptr query)
         if (needs_tv_box_choice)
         {
             user.state = UserState::CHOOSING_TV;
-            db_save_user_state(chat_id, user.state);
 
             auto tv_keyboard = std::make_shared<TgBot::InlineKeyboardMarkup>();
             std::vector<TgBot::InlineKeyboardButton::Ptr> row;
@@ -525,7 +288,7 @@ void handle_client_callback(TgBot::Bot &bot, TgBot::CallbackQuery::Ptr query)
         else
         {
             bot.getApi().editMessageText("✅ Выбрали: " + user.final_tariff_string, chat_id, message_id);
-            askForName(bot, chat_id);
+            ApplicationForm::instance().start(bot, chat_id);
             LOG(LogLevel::INFO, "User (ID: " << chat_id << ") proceeded to name input for tariff: " << user.final_tariff_string);
         }
         return;
@@ -548,23 +311,17 @@ void handle_client_callback(TgBot::Bot &bot, TgBot::CallbackQuery::Ptr query)
             choice_text += "\n❌ Без ТВ-приставки";
         }
         bot.getApi().editMessageText(choice_text, chat_id, message_id);
-        askForName(bot, chat_id);
+        ApplicationForm::instance().start(bot, chat_id);
         return;
     }
 
     if (query->data.rfind("messenger_", 0) == 0)
     {
-        if (user.state != UserState::CHOOSING_MESSENGER)
-            return;
-        if (query->data == "messenger_telegram")
-            user.preferred_messenger = "Telegram";
-        else if (query->data == "messenger_whatsapp")
-            user.preferred_messenger = "What'sApp";
-        else if (query->data == "messenger_max")
-            user.preferred_messenger = "MAX";
-        bot.getApi().answerCallbackQuery(query->id);
-        bot.getApi().editMessageText("Принято: " + user.preferred_messenger, chat_id, message_id);
-        askForEmail(bot, chat_id);
+        // Выбор мессенджера - шаг анкеты (application_form.cpp)
+        if (IStateHandler *handler = StateHandlerRegistry::instance().getHandler(user.state))
+        {
+            handler->handleCallback(bot, query, user);
+        }
         return;
     }
 
@@ -653,7 +410,6 @@ void sendMainMenu(TgBot::Bot &bot, int64_t chat_id)
     keyboard->resizeKeyboard = true;
     bot.getApi().sendMessage(chat_id, "Добро пожаловать в главное меню!", false, 0, keyboard);
     user_session_data[chat_id].state = UserState::NONE;
-    db_save_user_state(chat_id, UserState::NONE);
 }
 
 // Меню после подачи заявки (без кнопки "Оставить заявку" и "Помощь")
@@ -682,13 +438,11 @@ void sendPostApplicationMenu(TgBot::Bot &bot, int64_t chat_id)
     keyboard->resizeKeyboard = true;
     bot.getApi().sendMessage(chat_id, "Что вы хотите сделать дальше?", false, 0, keyboard);
     user_session_data[chat_id].state = UserState::NONE;
-    db_save_user_state(chat_id, UserState::NONE);
 }
 
 void sendTariffSelection(TgBot::Bot &bot, int64_t chat_id)
 {
     user_session_data[chat_id].state = UserState::CHOOSING_TARIFF;
-    db_save_user_state(chat_id, user_session_data[chat_id].state);
     auto removal_keyboard = std::make_shared<TgBot::ReplyKeyboardRemove>();
     bot.getApi().sendMessage(chat_id, "Загружаю тарифы...", false, 0, removal_keyboard);
 
@@ -699,7 +453,6 @@ void sendTariffSelection(TgBot::Bot &bot, int64_t chat_id)
 void sendTradePointSelection(TgBot::Bot &bot, int64_t chat_id)
 {
     user_session_data[chat_id].state = UserState::CHOOSING_FLYER_CODE;
-    db_save_user_state(chat_id, user_session_data[chat_id].state);
     auto removal_keyboard = std::make_shared<TgBot::ReplyKeyboardRemove>();
     bot.getApi().sendMessage(chat_id, "Загружаю список точек...", false, 0, removal_keyboard);
     std::vector<std::string> codes = get_all_trade_point_codes();
@@ -726,143 +479,123 @@ void sendTradePointSelection(TgBot::Bot &bot, int64_t chat_id)
     bot.getApi().sendMessage(chat_id, "Выберите код вашей торговой точки из списка:", false, 0, keyboard);
 }
 
-void askForName(TgBot::Bot &bot, int64_t chat_id)
-{
-    user_session_data[chat_id].state = UserState::ENTERING_NAME;
-    db_save_user_state(chat_id, user_session_data[chat_id].state);
-    sendBackButtonKeyboard(bot, chat_id, "Для оформления заявки введите ваше имя:");
-}
-
-void askForPhone(TgBot::Bot &bot, int64_t chat_id)
+// Цена в начале строки вида "150 ₽/мес"; 0 и запись в лог, если числа нет
+static int parseLeadingPrice(const std::string &text, const char *what)
 {
-    user_session_data[chat_id].state = UserState::ENTERING_PHONE;
-    db_save_user_state(chat_id, user_session_data[chat_id].state);
-    auto keyboard = std::make_shared<TgBot::ReplyKeyboardMarkup>();
-    auto contact_btn = std::make_shared<TgBot::KeyboardButton>();
-    contact_btn->text = "📱 Отправить мой контакт";
-    contact_btn->requestContact = true;
-    auto back_btn = std::make_shared<TgBot::KeyboardButton>();
-    back_btn->text = "⬅️ Назад";
-    keyboard->keyboard.push_back({contact_btn});
-    keyboard->keyboard.push_back({back_btn});
-    keyboard->resizeKeyboard = true;
-    bot.getApi().sendMessage(chat_id, "Спасибо! Теперь введите номер телефона для связи (10 цифр).\nПример: 912 345 67 89", false, 0, keyboard);
+    try
+    {
+        return std::stoi(text.substr(0, text.find(' ')));
+    }
+    catch (const std::exception &e)
+    {
+        LOG(LogLevel::L_ERROR, "Failed to parse " << what << " price: " << text << " Error: " << e.what());
+        return 0;
+    }
 }
 
-void askForMessenger(TgBot::Bot &bot, int64_t chat_id)
+std::string duplicateApplicationText(int64_t original_id)
 {
-    user_session_data[chat_id].state = UserState::CHOOSING_MESSENGER;
-    db_save_user_state(chat_id, user_session_data[chat_id].state);
-    auto messenger_keyboard = std::make_shared<TgBot::InlineKeyboardMarkup>();
-    std::vector<TgBot::InlineKeyboardButton::Ptr> messenger_row;
-    auto tg_btn = std::make_shared<TgBot::InlineKeyboardButton>();
-    tg_btn->text = "Телеграм";
-    tg_btn->callbackData = "messenger_telegram";
-    messenger_row.push_back(tg_btn);
-    auto wa_btn = std::make_shared<TgBot::InlineKeyboardButton>();
-    wa_btn->text = "What'sApp";
-    wa_btn->callbackData = "messenger_whatsapp";
-    messenger_row.push_back(wa_btn);
-    auto max_btn = std::make_shared<TgBot::InlineKeyboardButton>();
-    max_btn->text = "MAX";
-    max_btn->callbackData = "messenger_max";
-    messenger_row.push_back(max_btn);
-    messenger_keyboard->inlineKeyboard.push_back(messenger_row);
-    auto back_keyboard = std::make_shared<TgBot::ReplyKeyboardMarkup>();
-    auto back_btn = std::make_shared<TgBot::KeyboardButton>();
-    back_btn->text = "⬅️ Назад";
-    back_keyboard->keyboard.push_back({back_btn});
-    back_keyboard->resizeKeyboard = true;
-    bot.getApi().sendMessage(chat_id, "Принято! Куда вам будет удобнее написать?", false, 0, back_keyboard);
-    bot.getApi().sendMessage(chat_id, "Выберите мессенджер:", false, 0, messenger_keyboard);
+    return "Такая заявка уже принята (№" + std::to_string(original_id) +
+           ") и находится в работе. Повторно оформлять её не нужно - с вами свяжутся.";
 }
 
-void askForEmail(TgBot::Bot &bot, int64_t chat_id)
+std::string failedApplicationText()
 {
-    user_session_data[chat_id].state = UserState::ENTERING_EMAIL;
-    db_save_user_state(chat_id, user_session_data[chat_id].state);
-    auto keyboard = std::make_shared<TgBot::ReplyKeyboardMarkup>();
-    auto btn = std::make_shared<TgBot::KeyboardButton>();
-    btn->text = "⬅️ Назад";
-    keyboard->keyboard.push_back({btn});
-    keyboard->resizeKeyboard = true;
-    bot.getApi().sendMessage(chat_id, "Отлично! Теперь введите вашу электронную почту:", false, 0, keyboard);
+    return "Не удалось сохранить заявку из-за технической ошибки. Введённые данные сохранены - отправьте заявку ещё раз чуть позже.";
 }
 
-void askForCity(TgBot::Bot &bot, int64_t chat_id)
+// Последний шаг анкеты: расчёт стоимости, счёт клиенту, запись заявки и уведомление админов
+void submitApplication(TgBot::Bot &bot, int64_t chat_id, UserData &user)
 {
-    user_session_data[chat_id].state = UserState::ENTERING_CITY;
-    db_save_user_state(chat_id, user_session_data[chat_id].state);
-    auto keyboard = std::make_shared<TgBot::ReplyKeyboardMarkup>();
-    auto btn = std::make_shared<TgBot::KeyboardButton>();
-    btn->text = "⬅️ Назад";
-    keyboard->keyboard.push_back({btn});
-    keyboard->resizeKeyboard = true;
-    bot.getApi().sendMessage(chat_id, "Теперь начнем ввод адреса. Введите ваш город:", false, 0, keyboard);
-}
+    int total_monthly = 0;
+    try
+    {
+        total_monthly = std::stoi(user.tariff.speed_option().price);
+    }
+    catch (const std::exception &e)
+    {
+        LOG(LogLevel::L_ERROR, "Failed to parse tariff price: " << user.tariff.speed_option().price << " Error: " << e.what());
+    }
+    std::string rent_details = "";
 
-void askForStreet(TgBot::Bot &bot, int64_t chat_id)
-{
-    user_session_data[chat_id].state = UserState::ENTERING_STREET;
-    db_save_user_state(chat_id, user_session_data[chat_id].state);
-    auto keyboard = std::make_shared<TgBot::ReplyKeyboardMarkup>();
-    auto btn = std::make_shared<TgBot::KeyboardButton>();
-    btn->text = "⬅️ Назад";
-    keyboard->keyboard.push_back({btn});
-    keyboard->resizeKeyboard = true;
-    bot.getApi().sendMessage(chat_id, "Принято! Введите улицу:", false, 0, keyboard);
-}
+    if (!user.tariff.plan().router_rental.empty())
+    {
+        total_monthly += parseLeadingPrice(user.tariff.plan().router_rental, "router_rental");
+        rent_details += user.tariff.plan().router_rental + " (роутер)";
+    }
+    if (user.needs_tv_box && !user.tariff.plan().tv_box_rental.empty())
+    {
+        total_monthly += parseLeadingPrice(user.tariff.plan().tv_box_rental, "tv_box_rental");
+        if (!rent_details.empty())
+            rent_details += " + ";
+        rent_details += user.tariff.plan().tv_box_rental + " (ТВ-приставка)";
+    }
+    if (rent_details.empty())
+    {
+        rent_details = "Нет";
+    }
+    const int connection_fee = user.tariff.plan().connection_fee.empty() ? 0 : parseLeadingPrice(user.tariff.plan().connection_fee, "connection_fee");
 
-void askForHouse(TgBot::Bot &bot, int64_t chat_id)
-{
-    user_session_data[chat_id].state = UserState::ENTERING_HOUSE;
-    db_save_user_state(chat_id, user_session_data[chat_id].state);
-    auto keyboard = std::make_shared<TgBot::ReplyKeyboardMarkup>();
-    auto btn = std::make_shared<TgBot::KeyboardButton>();
-    btn->text = "⬅️ Назад";
-    keyboard->keyboard.push_back({btn});
-    keyboard->resizeKeyboard = true;
-    bot.getApi().sendMessage(chat_id, "Введите номер дома:", false, 0, keyboard);
-}
+    std::string full_address = "г. " + user.city + ", ул. " + user.street + ", д. " + user.house;
+    if (!user.house_body.empty())
+    {
+        full_address += ", корп. " + user.house_body;
+    }
+    if (user.apartment != "не указана")
+    {
+        full_address += ", кв. " + user.apartment;
+    }
 
-void askForHouseBody(TgBot::Bot &bot, int64_t chat_id)
-{
-    user_session_data[chat_id].state = UserState::ENTERING_HOUSE_BODY;
-    db_save_user_state(chat_id, user_session_data[chat_id].state);
-    auto keyboard = std::make_shared<TgBot::ReplyKeyboardMarkup>();
-    std::vector<TgBot::KeyboardButton::Ptr> row;
-    auto skip_btn = std::make_shared<TgBot::KeyboardButton>();
-    skip_btn->text = "Пропустить";
-    auto back_btn = std::make_shared<TgBot::KeyboardButton>();
-    back_btn->text = "⬅️ Назад";
-    row.push_back(skip_btn);
-    row.push_back(back_btn);
-    keyboard->keyboard.push_back(row);
-    keyboard->resizeKeyboard = true;
-    bot.getApi().sendMessage(chat_id, "Введите номер корпуса (если есть):", false, 0, keyboard);
-}
+    std::stringstream client_invoice;
+    client_invoice << "*Ваша заявка сформирована:*\n\n"
+                   << "👤 *Имя:* " << user.name << "\n"
+                   << "📡 *Тариф:* " << user.final_tariff_string << "\n"
+                   << "🏠 *Адрес:* " << full_address
+                   << "\n\n*Расчет стоимости:*\n"
+                   << "Ежемесячная плата по тарифу: *" << user.tariff.speed_option().price << " ₽*\n";
+    if (!user.tariff.speed_option().promo_price_duration_months.empty())
+    {
+        client_invoice << "(акция: " << user.tariff.speed_option().promo_price_duration_months << " мес, далее " << user.tariff.speed_option().full_price << " ₽)\n";
+    }
+    client_invoice << "Аренда оборудования: *" << rent_details << "*\n"
+                   << "*Итого к оплате ежемесячно: " << total_monthly << " ₽*\n\n"
+                   << "*Единоразовый платеж за подключение: " << connection_fee << " ₽*";
 
-void askForApartment(TgBot::Bot &bot, int64_t chat_id)
-{
-    user_session_data[chat_id].state = UserState::ENTERING_APARTMENT;
-    db_save_user_state(chat_id, user_session_data[chat_id].state);
-    auto keyboard = std::make_shared<TgBot::ReplyKeyboardMarkup>();
-    std::vector<TgBot::KeyboardButton::Ptr> row;
-    auto skip_btn = std::make_shared<TgBot::KeyboardButton>();
-    skip_btn->text = "Пропустить";
-    auto back_btn = std::make_shared<TgBot::KeyboardButton>();
-    back_btn->text = "⬅️ Назад";
-    row.push_back(skip_btn);
-    row.push_back(back_btn);
-    keyboard->keyboard.push_back(row);
-    keyboard->resizeKeyboard = true;
-    bot.getApi().sendMessage(chat_id, "Введите номер квартиры (если есть):", false, 0, keyboard);
+    // Повтор уже принятой заявки (в том числе из WebApp) админам не отправляется
+    const ApplicationInsertResult saved = db_add_application(chat_id, user, full_address, total_monthly);
+    if (saved.outcome == ApplicationInsertOutcome::Failed)
+    {
+        // Анкета остаётся на последнем шаге: повторный ответ снова отправит заявку
+        LOG(LogLevel::L_ERROR, "Application from user (ID: " << chat_id << ") was not saved");
+        bot.getApi().sendMessage(chat_id, failedApplicationText());
+        return;
+    }
+    if (saved.outcome == ApplicationInsertOutcome::Linked || saved.outcome == ApplicationInsertOutcome::Rejected)
+    {
+        LOG(LogLevel::INFO, "User (ID: " << chat_id << ") resubmitted application #" << saved.original_id);
+        bot.getApi().sendMessage(chat_id, duplicateApplicationText(saved.original_id));
+        sendMainMenu(bot, chat_id);
+        return;
+    }
+    bot.getApi().sendMessage(chat_id, client_invoice.str(), false, 0, nullptr, "Markdown");
+
+    std::stringstream notification_text;
+    notification_text << "Имя: " << user.name << "\n"
+                      << "Телефон: " << user.phone << "\n"
+                      << "Тариф: " << user.final_tariff_string;
+    notifyAdminsOfNewApplication(bot, user.flyer_code, notification_text.str());
+
+    std::string final_message = "Ваша заявка принята. Скоро с вами свяжутся для уточнения деталей.\n\n"
+                                "Для подключения интернета подойдите по адресу:\n*" +
+                                user.office_address + "*\n\n"
+                                                      "**Не забудьте взять с собой паспорт!**";
+    bot.getApi().sendMessage(chat_id, final_message, false, 0, nullptr, "Markdown");
+    sendMainMenu(bot, chat_id);
 }
 
 void sendHelpMenu(TgBot::Bot &bot, int64_t chat_id)
 {
     user_session_data[chat_id].state = UserState::HELP_SECTION;
-    db_save_user_state(chat_id, UserState::HELP_SECTION);
 
     auto keyboard = std::make_shared<TgBot::InlineKeyboardMarkup>();
     const auto &faq_entries = get_all_faq_entries();
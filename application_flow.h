@@ -13,15 +13,12 @@ enum class ApplicationStatus;
 void sendMainMenu(TgBot::Bot &bot, int64_t chat_id);
 void sendTariffSelection(TgBot::Bot &bot, int64_t chat_id);
 void sendTradePointSelection(TgBot::Bot &bot, int64_t chat_id);
-void askForName(TgBot::Bot &bot, int64_t chat_id); // Теперь для ФИО
-void askForPhone(TgBot::Bot &bot, int64_t chat_id);
-void askForMessenger(TgBot::Bot &bot, int64_t chat_id);
-void askForEmail(TgBot::Bot &bot, int64_t chat_id);
-void askForCity(TgBot::Bot &bot, int64_t chat_id);
-void askForStreet(TgBot::Bot &bot, int64_t chat_id);
-void askForHouse(TgBot::Bot &bot, int64_t chat_id);
-void askForHouseBody(TgBot::Bot &bot, int64_t chat_id);
-void askForApartment(TgBot::Bot &bot, int64_t chat_id);
+// Шаги анкеты заявки - application_form.h; после последнего шага вызывается submitApplication
+void submitApplication(TgBot::Bot &bot, int64_t chat_id, UserData &user);
+// Ответ клиенту на повтор уже принятой заявки (db_add_application: Linked/Rejected)
+std::string duplicateApplicationText(int64_t original_id);
+// Ответ клиенту, если заявку не удалось записать (db_add_application: Failed)
+std::string failedApplicationText();
 void sendHelpMenu(TgBot::Bot &bot, int64_t chat_id);
 bool handle_main_menu_buttons(TgBot::Bot &bot, TgBot::Message::Ptr message);
 void handle_client_message(TgBot::Bot &bot, TgBot::Message::Ptr message);
@@ -0,0 +1,260 @@
+#include "application_form.h"
+#include "application_flow.h"
+#include "session_manager.h"
+#include "logger.h"
+#include "utils.h"
+
+namespace
+{
+    const char *const kBackText = "⬅️ Назад";
+    const char *const kSkipText = "Пропустить";
+
+    // Анкета заявки: порядок строк - порядок шагов
+    const std::vector<FormStepDef> &applicationFormTable()
+    {
+        static const std::vector<FormStepDef> table = {
+            {UserState::ENTERING_NAME, FormField::NAME, FormValidator::NOT_EMPTY,
+             "Для оформления заявки введите ваше имя:", "Имя не может быть пустым.", nullptr, false, nullptr, {}},
+            {UserState::ENTERING_PHONE, FormField::PHONE, FormValidator::PHONE,
+             "Спасибо! Теперь введите номер телефона для связи (10 цифр).\nПример: 912 345 67 89",
+             "Неверный формат. Введите 10 цифр или отправьте контакт.\nПример: 912 345 67 89", nullptr, true, nullptr, {}},
+            {UserState::CHOOSING_MESSENGER, FormField::NONE, FormValidator::ANY,
+             "Принято! Куда вам будет удобнее написать?", nullptr, nullptr, false, "Выберите мессенджер:",
+             {{"Телеграм", "messenger_telegram", Messenger::TELEGRAM},
+              {"What'sApp", "messenger_whatsapp", Messenger::WHATSAPP},
+              {"MAX", "messenger_max", Messenger::MAX}}},
+            {UserState::ENTERING_EMAIL, FormField::EMAIL, FormValidator::EMAIL,
+             "Отлично! Теперь введите вашу электронную почту:", "Неверный формат почты (например, user@example.com).", nullptr, false, nullptr, {}},
+            {UserState::ENTERING_CITY, FormField::CITY, FormValidator::NOT_EMPTY,
+             "Теперь начнем ввод адреса. Введите ваш город:", "Название города не может быть пустым.", nullptr, false, nullptr, {}},
+            {UserState::ENTERING_STREET, FormField::STREET, FormValidator::NOT_EMPTY,
+             "Принято! Введите улицу:", "Название улицы не может быть пустым.", nullptr, false, nullptr, {}},
+            {UserState::ENTERING_HOUSE, FormField::HOUSE, FormValidator::NOT_EMPTY,
+             "Введите номер дома:", "Номер дома не может быть пустым.", nullptr, false, nullptr, {}},
+            {UserState::ENTERING_HOUSE_BODY, FormField::HOUSE_BODY, FormValidator::ANY,
+             "Введите номер корпуса (если есть):", nullptr, "", false, nullptr, {}},
+            {UserState::ENTERING_APARTMENT, FormField::APARTMENT, FormValidator::ANY,
+             "Введите номер квартиры (если есть):", nullptr, "не указана", false, nullptr, {}},
+        };
+        return table;
+    }
+
+    std::string *fieldOf(UserData &user, FormField field)
+    {
+        switch (field)
+        {
+        case FormField::NAME:
+            return &user.name;
+        case FormField::PHONE:
+            return &user.phone;
+        case FormField::EMAIL:
+            return &user.email;
+        case FormField::CITY:
+            return &user.city;
+        case FormField::STREET:
+            return &user.street;
+        case FormField::HOUSE:
+            return &user.house;
+        case FormField::HOUSE_BODY:
+            return &user.house_body;
+        case FormField::APARTMENT:
+            return &user.apartment;
+        default:
+            return nullptr;
+        }
+    }
+
+    // Проверяет ввод; PHONE заменяет value нормализованным номером
+    bool validate(FormValidator validator, std::string &value)
+    {
+        switch (validator)
+        {
+        case FormValidator::NOT_EMPTY:
+            return isNotEmpty(value);
+        case FormValidator::PHONE:
+            return isValidPhone(value);
+        case FormValidator::EMAIL:
+            return isValidEmail(value);
+        default:
+            return true;
+        }
+    }
+
+    TgBot::KeyboardButton::Ptr replyButton(const std::string &text, bool request_contact = false)
+    {
+        auto button = std::make_shared<TgBot::KeyboardButton>();
+        button->text = text;
+        button->requestContact = request_contact;
+        return button;
+    }
+
+    // Reply-клавиатура шага: контакт, "Пропустить", "Назад"
+    TgBot::GenericReply::Ptr buildReplyKeyboard(const FormStepDef &def)
+    {
+        auto keyboard = std::make_shared<TgBot::ReplyKeyboardMarkup>();
+        if (def.request_contact)
+        {
+            keyboard->keyboard.push_back({replyButton("📱 Отправить мой контакт", true)});
+        }
+        if (def.skip_value)
+        {
+            keyboard->keyboard.push_back({replyButton(kSkipText), replyButton(kBackText)});
+        }
+        else
+        {
+            keyboard->keyboard.push_back({replyButton(kBackText)});
+        }
+        keyboard->resizeKeyboard = true;
+        return keyboard;
+    }
+
+    TgBot::InlineKeyboardMarkup::Ptr buildChoiceKeyboard(const FormStepDef &def)
+    {
+        auto keyboard = std::make_shared<TgBot::InlineKeyboardMarkup>();
+        std::vector<TgBot::InlineKeyboardButton::Ptr> row;
+        for (const auto &choice : def.choices)
+        {
+            auto button = std::make_shared<TgBot::InlineKeyboardButton>();
+            button->text = choice.label;
+            button->callbackData = choice.callback_data;
+            row.push_back(button);
+        }
+        keyboard->inlineKeyboard.push_back(row);
+        return keyboard;
+    }
+}
+
+const ApplicationForm &ApplicationForm::instance()
+{
+    static const ApplicationForm form;
+    return form;
+}
+
+ApplicationForm::ApplicationForm()
+{
+    index_.fill(-1);
+    const auto &table = applicationFormTable();
+    steps_.reserve(table.size());
+    for (size_t i = 0; i < table.size(); ++i)
+    {
+        Step step;
+        step.def = table[i];
+        step.keyboard = buildReplyKeyboard(step.def);
+        if (step.def.choice_prompt)
+        {
+            step.choice_keyboard = buildChoiceKeyboard(step.def);
+        }
+        step.prev = static_cast<int>(i) - 1;
+        step.next = i + 1 < table.size() ? static_cast<int>(i) + 1 : -1;
+        index_[static_cast<size_t>(step.def.state)] = static_cast<int8_t>(i);
+        steps_.push_back(std::move(step));
+    }
+}
+
+std::vector<UserState> ApplicationForm::states() const
+{
+    std::vector<UserState> result;
+    result.reserve(steps_.size());
+    for (const auto &step : steps_)
+    {
+        result.push_back(step.def.state);
+    }
+    return result;
+}
+
+void ApplicationForm::enter(TgBot::Bot &bot, int64_t chat_id, UserState state) const
+{
+    const int index = indexOf(state);
+    if (index < 0)
+    {
+        LOG(LogLevel::L_ERROR, "Application form has no step for state " << static_cast<int>(state));
+        return;
+    }
+    const Step &step = steps_[index];
+    user_session_data[chat_id].state = state;
+    bot.getApi().sendMessage(chat_id, step.def.prompt, false, 0, step.keyboard);
+    if (step.choice_keyboard)
+    {
+        bot.getApi().sendMessage(chat_id, step.def.choice_prompt, false, 0, step.choice_keyboard);
+    }
+}
+
+void ApplicationForm::advance(TgBot::Bot &bot, int64_t chat_id, UserData &user, const Step &step) const
+{
+    if (step.next >= 0)
+    {
+        enter(bot, chat_id, steps_[step.next].def.state);
+    }
+    else
+    {
+        submitApplication(bot, chat_id, user);
+    }
+}
+
+bool ApplicationForm::handleInput(TgBot::Bot &bot, TgBot::Message::Ptr message, UserData &user) const
+{
+    const int index = indexOf(user.state);
+    if (index < 0)
+    {
+        return false;
+    }
+    const Step &step = steps_[index];
+    const int64_t chat_id = message->chat->id;
+    std::string *field = fieldOf(user, step.def.field);
+    if (!field)
+    {
+        return true; // шаг выбора ждёт нажатия кнопки
+    }
+
+    if (step.def.skip_value && message->text == kSkipText)
+    {
+        *field = step.def.skip_value;
+    }
+    else
+    {
+        // Пробелы по краям (в том числе неразрывные из копипаста) в анкету не попадают
+        std::string value(trimText(step.def.request_contact && message->contact ? message->contact->phoneNumber : message->text));
+        if (!validate(step.def.validator, value))
+        {
+            bot.getApi().sendMessage(chat_id, step.def.error);
+            return true;
+        }
+        *field = std::move(value);
+    }
+    advance(bot, chat_id, user, step);
+    return true;
+}
+
+bool ApplicationForm::handleChoice(TgBot::Bot &bot, TgBot::CallbackQuery::Ptr query, UserData &user) const
+{
+    const int index = indexOf(user.state);
+    if (index < 0)
+    {
+        return false;
+    }
+    const Step &step = steps_[index];
+    for (const auto &choice : step.def.choices)
+    {
+        if (query->data == choice.callback_data)
+        {
+            const int64_t chat_id = query->message->chat->id;
+            user.preferred_messenger = choice.value;
+            bot.getApi().answerCallbackQuery(query->id);
+            bot.getApi().editMessageText(std::string("Принято: ") + messengerName(choice.value), chat_id, query->message->messageId);
+            advance(bot, chat_id, user, step);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ApplicationForm::back(TgBot::Bot &bot, int64_t chat_id, UserData &user) const
+{
+    const int index = indexOf(user.state);
+    if (index < 0 || steps_[index].prev < 0)
+    {
+        return false;
+    }
+    enter(bot, chat_id, steps_[steps_[index].prev].def.state);
+    return true;
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include <tgbot/tgbot.h>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "user_data_types.h"
+
+// Поле UserData, которое заполняет шаг анкеты
+enum class FormField : uint8_t
+{
+    NONE,
+    NAME,
+    PHONE,
+    EMAIL,
+    CITY,
+    STREET,
+    HOUSE,
+    HOUSE_BODY,
+    APARTMENT
+};
+
+// Проверка ввода шага
+enum class FormValidator : uint8_t
+{
+    ANY,
+    NOT_EMPTY,
+    PHONE, // нормализует номер до 10 цифр
+    EMAIL
+};
+
+// Вариант выбора inline-кнопкой (шаг мессенджера)
+struct FormChoice
+{
+    const char *label;
+    const char *callback_data;
+    Messenger value;
+};
+
+// Строка таблицы анкеты (application_form.cpp): шаги идут в порядке заполнения,
+// "⬅️ Назад" ведёт к предыдущей строке
+struct FormStepDef
+{
+    UserState state;
+    FormField field;
+    FormValidator validator;
+    const char *prompt;
+    const char *error;         // ответ на неверный ввод
+    const char *skip_value;    // не nullptr - кнопка "Пропустить", значение поля при пропуске
+    bool request_contact;      // кнопка "Отправить мой контакт"
+    const char *choice_prompt; // не nullptr - шаг выбора: второе сообщение с inline-кнопками choices
+    std::vector<FormChoice> choices;
+};
+
+/**
+ * ApplicationForm - анкета заявки, собранная из таблицы шагов при первом обращении.
+ * Каждый шаг хранит заранее собранную клавиатуру и индексы соседних шагов, шаг по
+ * UserState находится через массив размером kUserStateCount - переходы O(1).
+ * Вход в шаг - смена состояния, постановка сессии в очередь записи и один sendMessage
+ * (шаг выбора мессенджера отправляет два: reply- и inline-клавиатуру нельзя совместить).
+ * После последнего шага вызывается submitApplication (application_flow.cpp).
+ */
+class ApplicationForm
+{
+public:
+    static const ApplicationForm &instance();
+
+    bool contains(UserState state) const { return indexOf(state) >= 0; }
+    UserState firstState() const { return steps_.front().def.state; }
+    // Состояния всех шагов в порядке анкеты
+    std::vector<UserState> states() const;
+
+    // Переход к шагу анкеты
+    void enter(TgBot::Bot &bot, int64_t chat_id, UserState state) const;
+    void start(TgBot::Bot &bot, int64_t chat_id) const { enter(bot, chat_id, firstState()); }
+
+    // Текстовый ввод (или контакт) на текущем шаге; false - пользователь не в анкете
+    bool handleInput(TgBot::Bot &bot, TgBot::Message::Ptr message, UserData &user) const;
+    // Нажатие inline-кнопки выбора; false - кнопка не относится к текущему шагу
+    bool handleChoice(TgBot::Bot &bot, TgBot::CallbackQuery::Ptr query, UserData &user) const;
+    // "⬅️ Назад": предыдущий шаг; false на первом шаге (возврат к выбору тарифа)
+    bool back(TgBot::Bot &bot, int64_t chat_id, UserData &user) const;
+
+private:
+    struct Step
+    {
+        FormStepDef def;
+        TgBot::GenericReply::Ptr keyboard;
+        TgBot::InlineKeyboardMarkup::Ptr choice_keyboard;
+        int next;
+        int prev;
+    };
+
+    ApplicationForm();
+    int indexOf(UserState state) const
+    {
+        const size_t index = static_cast<size_t>(state);
+        return index < index_.size() ? index_[index] : -1;
+    }
+    // Следующий шаг или отправка заявки после последнего
+    void advance(TgBot::Bot &bot, int64_t chat_id, UserData &user, const Step &step) const;
+
+    std::vector<Step> steps_;
+    std::array<int8_t, kUserStateCount> index_;
+};
@@ -0,0 +1,416 @@
+// Бенчмарки сессий, реестра обработчиков, каталогов, валидации (со сверкой с прежней реализацией), отчётов и планировщика
+#include "bench_env.h"
+#include "excel_generate.h"
+#include "scheduler.h"
+#include "session_manager.h"
+#include "state_handler.h"
+#include "super_admin.h"
+#include "tariff_manager.h"
+#include "trade_points.h"
+#include "user_data_types.h"
+#include "utils.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cctype>
+#include <random>
+#include <regex>
+
+namespace
+{
+    constexpr int kSessionUsers = 10000;
+
+    // Байты строки в куче (короткие строки живут внутри объекта - SSO)
+    size_t heapBytes(const std::string &s)
+    {
+        return s.capacity() > std::string().capacity() ? s.capacity() + 1 : 0;
+    }
+
+    size_t heapBytes(const TariffSpeedOption &o)
+    {
+        return heapBytes(o.value) + heapBytes(o.unit) + heapBytes(o.price) + heapBytes(o.promo_price_duration_months) + heapBytes(o.full_price);
+    }
+
+    size_t heapBytes(const TariffPlan &p)
+    {
+        size_t bytes = heapBytes(p.id) + heapBytes(p.name) + heapBytes(p.mobile_internet_gb) + heapBytes(p.mobile_minutes) +
+                       heapBytes(p.mobile_sms) + heapBytes(p.tv_channels) + heapBytes(p.router_rental) + heapBytes(p.tv_box_rental) +
+                       heapBytes(p.connection_fee) + heapBytes(p.internet_limit_gb) + p.speeds.capacity() * sizeof(TariffSpeedOption);
+        for (const auto &speed : p.speeds)
+        {
+            bytes += heapBytes(speed);
+        }
+        return bytes;
+    }
+
+    // Собственная память сессии; снимок каталога общий для всех сессий и не считается
+    size_t heapBytes(const UserData &u)
+    {
+        size_t bytes = 0;
+        for (const std::string *s : {&u.admin_trade_point, &u.admin_name, &u.temp_trade_point_code, &u.flyer_code, &u.office_address,
+                                     &u.final_tariff_string, &u.name, &u.phone, &u.email, &u.city, &u.street, &u.house,
+                                     &u.house_body, &u.apartment})
+        {
+            bytes += heapBytes(*s);
+        }
+        return bytes;
+    }
+
+    // Типичная сессия на шаге ввода адреса: тариф и скорость выбраны, контакты заполнены
+    UserData sampleSession()
+    {
+        UserData user;
+        user.state = UserState::ENTERING_CITY;
+        user.tariff.select_tariff(bench_dataset().tariff_ids.front());
+        const auto &speed = user.tariff.plan().speeds.front();
+        user.tariff.select_speed(speed.value, speed.unit);
+        user.final_tariff_string = user.tariff.plan().name + " (" + speed.get_full_speed_text() + ")";
+        user.flyer_code = bench_dataset().trade_points.front();
+        user.name = "Иванов Иван Иванович";
+        user.phone = "9123456789";
+        user.preferred_messenger = Messenger::TELEGRAM;
+        user.email = "ivanov@example.com";
+        return user;
+    }
+}
+
+// ========== SESSION MANAGER ==========
+
+// Общий мьютекс SessionManager: масштабирование по потокам показывает конкуренцию
+static void BM_SessionManager_GetUserData(benchmark::State &state)
+{
+    auto &sessions = SessionManager::instance();
+    if (state.thread_index() == 0)
+    {
+        for (int i = 0; i < kSessionUsers; ++i)
+        {
+            sessions.getUserData(bench_dataset().first_user_id + i);
+        }
+    }
+    int64_t i = state.thread_index() * 7919;
+    for (auto _ : state)
+    {
+        UserData &user = sessions.getUserData(bench_dataset().first_user_id + (i++ % kSessionUsers));
+        benchmark::DoNotOptimize(&user);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SessionManager_GetUserData)->ThreadRange(1, 8)->UseRealTime();
+
+static void BM_SessionManager_AdminModeMixed(benchmark::State &state)
+{
+    auto &sessions = SessionManager::instance();
+    int64_t i = state.thread_index() * 104729;
+    for (auto _ : state)
+    {
+        int64_t user_id = 700000000 + (i++ % 256);
+        if (i % 10 == 0)
+        {
+            sessions.setAdminMode(user_id, AdminWorkMode::ADMIN_VIEW);
+        }
+        else
+        {
+            benchmark::DoNotOptimize(sessions.getAdminMode(user_id));
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SessionManager_AdminModeMixed)->ThreadRange(1, 8)->UseRealTime();
+
+// Память одной сессии: sizeof(UserData) и её строки в куче. embedded_tariff_bytes - сколько
+// стоила бы копия выбранного TariffPlan и TariffSpeedOption в сессии (как было раньше).
+// Время итерации - копирование сессии (загрузка/снимок).
+static void BM_UserData_Footprint(benchmark::State &state)
+{
+    const UserData user = sampleSession();
+    for (auto _ : state)
+    {
+        UserData copy = user;
+        benchmark::DoNotOptimize(&copy);
+    }
+    state.counters["sizeof_user_data"] = sizeof(UserData);
+    state.counters["heap_bytes"] = static_cast<double>(heapBytes(user));
+    state.counters["embedded_tariff_bytes"] = static_cast<double>(sizeof(TariffPlan) + sizeof(TariffSpeedOption) +
+                                                                  heapBytes(user.tariff.plan()) + heapBytes(user.tariff.speed_option()));
+}
+BENCHMARK(BM_UserData_Footprint);
+
+// ========== STATE HANDLERS ==========
+
+static void BM_StateHandlerRegistry_GetHandler(benchmark::State &state)
+{
+    const auto &registry = StateHandlerRegistry::instance();
+    for (auto _ : state)
+    {
+        IStateHandler *handler = registry.getHandler(UserState::ENTERING_NAME);
+        benchmark::DoNotOptimize(handler);
+    }
+}
+BENCHMARK(BM_StateHandlerRegistry_GetHandler);
+
+// ========== CATALOGS ==========
+
+static void BM_Tariff_GetById(benchmark::State &state)
+{
+    const auto &ids = bench_dataset().tariff_ids;
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        TariffPlan plan = get_tariff_by_id(ids[i++ % ids.size()]);
+        benchmark::DoNotOptimize(plan.speeds.data());
+    }
+}
+BENCHMARK(BM_Tariff_GetById);
+
+static void BM_Tariff_SpeedButtons(benchmark::State &state)
+{
+    const auto &ids = bench_dataset().tariff_ids;
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        auto keyboard = create_tariff_speed_buttons(ids[i++ % ids.size()]);
+        benchmark::DoNotOptimize(keyboard.get());
+    }
+}
+BENCHMARK(BM_Tariff_SpeedButtons);
+
+static void BM_TradePoint_AddressByCode(benchmark::State &state)
+{
+    const auto &codes = bench_dataset().trade_points;
+    size_t i = 0;
+    std::string address;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(get_address_by_code(codes[i++ % codes.size()], address));
+    }
+}
+BENCHMARK(BM_TradePoint_AddressByCode);
+
+static void BM_TradePoint_GetAll(benchmark::State &state)
+{
+    for (auto _ : state)
+    {
+        auto points = get_all_trade_points();
+        benchmark::DoNotOptimize(points.data());
+    }
+}
+BENCHMARK(BM_TradePoint_GetAll);
+
+// ========== VALIDATION ==========
+
+namespace
+{
+    // Прежние реализации utils.cpp - эталон для сравнения поведения и скорости
+    bool legacyIsValidPhone(std::string &phone)
+    {
+        phone.erase(std::remove_if(phone.begin(), phone.end(), [](char c) { return !std::isdigit(static_cast<unsigned char>(c)); }), phone.end());
+        if (phone.length() == 11 && (phone[0] == '7' || phone[0] == '8'))
+        {
+            phone = phone.substr(1);
+        }
+        return phone.length() == 10;
+    }
+
+    bool legacyIsValidEmail(const std::string &email)
+    {
+        const std::regex pattern(R"(^([\w\.\-]+)@([\w\.\-]+)\.([\w]{2,})$)");
+        return std::regex_match(email, pattern);
+    }
+
+    const std::vector<std::string> &phoneInputs()
+    {
+        static const std::vector<std::string> inputs = {"+7 (912) 345-67-89", "89123456789", "912 345 67 89", "12345"};
+        return inputs;
+    }
+
+    const std::vector<std::string> &emailInputs()
+    {
+        static const std::vector<std::string> inputs = {"ivan.petrov@example.com", "client-42@mail.ru", "not-an-email", "a@b"};
+        return inputs;
+    }
+
+    // Случайная строка из символов, на которых грамматики различаются
+    std::string randomInput(std::mt19937 &rng)
+    {
+        static const char kAlphabet[] = "0123456789789+-() .@_aZx\xC2\xA0";
+        std::uniform_int_distribution<size_t> length(0, 16);
+        std::uniform_int_distribution<size_t> pick(0, sizeof(kAlphabet) - 2);
+        std::string s(length(rng), ' ');
+        for (char &c : s)
+        {
+            c = kAlphabet[pick(rng)];
+        }
+        return s;
+    }
+}
+
+static void BM_IsValidPhone_Legacy(benchmark::State &state)
+{
+    const auto &inputs = phoneInputs();
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        std::string phone = inputs[i++ % inputs.size()];
+        benchmark::DoNotOptimize(legacyIsValidPhone(phone));
+    }
+}
+BENCHMARK(BM_IsValidPhone_Legacy);
+
+static void BM_NormalizePhone(benchmark::State &state)
+{
+    const auto &inputs = phoneInputs();
+    size_t i = 0;
+    NormalizedPhone phone;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(normalizePhone(inputs[i++ % inputs.size()], phone));
+        benchmark::DoNotOptimize(phone);
+    }
+}
+BENCHMARK(BM_NormalizePhone);
+
+static void BM_IsValidEmail_Legacy(benchmark::State &state)
+{
+    const auto &inputs = emailInputs();
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(legacyIsValidEmail(inputs[i++ % inputs.size()]));
+    }
+}
+BENCHMARK(BM_IsValidEmail_Legacy);
+
+static void BM_IsValidEmail(benchmark::State &state)
+{
+    const auto &inputs = emailInputs();
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(isValidEmail(inputs[i++ % inputs.size()]));
+    }
+}
+BENCHMARK(BM_IsValidEmail);
+
+static void BM_TrimText(benchmark::State &state)
+{
+    const std::string input = "\xC2\xA0  Иван Петров\xE2\x80\x8B \n";
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(trimText(input));
+    }
+}
+BENCHMARK(BM_TrimText);
+
+// Дифференциальная проверка: новые isValidPhone/isValidEmail совпадают с прежними
+// на фиксированных примерах и на случайных строках; расхождение останавливает прогон
+// и даёт ненулевой код выхода bot_benchmarks
+static void BM_Validation_MatchesLegacy(benchmark::State &state)
+{
+    std::mt19937 rng(42);
+    std::vector<std::string> corpus = phoneInputs();
+    corpus.insert(corpus.end(), emailInputs().begin(), emailInputs().end());
+    corpus.insert(corpus.end(), {"", "@", "a@b.c", "a@.cc", "a@b.c-c", "a.b-c@d.e.ff", "a@b@c.dd", "_@_._1",
+                                 "79123456789", "69123456789", "+7 912 345 67 89 0", "абв9123456789"});
+    size_t checked = 0;
+    for (auto _ : state)
+    {
+        const std::string input = checked < corpus.size() ? corpus[checked] : randomInput(rng);
+        ++checked;
+        std::string phone = input;
+        std::string legacy_phone = input;
+        const bool phone_ok = isValidPhone(phone);
+        std::string mismatch;
+        if (phone_ok != legacyIsValidPhone(legacy_phone) || phone != legacy_phone)
+        {
+            mismatch = "isValidPhone differs on \"" + input + "\"";
+        }
+        else if (isValidEmail(input) != legacyIsValidEmail(input))
+        {
+            mismatch = "isValidEmail differs on \"" + input + "\"";
+        }
+        if (!mismatch.empty())
+        {
+            state.SkipWithError(mismatch.c_str());
+            bench_fail(mismatch);
+            break;
+        }
+    }
+    state.counters["inputs"] = static_cast<double>(checked);
+}
+BENCHMARK(BM_Validation_MatchesLegacy)->Iterations(50000);
+
+// ========== REPORTS ==========
+
+static void BM_GenerateReport(benchmark::State &state)
+{
+    const std::string &trade_point = bench_dataset().trade_points.front();
+    size_t bytes = 0;
+    for (auto _ : state)
+    {
+        ReportFile report = generate_excel_report(trade_point);
+        bytes = report.data.size();
+        benchmark::DoNotOptimize(report.data.data());
+    }
+    state.counters["bytes"] = static_cast<double>(bytes);
+    state.SetLabel(trade_point);
+}
+BENCHMARK(BM_GenerateReport)->Unit(benchmark::kMillisecond);
+
+// CSV-строка с разделителем, кавычками и переводом строки в полях
+static void BM_AppendCsvField(benchmark::State &state)
+{
+    const std::string fields[] = {"Иванов Иван", "г. Москва; ул. \"Тестовая\", д. 1", "строка 1\nстрока 2"};
+    std::string out;
+    for (auto _ : state)
+    {
+        out.clear();
+        for (const auto &field : fields)
+        {
+            append_csv_field(out, field);
+            out += ';';
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+}
+BENCHMARK(BM_AppendCsvField);
+
+// ========== SCHEDULER ==========
+
+// Колесо с range(0) таймерами на сроки до суток: продвижение на минуту с перевзводом сработавших
+static void BM_TimerWheel_Advance(benchmark::State &state)
+{
+    const uint64_t timers = static_cast<uint64_t>(state.range(0));
+    std::mt19937_64 rng(42);
+    TimerWheel wheel;
+    wheel.reset(1700000000);
+    for (uint64_t id = 1; id <= timers; ++id)
+    {
+        wheel.add(id, wheel.current() + 1 + rng() % 86400);
+    }
+    std::vector<uint64_t> due;
+    size_t fired = 0;
+    for (auto _ : state)
+    {
+        wheel.advance(wheel.current() + 60, due);
+        for (uint64_t id : due)
+        {
+            wheel.add(id, wheel.current() + 1 + rng() % 86400);
+        }
+        fired += due.size();
+        due.clear();
+    }
+    state.counters["fired_per_minute"] = benchmark::Counter(static_cast<double>(fired) / state.iterations());
+}
+BENCHMARK(BM_TimerWheel_Advance)->Arg(1000)->Arg(100000);
+
+static void BM_CronNext(benchmark::State &state)
+{
+    CronSchedule cron;
+    CronSchedule::parse("0 9 * * 1-5", cron);
+    int64_t t = 1767225600;
+    for (auto _ : state)
+    {
+        t = cron.next(t);
+        benchmark::DoNotOptimize(t);
+    }
+}
+BENCHMARK(BM_CronNext);
@@ -0,0 +1,396 @@
+// Бенчмарки всех db_* функций на временной БД из bench_env.
+// Пишущие бенчмарки идут парами (добавление/удаление), чтобы объём данных не расползался.
+#include "bench_env.h"
+#include "application_status.h"
+#include "database.h"
+#include "super_admin.h"
+#include "user_data_codec.h"
+#include "user_data_types.h"
+#include <benchmark/benchmark.h>
+
+namespace
+{
+    const std::string &tradePoint(size_t i)
+    {
+        const auto &codes = bench_dataset().trade_points;
+        return codes[i % codes.size()];
+    }
+
+    int64_t applicationId(size_t i)
+    {
+        return 1 + static_cast<int64_t>(i % bench_dataset().applications);
+    }
+
+    int64_t chatApplicationId(size_t i)
+    {
+        return 1 + static_cast<int64_t>(i % bench_dataset().chat_applications);
+    }
+
+    int64_t adminId(size_t i)
+    {
+        return 700000000 + static_cast<int64_t>(i % bench_dataset().admins);
+    }
+
+    UserData sampleApplication()
+    {
+        UserData data;
+        data.final_tariff_string = "Тариф 'РИИЛ Плюс' (500 Мбит/с)";
+        data.name = "Иванов Иван Иванович";
+        data.phone = "9123456789";
+        data.preferred_messenger = Messenger::TELEGRAM;
+        data.email = "ivanov@example.com";
+        data.flyer_code = bench_dataset().trade_points.front();
+        return data;
+    }
+}
+
+// ========== BOT SETTINGS ==========
+
+static void BM_Db_GetBotStatus(benchmark::State &state)
+{
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(db_get_bot_status());
+    }
+}
+BENCHMARK(BM_Db_GetBotStatus);
+
+static void BM_Db_SetBotStatus(benchmark::State &state)
+{
+    for (auto _ : state)
+    {
+        db_set_bot_status(true);
+    }
+}
+BENCHMARK(BM_Db_SetBotStatus);
+
+// ========== APPLICATIONS ==========
+
+// Новая заявка: поиск отпечатка не находит совпадения, вставка с FINGERPRINT
+static void BM_Db_AddApplication(benchmark::State &state)
+{
+    UserData data = sampleApplication();
+    static int64_t house = 0;
+    for (auto _ : state)
+    {
+        db_add_application(900000000, data, "г. Москва, ул. Тестовая, д. " + std::to_string(++house), 890);
+    }
+}
+BENCHMARK(BM_Db_AddApplication);
+
+// Повтор той же заявки: находится по уникальному индексу и связывается с первой (dedup_action = "link")
+static void BM_Db_AddApplication_Duplicate(benchmark::State &state)
+{
+    UserData data = sampleApplication();
+    db_add_application(900000000, data, "г. Москва, ул. Повторная, д. 1", 890);
+    for (auto _ : state)
+    {
+        db_add_application(900000000, data, "г. Москва, ул. Повторная, д. 1", 890);
+    }
+}
+BENCHMARK(BM_Db_AddApplication_Duplicate);
+
+static void BM_Db_GetMyApps(benchmark::State &state)
+{
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        std::string apps = db_get_my_apps(bench_dataset().first_user_id + static_cast<int64_t>(i++ % bench_dataset().users));
+        benchmark::DoNotOptimize(apps.data());
+    }
+}
+BENCHMARK(BM_Db_GetMyApps);
+
+static void BM_Db_GetAppsByTradePoint(benchmark::State &state)
+{
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        std::string apps = db_get_apps_by_trade_point(tradePoint(i++));
+        benchmark::DoNotOptimize(apps.data());
+    }
+}
+BENCHMARK(BM_Db_GetAppsByTradePoint)->Unit(benchmark::kMicrosecond);
+
+static void BM_Db_GetAllApplications(benchmark::State &state)
+{
+    for (auto _ : state)
+    {
+        auto rows = db_get_all_applications();
+        benchmark::DoNotOptimize(rows.data());
+    }
+}
+BENCHMARK(BM_Db_GetAllApplications)->Unit(benchmark::kMillisecond);
+
+// Счётчики /api/stats агрегатами вместо загрузки всей таблицы
+static void BM_Db_DashboardStats(benchmark::State &state)
+{
+    for (auto _ : state)
+    {
+        DashboardStats stats = db_get_dashboard_stats();
+        benchmark::DoNotOptimize(stats.applications);
+    }
+}
+BENCHMARK(BM_Db_DashboardStats)->Unit(benchmark::kMicrosecond);
+
+// Полный обход страницами, как в потоковом GET /api/applications
+static void BM_Db_ForEachApplicationPaged(benchmark::State &state)
+{
+    const size_t page = static_cast<size_t>(state.range(0));
+    for (auto _ : state)
+    {
+        int64_t before_id = INT64_MAX;
+        size_t total = 0;
+        size_t rows = 0;
+        do
+        {
+            rows = db_for_each_application(before_id, page, [&](const ApplicationDataForReport &app)
+                                           {
+                                               before_id = app.id;
+                                               return true;
+                                           });
+            total += rows;
+        } while (rows == page);
+        benchmark::DoNotOptimize(total);
+    }
+}
+BENCHMARK(BM_Db_ForEachApplicationPaged)->Arg(256)->Arg(4096)->Unit(benchmark::kMillisecond);
+
+static void BM_Db_GetApplicationById(benchmark::State &state)
+{
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        auto app = db_get_application_by_id(applicationId(i++ * 7));
+        benchmark::DoNotOptimize(app.has_value());
+    }
+}
+BENCHMARK(BM_Db_GetApplicationById);
+
+static void BM_Db_UpdateApplicationStatus(benchmark::State &state)
+{
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        db_update_application_status(applicationId(i++ * 13), ApplicationStatus::InProgress);
+    }
+}
+BENCHMARK(BM_Db_UpdateApplicationStatus);
+
+// ========== ADMINS ==========
+
+static void BM_Db_AdminRequestAddDecline(benchmark::State &state)
+{
+    for (auto _ : state)
+    {
+        db_add_admin_request(800000000, "Новый Админ", tradePoint(0));
+        db_decline_admin_request(800000000);
+    }
+}
+BENCHMARK(BM_Db_AdminRequestAddDecline);
+
+static void BM_Db_ApproveAdmin(benchmark::State &state)
+{
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        db_approve_admin(adminId(i++));
+    }
+}
+BENCHMARK(BM_Db_ApproveAdmin);
+
+static void BM_Db_IsAdminApproved(benchmark::State &state)
+{
+    size_t i = 0;
+    std::string trade_point;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(db_is_admin_approved(adminId(i++), trade_point));
+    }
+}
+BENCHMARK(BM_Db_IsAdminApproved);
+
+static void BM_Db_GetPendingAdminRequests(benchmark::State &state)
+{
+    for (auto _ : state)
+    {
+        auto requests = db_get_pending_admin_requests();
+        benchmark::DoNotOptimize(requests.data());
+    }
+}
+BENCHMARK(BM_Db_GetPendingAdminRequests);
+
+static void BM_Db_GetAdminIdsByTradePoint(benchmark::State &state)
+{
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        auto ids = db_get_admin_ids_by_trade_point(tradePoint(i++));
+        benchmark::DoNotOptimize(ids.data());
+    }
+}
+BENCHMARK(BM_Db_GetAdminIdsByTradePoint);
+
+static void BM_Db_GetAllAdmins(benchmark::State &state)
+{
+    for (auto _ : state)
+    {
+        auto admins = db_get_all_admins();
+        benchmark::DoNotOptimize(admins.data());
+    }
+}
+BENCHMARK(BM_Db_GetAllAdmins);
+
+static void BM_Db_ForEachAdmin(benchmark::State &state)
+{
+    for (auto _ : state)
+    {
+        size_t count = 0;
+        db_for_each_admin(true, [&](const AdminRequestData &)
+                          {
+                              ++count;
+                              return true;
+                          });
+        benchmark::DoNotOptimize(count);
+    }
+}
+BENCHMARK(BM_Db_ForEachAdmin);
+
+static void BM_Db_AdminAddDeleteManual(benchmark::State &state)
+{
+    for (auto _ : state)
+    {
+        db_add_admin_manual(800000001, "Ручной Админ", tradePoint(1));
+        db_delete_admin(800000001);
+    }
+}
+BENCHMARK(BM_Db_AdminAddDeleteManual);
+
+static void BM_Db_AdminExists(benchmark::State &state)
+{
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(db_admin_exists(adminId(i++)));
+    }
+}
+BENCHMARK(BM_Db_AdminExists);
+
+// ========== SESSIONS ==========
+
+// Запись сессии так, как её пишет write-behind SessionManager: состояние и DATA одной строкой
+static SessionRecord benchSessionRecord(int64_t user_id)
+{
+    UserData user{};
+    user.state = UserState::ENTERING_CITY;
+    user.name = "Иван Иванов";
+    user.phone = "+79123456789";
+    user.city = "Москва";
+    SessionRecord record;
+    record.user_id = user_id;
+    record.state = static_cast<int>(user.state);
+    record.data = encodeUserData(user);
+    return record;
+}
+
+static void BM_Db_SaveSession(benchmark::State &state)
+{
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        db_save_sessions({benchSessionRecord(bench_dataset().first_user_id + static_cast<int64_t>(i++ % bench_dataset().sessions))});
+    }
+}
+BENCHMARK(BM_Db_SaveSession);
+
+// Пакет одного сброса write-behind: range(0) сессий одной транзакцией
+static void BM_Db_SaveSessionsBatch(benchmark::State &state)
+{
+    std::vector<SessionRecord> batch;
+    for (int64_t k = 0; k < state.range(0); ++k)
+    {
+        batch.push_back(benchSessionRecord(bench_dataset().first_user_id + k % bench_dataset().sessions));
+    }
+    for (auto _ : state)
+    {
+        db_save_sessions(batch);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Db_SaveSessionsBatch)->Arg(64)->Arg(512)->Unit(benchmark::kMicrosecond);
+
+static void BM_Db_LoadSession(benchmark::State &state)
+{
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        SessionRecord record;
+        benchmark::DoNotOptimize(db_load_session(bench_dataset().first_user_id + static_cast<int64_t>(i++ % bench_dataset().sessions), record));
+    }
+}
+BENCHMARK(BM_Db_LoadSession);
+
+static void BM_Db_GetAdminWorkMode(benchmark::State &state)
+{
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(db_get_admin_work_mode(adminId(i++)));
+    }
+}
+BENCHMARK(BM_Db_GetAdminWorkMode);
+
+static void BM_Db_SaveDeleteSession(benchmark::State &state)
+{
+    for (auto _ : state)
+    {
+        db_save_sessions({benchSessionRecord(900000001)});
+        db_delete_session(900000001);
+    }
+}
+BENCHMARK(BM_Db_SaveDeleteSession);
+
+// ========== CHAT ==========
+
+static void BM_Db_UpdateChatStatus(benchmark::State &state)
+{
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        db_update_chat_status(chatApplicationId(i), ChatStatus::InProgress, adminId(i));
+        ++i;
+    }
+}
+BENCHMARK(BM_Db_UpdateChatStatus);
+
+static void BM_Db_AddChatMessage(benchmark::State &state)
+{
+    ChatMessage message{"admin", "Добрый день! Мастер приедет завтра с 10 до 12.", ""};
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        db_add_chat_message(chatApplicationId(i++), message);
+    }
+}
+BENCHMARK(BM_Db_AddChatMessage);
+
+static void BM_Db_GetChatHistory(benchmark::State &state)
+{
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        auto history = db_get_chat_history(chatApplicationId(i++));
+        benchmark::DoNotOptimize(history.data());
+    }
+}
+BENCHMARK(BM_Db_GetChatHistory);
+
+static void BM_Db_GetChatAdmin(benchmark::State &state)
+{
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(db_get_chat_admin(chatApplicationId(i++)));
+    }
+}
+BENCHMARK(BM_Db_GetChatAdmin);
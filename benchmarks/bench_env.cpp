@@ -0,0 +1,206 @@
+#include "bench_env.h"
+#include "database.h"
+#include "logger.h"
+#include "tariff_manager.h"
+#include "trade_points.h"
+#include "user_data_types.h"
+#include <sqlite3.h>
+#include <filesystem>
+#include <iostream>
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <process.h>
+#define bench_getpid _getpid
+#else
+#include <unistd.h>
+#define bench_getpid getpid
+#endif
+
+extern sqlite3 *db_main;
+
+namespace
+{
+    BenchDataset g_dataset;
+    std::filesystem::path g_work_dir;
+    std::filesystem::path g_prev_dir;
+    bool g_failed = false;
+
+    bool exec(const char *sql)
+    {
+        char *err = nullptr;
+        if (sqlite3_exec(db_main, sql, nullptr, nullptr, &err) != SQLITE_OK)
+        {
+            std::cerr << "SQL failed: " << (err ? err : "") << "\n";
+            sqlite3_free(err);
+            return false;
+        }
+        return true;
+    }
+
+    // Заполнение одной транзакцией через подготовленные выражения
+    bool seed()
+    {
+        BenchDataset &ds = g_dataset;
+        const size_t tp_count = ds.trade_points.size();
+
+        if (!exec("BEGIN;"))
+        {
+            return false;
+        }
+
+        sqlite3_stmt *app_stmt = nullptr;
+        sqlite3_prepare_v2(db_main,
+                           "INSERT INTO applications (USER_ID,TARIFF,PRICE,NAME,PHONE,MESSENGER,EMAIL,ADDRESS,FLYER_CODE,STATUS,CHAT_STATUS,CHAT_ADMIN_ID) "
+                           "VALUES (?,?,?,?,?,?,?,?,?,?,?,?);",
+                           -1, &app_stmt, nullptr);
+        static const char *statuses[] = {"Новая", "В работе", "Выполнена", "Отменена"};
+        for (int i = 0; i < ds.applications; ++i)
+        {
+            int64_t user_id = ds.first_user_id + i % ds.users;
+            std::string suffix = std::to_string(i);
+            std::string name = "Клиент Тестовый " + suffix;
+            std::string phone = "912" + std::to_string(1000000 + i % 9000000);
+            std::string email = "client" + suffix + "@example.com";
+            std::string address = "г. Москва, ул. Тестовая, д. " + std::to_string(1 + i % 300) + ", кв. " + std::to_string(1 + i % 150);
+            std::string tariff = ds.tariff_ids[i % ds.tariff_ids.size()] + " (500 Мбит/с)";
+            const std::string &tp = ds.trade_points[i % tp_count];
+
+            sqlite3_bind_int64(app_stmt, 1, user_id);
+            sqlite3_bind_text(app_stmt, 2, tariff.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(app_stmt, 3, "890 ₽/мес", -1, SQLITE_STATIC);
+            sqlite3_bind_text(app_stmt, 4, name.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(app_stmt, 5, phone.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(app_stmt, 6, "Telegram", -1, SQLITE_STATIC);
+            sqlite3_bind_text(app_stmt, 7, email.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(app_stmt, 8, address.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(app_stmt, 9, tp.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(app_stmt, 10, statuses[i % 4], -1, SQLITE_STATIC);
+            sqlite3_bind_text(app_stmt, 11, i < ds.chat_applications ? "InProgress" : "New", -1, SQLITE_STATIC);
+            sqlite3_bind_int64(app_stmt, 12, i < ds.chat_applications ? 700000000 + static_cast<int64_t>(i % tp_count) : 0);
+            sqlite3_step(app_stmt);
+            sqlite3_reset(app_stmt);
+        }
+        sqlite3_finalize(app_stmt);
+
+        sqlite3_stmt *admin_stmt = nullptr;
+        sqlite3_prepare_v2(db_main, "INSERT INTO admins (USER_ID,NAME,TRADE_POINT,IS_APPROVED) VALUES (?,?,?,?);", -1, &admin_stmt, nullptr);
+        for (int i = 0; i < ds.admins + ds.pending_admin_requests; ++i)
+        {
+            std::string name = "Админ " + std::to_string(i);
+            sqlite3_bind_int64(admin_stmt, 1, 700000000 + i);
+            sqlite3_bind_text(admin_stmt, 2, name.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(admin_stmt, 3, ds.trade_points[i % tp_count].c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_int(admin_stmt, 4, i < ds.admins ? 1 : 0);
+            sqlite3_step(admin_stmt);
+            sqlite3_reset(admin_stmt);
+        }
+        sqlite3_finalize(admin_stmt);
+
+        sqlite3_stmt *session_stmt = nullptr;
+        sqlite3_prepare_v2(db_main, "INSERT OR REPLACE INTO sessions (USER_ID,STATE) VALUES (?,?);", -1, &session_stmt, nullptr);
+        for (int i = 0; i < ds.sessions; ++i)
+        {
+            sqlite3_bind_int64(session_stmt, 1, ds.first_user_id + i);
+            sqlite3_bind_int(session_stmt, 2, i % 8 == 0 ? static_cast<int>(UserState::ENTERING_PHONE) : static_cast<int>(UserState::NONE));
+            sqlite3_step(session_stmt);
+            sqlite3_reset(session_stmt);
+        }
+        sqlite3_finalize(session_stmt);
+
+        sqlite3_stmt *msg_stmt = nullptr;
+        sqlite3_prepare_v2(db_main, "INSERT INTO conversations (APPLICATION_ID,SENDER,MESSAGE) VALUES (?,?,?);", -1, &msg_stmt, nullptr);
+        for (int app = 1; app <= ds.chat_applications; ++app)
+        {
+            for (int m = 0; m < ds.messages_per_chat; ++m)
+            {
+                sqlite3_bind_int64(msg_stmt, 1, app);
+                sqlite3_bind_text(msg_stmt, 2, m % 2 ? "client" : "admin", -1, SQLITE_STATIC);
+                sqlite3_bind_text(msg_stmt, 3, "Здравствуйте! Уточните, пожалуйста, удобное время для подключения.", -1, SQLITE_STATIC);
+                sqlite3_step(msg_stmt);
+                sqlite3_reset(msg_stmt);
+            }
+        }
+        sqlite3_finalize(msg_stmt);
+
+        return exec("COMMIT;");
+    }
+}
+
+bool bench_setup(const std::string &source_dir)
+{
+    // Логи db_* на уровне INFO исказили бы замеры
+    Logger::get().setMinLevel(LogLevel::L_ERROR);
+
+    try
+    {
+        load_trade_points(source_dir + "/json-cfg/trade_points.json");
+        load_tariff_plans(source_dir + "/json-cfg/tariff_plann.json");
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Failed to load catalogs: " << e.what() << "\n";
+        return false;
+    }
+
+    g_dataset.trade_points = get_all_trade_point_codes();
+    g_dataset.tariff_ids = get_all_tariff_main_ids();
+    if (g_dataset.trade_points.empty() || g_dataset.tariff_ids.empty())
+    {
+        std::cerr << "Trade point and tariff catalogs must not be empty\n";
+        return false;
+    }
+
+    // Объёмы порядка рабочей БД за год
+    g_dataset.first_user_id = 100000000;
+    g_dataset.users = 8000;
+    g_dataset.applications = 20000;
+    g_dataset.admins = static_cast<int>(g_dataset.trade_points.size()) * 2;
+    g_dataset.pending_admin_requests = 20;
+    g_dataset.sessions = 20000;
+    g_dataset.chat_applications = 2000;
+    g_dataset.messages_per_chat = 6;
+
+    // db_init открывает db/bot_data.db относительно текущей папки
+    g_prev_dir = std::filesystem::current_path();
+    g_work_dir = std::filesystem::temp_directory_path() / ("bot_benchmarks_" + std::to_string(bench_getpid()));
+    std::filesystem::remove_all(g_work_dir);
+    std::filesystem::create_directories(g_work_dir / "db");
+    std::filesystem::current_path(g_work_dir);
+
+    db_init();
+    if (!db_main)
+    {
+        return false;
+    }
+    if (!seed())
+    {
+        return false;
+    }
+    std::cerr << "Benchmark DB seeded in " << g_work_dir.string() << ": " << g_dataset.applications << " applications, "
+              << g_dataset.admins << " admins, " << g_dataset.sessions << " sessions\n";
+    return true;
+}
+
+void bench_teardown()
+{
+    db_close();
+    std::error_code ec;
+    std::filesystem::current_path(g_prev_dir, ec);
+    std::filesystem::remove_all(g_work_dir, ec);
+}
+
+const BenchDataset &bench_dataset()
+{
+    return g_dataset;
+}
+
+void bench_fail(const std::string &message)
+{
+    std::cerr << "Benchmark check failed: " << message << std::endl;
+    g_failed = true;
+}
+
+bool bench_failed()
+{
+    return g_failed;
+}
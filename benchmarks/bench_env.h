@@ -0,0 +1,35 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Окружение бенчмарков: каталоги тарифов и точек из json-cfg, временная папка
+ * с чистой БД db/bot_data.db, заполненной реалистичным объёмом данных.
+ * Все db_* функции работают с этой БД через глобальное соединение db_main.
+ */
+struct BenchDataset
+{
+    std::vector<std::string> trade_points;
+    std::vector<std::string> tariff_ids;
+
+    int64_t first_user_id = 0;
+    int users = 0;                // уникальных клиентов (по несколько заявок на каждого)
+    int applications = 0;         // строк в applications
+    int admins = 0;               // одобренных админов
+    int pending_admin_requests = 0;
+    int sessions = 0;             // строк в sessions
+    int chat_applications = 0;    // заявок с перепиской
+    int messages_per_chat = 0;
+};
+
+// Загружает каталоги, создаёт временную БД и заполняет её; false при ошибке
+bool bench_setup(const std::string &source_dir);
+// Закрывает БД и удаляет временную папку
+void bench_teardown();
+
+const BenchDataset &bench_dataset();
+
+// Проверка корректности внутри бенчмарка не прошла: bot_benchmarks завершится с кодом 1
+void bench_fail(const std::string &message);
+bool bench_failed();
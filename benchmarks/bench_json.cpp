@@ -0,0 +1,216 @@
+// Сериализация ответов HTTP API: прежний путь через nlohmann::json (дерево + dump())
+// против JsonWriter в переиспользуемый буфер. items_per_second - строки в секунду.
+#include "bench_env.h"
+#include "database.h"
+#include "json_writer.h"
+#include "tariff_manager.h"
+#include "trade_points.h"
+#include "user_data_types.h"
+#include <benchmark/benchmark.h>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+namespace
+{
+    // Одна страница /api/applications из БД бенчмарка
+    const std::vector<ApplicationDataForReport> &applicationPage()
+    {
+        static const std::vector<ApplicationDataForReport> rows = []()
+        {
+            std::vector<ApplicationDataForReport> page;
+            db_for_each_application(0, 256, [&page](const ApplicationDataForReport &app)
+                                    {
+                                        page.push_back(app);
+                                        return true;
+                                    });
+            return page;
+        }();
+        return rows;
+    }
+
+    const std::vector<AdminRequestData> &adminRows()
+    {
+        static const std::vector<AdminRequestData> rows = db_get_all_admins();
+        return rows;
+    }
+}
+
+// ========== APPLICATIONS ==========
+
+static void BM_Json_Applications_Nlohmann(benchmark::State &state)
+{
+    const auto &rows = applicationPage();
+    for (auto _ : state)
+    {
+        json apps = json::array();
+        for (const auto &app : rows)
+        {
+            apps.push_back({{"id", app.id},
+                            {"userId", app.user_id},
+                            {"name", app.name},
+                            {"phone", app.phone},
+                            {"email", app.email},
+                            {"tariff", app.tariff},
+                            {"address", app.address},
+                            {"status", app.chat_status},
+                            {"date", app.timestamp},
+                            {"price", app.price}});
+        }
+        std::string body = apps.dump();
+        benchmark::DoNotOptimize(body.data());
+    }
+    state.SetItemsProcessed(state.iterations() * rows.size());
+}
+BENCHMARK(BM_Json_Applications_Nlohmann);
+
+static void BM_Json_Applications_Writer(benchmark::State &state)
+{
+    const auto &rows = applicationPage();
+    std::string body;
+    for (auto _ : state)
+    {
+        body.clear();
+        JsonWriter w(body);
+        w.beginArray();
+        for (const auto &app : rows)
+        {
+            writeJson(w, app);
+        }
+        w.endArray();
+        benchmark::DoNotOptimize(body.data());
+    }
+    state.SetItemsProcessed(state.iterations() * rows.size());
+}
+BENCHMARK(BM_Json_Applications_Writer);
+
+// ========== ADMINS ==========
+
+static void BM_Json_Admins_Nlohmann(benchmark::State &state)
+{
+    const auto &rows = adminRows();
+    for (auto _ : state)
+    {
+        json admins = json::array();
+        for (const auto &admin : rows)
+        {
+            admins.push_back({{"userId", admin.user_id},
+                              {"name", admin.name},
+                              {"tradePoint", admin.trade_point},
+                              {"status", "active"}});
+        }
+        std::string body = admins.dump();
+        benchmark::DoNotOptimize(body.data());
+    }
+    state.SetItemsProcessed(state.iterations() * rows.size());
+}
+BENCHMARK(BM_Json_Admins_Nlohmann);
+
+static void BM_Json_Admins_Writer(benchmark::State &state)
+{
+    const auto &rows = adminRows();
+    std::string body;
+    for (auto _ : state)
+    {
+        body.clear();
+        JsonWriter w(body);
+        w.beginArray();
+        for (const auto &admin : rows)
+        {
+            writeJson(w, admin, true);
+        }
+        w.endArray();
+        benchmark::DoNotOptimize(body.data());
+    }
+    state.SetItemsProcessed(state.iterations() * rows.size());
+}
+BENCHMARK(BM_Json_Admins_Writer);
+
+// ========== CATALOGS ==========
+
+static void BM_Json_Tariffs_Nlohmann(benchmark::State &state)
+{
+    const auto catalog = get_tariff_catalog();
+    for (auto _ : state)
+    {
+        json result = json::array();
+        for (const auto &tariff : catalog->plans)
+        {
+            json speeds = json::array();
+            for (const auto &speed_opt : tariff.speeds)
+            {
+                speeds.push_back({{"speed", speed_opt.value + " " + speed_opt.unit},
+                                  {"price", speed_opt.price}});
+            }
+            result.push_back({{"id", tariff.id},
+                              {"name", tariff.name},
+                              {"speeds", speeds},
+                              {"addons", json::array()},
+                              {"connectionFee", tariff.connection_fee},
+                              {"routerRental", tariff.router_rental}});
+        }
+        std::string body = result.dump();
+        benchmark::DoNotOptimize(body.data());
+    }
+    state.SetItemsProcessed(state.iterations() * catalog->plans.size());
+}
+BENCHMARK(BM_Json_Tariffs_Nlohmann);
+
+static void BM_Json_Tariffs_Writer(benchmark::State &state)
+{
+    const auto catalog = get_tariff_catalog();
+    std::string body;
+    for (auto _ : state)
+    {
+        body.clear();
+        JsonWriter w(body);
+        w.beginArray();
+        for (const auto &tariff : catalog->plans)
+        {
+            writeJson(w, tariff);
+        }
+        w.endArray();
+        benchmark::DoNotOptimize(body.data());
+    }
+    state.SetItemsProcessed(state.iterations() * catalog->plans.size());
+}
+BENCHMARK(BM_Json_Tariffs_Writer);
+
+static void BM_Json_TradePoints_Nlohmann(benchmark::State &state)
+{
+    const auto points = get_all_trade_points();
+    for (auto _ : state)
+    {
+        json result = json::array();
+        for (const auto &point : points)
+        {
+            result.push_back({{"code", point.code},
+                              {"name", point.name},
+                              {"address", point.address}});
+        }
+        std::string body = result.dump();
+        benchmark::DoNotOptimize(body.data());
+    }
+    state.SetItemsProcessed(state.iterations() * points.size());
+}
+BENCHMARK(BM_Json_TradePoints_Nlohmann);
+
+static void BM_Json_TradePoints_Writer(benchmark::State &state)
+{
+    const auto points = get_all_trade_points();
+    std::string body;
+    for (auto _ : state)
+    {
+        body.clear();
+        JsonWriter w(body);
+        w.beginArray();
+        for (const auto &point : points)
+        {
+            writeJson(w, point);
+        }
+        w.endArray();
+        benchmark::DoNotOptimize(body.data());
+    }
+    state.SetItemsProcessed(state.iterations() * points.size());
+}
+BENCHMARK(BM_Json_TradePoints_Writer);
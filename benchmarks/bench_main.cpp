@@ -0,0 +1,55 @@
+// bot_benchmarks - микробенчмарки основных модулей (Google Benchmark).
+//
+// По умолчанию результаты дополнительно пишутся в bot_benchmarks.json,
+// чтобы сравнивать релизы: compare.py из Google Benchmark или любой diff по JSON.
+//   bot_benchmarks --benchmark_filter=BM_Db --benchmark_out=release.json
+#include "bench_env.h"
+#include <benchmark/benchmark.h>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#ifndef BOT_SOURCE_DIR
+#define BOT_SOURCE_DIR "."
+#endif
+
+int main(int argc, char **argv)
+{
+    // Путь к JSON фиксируем до смены текущей папки в bench_setup
+    std::string default_out = "--benchmark_out=" + (std::filesystem::current_path() / "bot_benchmarks.json").string();
+    std::string default_format = "--benchmark_out_format=json";
+
+    std::vector<char *> args(argv, argv + argc);
+    bool has_out = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        has_out = has_out || std::strncmp(argv[i], "--benchmark_out=", 16) == 0;
+    }
+    if (!has_out)
+    {
+        args.push_back(default_out.data());
+        args.push_back(default_format.data());
+    }
+    int args_count = static_cast<int>(args.size());
+
+    benchmark::Initialize(&args_count, args.data());
+    if (benchmark::ReportUnrecognizedArguments(args_count, args.data()))
+    {
+        return 1;
+    }
+
+    if (!bench_setup(BOT_SOURCE_DIR))
+    {
+        bench_teardown();
+        return 1;
+    }
+    benchmark::AddCustomContext("applications", std::to_string(bench_dataset().applications));
+    benchmark::AddCustomContext("sessions", std::to_string(bench_dataset().sessions));
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    bench_teardown();
+    return bench_failed() ? 1 : 0;
+}
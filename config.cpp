@@ -33,6 +33,134 @@ void load_config(const std::string &path)
         {
             config.webapp_url = data["webapp_url"].get<std::string>();
         }
+        if (data.contains("api_base_url"))
+        {
+            config.api_base_url = data["api_base_url"].get<std::string>();
+        }
+        if (data.contains("http_server"))
+        {
+            const auto &http = data["http_server"];
+            config.http_port = http.value("port", config.http_port);
+            config.http_threads = http.value("threads", config.http_threads);
+            config.http_max_queued = http.value("max_queued", config.http_max_queued);
+            config.http_keep_alive_timeout_sec = http.value("keep_alive_timeout_sec", config.http_keep_alive_timeout_sec);
+            config.http_keep_alive_max_count = http.value("keep_alive_max_count", config.http_keep_alive_max_count);
+            config.http_read_timeout_sec = http.value("read_timeout_sec", config.http_read_timeout_sec);
+            config.http_write_timeout_sec = http.value("write_timeout_sec", config.http_write_timeout_sec);
+            config.http_payload_max_bytes = http.value("payload_max_bytes", config.http_payload_max_bytes);
+            config.http_max_event_subscribers = http.value("max_event_subscribers", config.http_max_event_subscribers);
+            config.http_max_batch_items = http.value("max_batch_items", config.http_max_batch_items);
+            if (config.http_threads == 0)
+            {
+                LOG(LogLevel::L_WARNING, "http_server.threads must be positive, using 1");
+                config.http_threads = 1;
+            }
+        }
+        if (data.contains("http_compression"))
+        {
+            const auto &compression = data["http_compression"];
+            config.http_compression = compression.value("enabled", true);
+            config.http_compression_min_size = compression.value("min_size", config.http_compression_min_size);
+        }
+        if (data.contains("rate_limit"))
+        {
+            const auto &limit = data["rate_limit"];
+            config.rate_limit_enabled = limit.value("enabled", true);
+            config.rate_limit_rate = limit.value("rate_per_sec", config.rate_limit_rate);
+            config.rate_limit_burst = limit.value("burst", config.rate_limit_burst);
+            config.rate_limit_trust_forwarded_for = limit.value("trust_forwarded_for", false);
+            if (limit.contains("costs"))
+            {
+                config.rate_limit_costs = limit["costs"].get<std::map<std::string, double>>();
+            }
+            if (config.rate_limit_rate <= 0 || config.rate_limit_burst <= 0)
+            {
+                LOG(LogLevel::L_WARNING, "rate_limit.rate_per_sec and burst must be positive, rate limiting disabled");
+                config.rate_limit_enabled = false;
+            }
+        }
+        if (data.contains("webapp_auth"))
+        {
+            const auto &auth = data["webapp_auth"];
+            config.webapp_auth_required = auth.value("required", false);
+            config.webapp_auth_max_age_sec = auth.value("max_age_sec", config.webapp_auth_max_age_sec);
+        }
+        if (data.contains("static_files"))
+        {
+            const auto &files = data["static_files"];
+            config.static_files_enabled = files.value("enabled", false);
+            config.static_files_root = files.value("root", config.static_files_root);
+            config.static_files_mount = files.value("mount", config.static_files_mount);
+            config.static_files_max_age_sec = files.value("max_age_sec", config.static_files_max_age_sec);
+            // Префикс вида "/webapp": ведущий слеш есть, завершающего нет
+            while (config.static_files_mount.size() > 1 && config.static_files_mount.back() == '/')
+            {
+                config.static_files_mount.pop_back();
+            }
+            if (config.static_files_mount.empty() || config.static_files_mount[0] != '/')
+            {
+                config.static_files_mount = "/" + config.static_files_mount;
+            }
+        }
+        if (data.contains("sessions"))
+        {
+            const auto &sessions = data["sessions"];
+            config.session_flush_interval_ms = sessions.value("flush_interval_ms", config.session_flush_interval_ms);
+            config.session_idle_ttl_sec = sessions.value("idle_ttl_sec", config.session_idle_ttl_sec);
+            config.session_max_memory_mb = sessions.value("max_memory_mb", config.session_max_memory_mb);
+            if (config.session_flush_interval_ms <= 0)
+            {
+                LOG(LogLevel::L_WARNING, "sessions.flush_interval_ms must be positive, using 250");
+                config.session_flush_interval_ms = 250;
+            }
+        }
+        if (data.contains("applications"))
+        {
+            const auto &applications = data["applications"];
+            config.applications_dedup_window_sec = applications.value("dedup_window_sec", config.applications_dedup_window_sec);
+            const std::string action = applications.value("dedup_action", std::string("link"));
+            if (action != "link" && action != "reject")
+            {
+                LOG(LogLevel::L_WARNING, "applications.dedup_action must be \"link\" or \"reject\", using \"link\"");
+            }
+            config.applications_dedup_reject = action == "reject";
+        }
+        if (data.contains("reports"))
+        {
+            config.report_export_threads = data["reports"].value("export_threads", config.report_export_threads);
+            if (config.report_export_threads == 0)
+            {
+                LOG(LogLevel::L_WARNING, "reports.export_threads must be positive, using 1");
+                config.report_export_threads = 1;
+            }
+        }
+        if (data.contains("scheduler"))
+        {
+            const auto &scheduler = data["scheduler"];
+            config.scheduler_chat_reminder_cron = scheduler.value("chat_reminder_cron", config.scheduler_chat_reminder_cron);
+            config.scheduler_daily_report_cron = scheduler.value("daily_report_cron", config.scheduler_daily_report_cron);
+            config.admin_otp_ttl_sec = scheduler.value("otp_ttl_sec", config.admin_otp_ttl_sec);
+            if (config.admin_otp_ttl_sec < 0)
+            {
+                LOG(LogLevel::L_WARNING, "scheduler.otp_ttl_sec must not be negative, using 0 (no expiry)");
+                config.admin_otp_ttl_sec = 0;
+            }
+        }
+        if (data.contains("update_recording"))
+        {
+            const auto &recording = data["update_recording"];
+            config.record_updates = recording.value("enabled", false);
+            config.record_updates_file = recording.value("file", config.record_updates_file);
+            if (recording.contains("scrub_fields"))
+            {
+                config.record_scrub_fields = recording["scrub_fields"].get<std::vector<std::string>>();
+            }
+            if (recording.contains("keep_texts"))
+            {
+                config.record_keep_texts = recording["keep_texts"].get<std::vector<std::string>>();
+            }
+            config.record_pseudonymize_ids = recording.value("pseudonymize_ids", true);
+        }
     }
     catch (const nlohmann::json::parse_error &e)
     {
@@ -1,6 +1,9 @@
 #pragma once
 #include <string>
+#include <cstddef>
 #include <cstdint>
+#include <map>
+#include <vector>
 
 struct Config
 {
@@ -9,6 +12,71 @@ struct Config
     std::string log_level = "INFO";        // INFO, WARNING, ERROR
     std::string log_file = "logs/bot.log"; // Путь к файлу логов
     std::string webapp_url = "";           // URL Telegram WebApp (пустой = использовать inline)
+    std::string api_base_url = "https://api.telegram.org"; // Базовый URL Bot API (http://127.0.0.1:8081 для bot_loadtest)
+
+    // HTTP API: порт, пул потоков и лимиты соединений
+    int http_port = 8080;
+    size_t http_threads = 8;                  // Каждое соединение (в т.ч. keep-alive и SSE) занимает поток
+    size_t http_max_queued = 64;              // Соединения, ждущие поток; сверх - быстрый ответ 503
+    int http_keep_alive_timeout_sec = 5;      // Простой keep-alive соединения до закрытия
+    size_t http_keep_alive_max_count = 100;   // Запросов на одно keep-alive соединение
+    int http_read_timeout_sec = 5;
+    int http_write_timeout_sec = 5;
+    size_t http_payload_max_bytes = 1048576;  // Максимальный размер тела запроса (413 сверх)
+    size_t http_max_event_subscribers = 4;    // Одновременных подписчиков /api/events
+    size_t http_max_batch_items = 500;        // Элементов в одном пакетном запросе (413 сверх)
+
+    // Ограничение частоты запросов к HTTP API: token bucket на IP клиента
+    bool rate_limit_enabled = true;
+    double rate_limit_rate = 10.0;               // Токенов в секунду
+    double rate_limit_burst = 60.0;              // Ёмкость ведра
+    bool rate_limit_trust_forwarded_for = false; // IP из X-Forwarded-For (только за своим прокси)
+    std::map<std::string, double> rate_limit_costs; // Стоимость по пути поверх встроенной (0 - без ограничения)
+
+    // Проверка Telegram WebApp initData для /api/* (админ-панель открывается как WebApp)
+    bool webapp_auth_required = false;
+    int64_t webapp_auth_max_age_sec = 86400; // Срок действия initData от auth_date
+
+    // Сжатие ответов HTTP API (gzip/deflate по Accept-Encoding)
+    bool http_compression = true;
+    size_t http_compression_min_size = 1024; // Меньшие тела отдаются как есть
+
+    // Раздача webapp/ самим HTTP-сервером (файлы в памяти, gzip и хеши считаются при старте)
+    bool static_files_enabled = false;
+    std::string static_files_root = "webapp";   // Каталог с index.html, js/, css/, admin/
+    std::string static_files_mount = "/webapp"; // URL-префикс
+    int static_files_max_age_sec = 3600;        // Cache-Control для ресурсов без ?v=<hash>
+
+    // Отложенная запись сессий: изменённые сессии пишутся в БД одной транзакцией раз в интервал
+    int session_flush_interval_ms = 250;
+    // Сессии в памяти: вытеснение по простою и по бюджету (0 - без ограничения)
+    int64_t session_idle_ttl_sec = 86400;
+    size_t session_max_memory_mb = 64;
+
+    // Дубли заявок (телефон + адрес + тариф) в пределах окна: связываются с первой заявкой
+    // или отклоняются (0 - проверка выключена)
+    int64_t applications_dedup_window_sec = 86400;
+    bool applications_dedup_reject = false;
+
+    // Потоки выгрузки всех торговых точек (каждый со своим read-only соединением к БД)
+    size_t report_export_threads = 4;
+
+    // Планировщик (cron по местному времени, "" - задача выключена): напоминания об отложенных
+    // чатах, ежедневные отчёты точек за прошедшие сутки; срок действия OTP админа (0 - бессрочно)
+    std::string scheduler_chat_reminder_cron = "* * * * *";
+    std::string scheduler_daily_report_cron = "0 9 * * *";
+    int64_t admin_otp_ttl_sec = 600;
+
+    // Запись входящих апдейтов в JSONL для воспроизведения через bot_replay
+    bool record_updates = false;
+    std::string record_updates_file = "logs/updates.jsonl";
+    // Поля, значения которых маскируются с сохранением формы (цифры -> цифры, буквы -> буквы)
+    std::vector<std::string> record_scrub_fields = {"first_name", "last_name", "username", "phone_number", "vcard", "text",
+                                                    "name", "phone", "email", "street", "house", "apartment"};
+    // Тексты сообщений, которые пишутся как есть (кнопки меню), даже если "text" маскируется
+    std::vector<std::string> record_keep_texts;
+    // Заменять ID пользователей/чатов стабильными псевдонимами (кроме main_admin_id)
+    bool record_pseudonymize_ids = true;
 };
 
 extern Config config;
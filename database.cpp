@@ -4,12 +4,98 @@
 #include "main.h"
 #include "config.h"
 #include "logger.h"
+#include "metrics.h"
+#include "tracing.h"
+#include "event_bus.h"
+#include "json_writer.h"
+#include "application_fingerprint.h"
 #include <sqlite3.h>
 #include <cstdio>
+#include <mutex>
 #include <sstream>
 
 sqlite3 *db_main;
 
+// db_main используют поток бота, HTTP API, write-behind сессий и планировщик. Транзакция
+// принадлежит соединению, а не потоку: без общей блокировки запрос другого потока попадает
+// внутрь чужого BEGIN ... COMMIT (и теряется при ROLLBACK), а второй BEGIN завершается ошибкой.
+// Поэтому каждая db_* функция держит блокировку соединения до выхода; рекурсивная - функции
+// вызывают друг друга. Read-only соединения (db_open_readonly) её не берут.
+static std::recursive_mutex db_main_mutex;
+
+// Замер латентности запроса и спан трассировки; гистограмма кешируется в static на месте вызова.
+// Время включает ожидание блокировки соединения.
+#define DB_PROFILE_TIMING(query)                                                                   \
+    static Histogram &db_profile_histogram_ = MetricsRegistry::instance().histogram(               \
+        "bot_db_query_duration_seconds", "Latency of SQLite queries per db_* function", {{"query", query}}); \
+    ScopedLatency db_profile_timer_(db_profile_histogram_);                                        \
+    TraceSpan db_profile_span_("db", query)
+
+// Замер и блокировка db_main на всё время функции
+#define DB_PROFILE(query)     \
+    DB_PROFILE_TIMING(query); \
+    std::lock_guard<std::recursive_mutex> db_main_lock_(db_main_mutex)
+
+// Колонки заявки в порядке APPLICATION_COLUMNS
+#define APPLICATION_COLUMNS "ID, USER_ID, TARIFF, NAME, PRICE, PHONE, EMAIL, ADDRESS, strftime('%Y-%m-%d %H:%M', TIMESTAMP), STATUS"
+
+// Текстовая колонка с заменой NULL на пустую строку; assign переиспользует ёмкость строки
+static void read_text_column(sqlite3_stmt *stmt, int column, std::string &out)
+{
+    const char *text = reinterpret_cast<const char *>(sqlite3_column_text(stmt, column));
+    if (text)
+    {
+        out.assign(text, static_cast<size_t>(sqlite3_column_bytes(stmt, column)));
+    }
+    else
+    {
+        out.clear();
+    }
+}
+
+// Заполняет app_data из строки запроса с колонками APPLICATION_COLUMNS
+static void read_application_row(sqlite3_stmt *stmt, ApplicationDataForReport &app_data)
+{
+    app_data.id = sqlite3_column_int64(stmt, 0);
+    app_data.user_id = sqlite3_column_int64(stmt, 1);
+    read_text_column(stmt, 2, app_data.tariff);
+    read_text_column(stmt, 3, app_data.name);
+    read_text_column(stmt, 4, app_data.price);
+    read_text_column(stmt, 5, app_data.phone);
+    read_text_column(stmt, 6, app_data.email);
+    read_text_column(stmt, 7, app_data.address);
+    read_text_column(stmt, 8, app_data.timestamp);
+    read_text_column(stmt, 9, app_data.chat_status);
+}
+
+// Дельты для живой ленты админ-панели (GET /api/events)
+static void publish_admin_event(const char *type, int64_t user_id, const std::string *name = nullptr,
+                                const std::string *trade_point = nullptr)
+{
+    std::string data;
+    JsonWriter w(data);
+    w.beginObject();
+    w.field("userId", user_id);
+    if (name && trade_point)
+    {
+        w.field("name", *name);
+        w.field("tradePoint", *trade_point);
+    }
+    w.endObject();
+    EventBus::instance().publish(type, std::move(data));
+}
+
+static void publish_application_status(long long application_id, const std::string &status)
+{
+    std::string data;
+    JsonWriter w(data);
+    w.beginObject();
+    w.field("id", application_id);
+    w.field("status", status);
+    w.endObject();
+    EventBus::instance().publish("application_status", std::move(data));
+}
+
 // Callback-функция для вывода заявок пользователя.
 static int db_my_apps_callback(void *data, int argc, char **argv, char **azColName)
 {
@@ -52,6 +138,58 @@ static int db_chat_history_callback(void *data, int argc, char **argv, char **az
     return 0;
 }
 
+static bool db_column_exists(const char *table, const char *column)
+{
+    std::string sql = std::string("PRAGMA table_info(") + table + ");";
+    sqlite3_stmt *stmt = nullptr;
+    bool exists = false;
+    if (sqlite3_prepare_v2(db_main, sql.c_str(), -1, &stmt, 0) == SQLITE_OK)
+    {
+        while (!exists && sqlite3_step(stmt) == SQLITE_ROW)
+        {
+            const char *name = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 1));
+            exists = name && std::string(name) == column;
+        }
+    }
+    sqlite3_finalize(stmt);
+    return exists;
+}
+
+// Старые БД: sessions без ADMIN_MODE/DATA, режим админа хранился в STATE как 100 + mode
+static void db_migrate_sessions()
+{
+    if (!db_column_exists("sessions", "ADMIN_MODE"))
+    {
+        sqlite3_exec(db_main, "ALTER TABLE sessions ADD COLUMN ADMIN_MODE INTEGER;", 0, 0, 0);
+        sqlite3_exec(db_main, "UPDATE sessions SET ADMIN_MODE = STATE - 100, STATE = 0 WHERE STATE >= 100;", 0, 0, 0);
+        LOG(LogLevel::INFO, "Sessions table migrated: admin work modes moved to ADMIN_MODE (" << sqlite3_changes(db_main) << " rows).");
+    }
+    if (!db_column_exists("sessions", "DATA"))
+    {
+        sqlite3_exec(db_main, "ALTER TABLE sessions ADD COLUMN DATA BLOB;", 0, 0, 0);
+    }
+}
+
+// Старые БД: applications без колонок поиска дублей; старые заявки остаются без отпечатка
+static void db_migrate_applications()
+{
+    if (!db_column_exists("applications", "FINGERPRINT"))
+    {
+        sqlite3_exec(db_main, "ALTER TABLE applications ADD COLUMN FINGERPRINT TEXT;", 0, 0, 0);
+    }
+    if (!db_column_exists("applications", "DUPLICATE_OF"))
+    {
+        sqlite3_exec(db_main, "ALTER TABLE applications ADD COLUMN DUPLICATE_OF INTEGER;", 0, 0, 0);
+    }
+    // Выборки по точке (отчёты, список для админа) идут по индексу, а не полным просмотром
+    sqlite3_exec(db_main, "CREATE INDEX IF NOT EXISTS idx_applications_flyer_code ON applications(FLYER_CODE, ID);", 0, 0, 0);
+    // Отпечаток есть только у последней оригинальной заявки (у дублей и вышедших из окна - NULL)
+    if (sqlite3_exec(db_main, "CREATE UNIQUE INDEX IF NOT EXISTS idx_applications_fingerprint ON applications(FINGERPRINT);", 0, 0, 0) != SQLITE_OK)
+    {
+        LOG(LogLevel::L_ERROR, "Failed to create applications fingerprint index: " << sqlite3_errmsg(db_main));
+    }
+}
+
 // Инициализация базы данных и создание всех необходимых таблиц.
 void db_init()
 {
@@ -61,6 +199,8 @@ void db_init()
         return;
     }
     LOG(LogLevel::INFO, "Main DB " << DB_PATH << " opened successfully.");
+    // WAL: фоновые выгрузки на read-only соединениях (db_open_readonly) не блокируют запись
+    sqlite3_exec(db_main, "PRAGMA journal_mode=WAL;", 0, 0, 0);
 
     // Создание таблицы applications
     const char *apps_sql = "CREATE TABLE IF NOT EXISTS applications ("
@@ -71,13 +211,16 @@ void db_init()
                            "TIMESTAMP DATETIME DEFAULT CURRENT_TIMESTAMP,"
                            "CHAT_STATUS TEXT DEFAULT 'New',"
                            "CHAT_ADMIN_ID INTEGER DEFAULT 0,"
-                           "CHAT_POSTPONED_UNTIL DATETIME);";
+                           "CHAT_POSTPONED_UNTIL DATETIME,"
+                           "FINGERPRINT TEXT,"
+                           "DUPLICATE_OF INTEGER);";
     if (sqlite3_exec(db_main, apps_sql, 0, 0, 0) != SQLITE_OK)
     {
         LOG(LogLevel::L_ERROR, "Failed to create applications table: " << sqlite3_errmsg(db_main));
     }
     else
     {
+        db_migrate_applications();
         LOG(LogLevel::INFO, "Applications table initialized successfully.");
     }
 
@@ -96,16 +239,19 @@ void db_init()
         LOG(LogLevel::INFO, "Admins table initialized successfully.");
     }
 
-    // Создание таблицы sessions
+    // Создание таблицы sessions: состояние, режим админа (NULL - не админ) и сериализованный UserData
     const char *session_sql = "CREATE TABLE IF NOT EXISTS sessions ("
                               "USER_ID INTEGER PRIMARY KEY NOT NULL,"
-                              "STATE INTEGER NOT NULL);";
+                              "STATE INTEGER NOT NULL,"
+                              "ADMIN_MODE INTEGER,"
+                              "DATA BLOB);";
     if (sqlite3_exec(db_main, session_sql, 0, 0, 0) != SQLITE_OK)
     {
         LOG(LogLevel::L_ERROR, "Failed to create sessions table: " << sqlite3_errmsg(db_main));
     }
     else
     {
+        db_migrate_sessions();
         LOG(LogLevel::INFO, "Sessions table initialized successfully.");
     }
 
@@ -124,12 +270,49 @@ void db_init()
     {
         LOG(LogLevel::INFO, "Conversations table initialized successfully.");
     }
+
+    // Создание таблицы scheduled_jobs: следующий запуск задач планировщика переживает перезапуск
+    const char *jobs_sql = "CREATE TABLE IF NOT EXISTS scheduled_jobs ("
+                           "NAME TEXT PRIMARY KEY NOT NULL,"
+                           "KIND TEXT NOT NULL,"
+                           "PAYLOAD TEXT NOT NULL DEFAULT '',"
+                           "SCHEDULE TEXT NOT NULL DEFAULT '',"
+                           "NEXT_RUN INTEGER NOT NULL,"
+                           "LAST_RUN INTEGER NOT NULL DEFAULT 0);";
+    if (sqlite3_exec(db_main, jobs_sql, 0, 0, 0) != SQLITE_OK)
+    {
+        LOG(LogLevel::L_ERROR, "Failed to create scheduled_jobs table: " << sqlite3_errmsg(db_main));
+    }
+    else
+    {
+        LOG(LogLevel::INFO, "Scheduled jobs table initialized successfully.");
+    }
     db_init_bot_settings();
 }
 
+// Отдельное read-only соединение для фоновых выгрузок; каждое используется одним потоком
+sqlite3 *db_open_readonly()
+{
+    sqlite3 *db = nullptr;
+    if (sqlite3_open_v2(DB_PATH, &db, SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX, nullptr) != SQLITE_OK)
+    {
+        LOG(LogLevel::L_ERROR, "Can't open read-only connection to " << DB_PATH << ": " << sqlite3_errmsg(db));
+        sqlite3_close(db);
+        return nullptr;
+    }
+    sqlite3_busy_timeout(db, 5000);
+    return db;
+}
+
+void db_close_readonly(sqlite3 *db)
+{
+    sqlite3_close(db);
+}
+
 // Закрытие соединения с базой данных.
 void db_close()
 {
+    std::lock_guard<std::recursive_mutex> lock(db_main_mutex);
     sqlite3_close(db_main);
     LOG(LogLevel::INFO, "Main DB " << DB_PATH << " closed successfully.");
 }
@@ -167,6 +350,7 @@ void db_init_bot_settings()
 // Получение текущего статуса бота (активен/неактивен).
 bool db_get_bot_status()
 {
+    DB_PROFILE("db_get_bot_status");
     const char *sql = "SELECT VALUE FROM bot_settings WHERE KEY = 'is_active';";
     sqlite3_stmt *stmt;
     bool status = false;
@@ -192,6 +376,7 @@ bool db_get_bot_status()
 // Установка статуса бота (активен/неактивен).
 void db_set_bot_status(bool active_status)
 {
+    DB_PROFILE("db_set_bot_status");
     const char *sql = "INSERT OR REPLACE INTO bot_settings (KEY, VALUE) VALUES ('is_active', ?);";
     sqlite3_stmt *stmt;
     if (sqlite3_prepare_v2(db_main, sql, -1, &stmt, 0) == SQLITE_OK)
@@ -214,23 +399,148 @@ void db_set_bot_status(bool active_status)
     sqlite3_finalize(stmt);
 }
 
-// Добавление новой заявки в базу.
-void db_add_application(int64_t user_id, const UserData &data, const std::string &full_address, int total_monthly)
+static bool db_exec_simple(const char *sql);
+
+// Отпечаток заявки в окне дедупликации: ID и возраст в секундах; false - такой нет
+static bool db_find_fingerprint(const std::string &fingerprint, int64_t &id, int64_t &age_sec)
 {
-    std::string price_str = std::to_string(total_monthly) + " ₽/мес";
-    char *sql = sqlite3_mprintf("INSERT INTO applications (USER_ID,TARIFF,PRICE,NAME,PHONE,MESSENGER,EMAIL,ADDRESS,FLYER_CODE) VALUES (%lld, %Q, %Q, %Q, %Q, %Q, %Q, %Q, %Q);",
-                                (long long int)user_id, data.final_tariff_string.c_str(), price_str.c_str(), data.name.c_str(), data.phone.c_str(),
-                                data.preferred_messenger.c_str(), data.email.c_str(), full_address.c_str(), data.flyer_code.c_str());
-    if (sqlite3_exec(db_main, sql, 0, 0, 0) != SQLITE_OK)
+    sqlite3_stmt *stmt = nullptr;
+    bool found = false;
+    if (sqlite3_prepare_v2(db_main, "SELECT ID, CAST(strftime('%s','now') AS INTEGER) - CAST(strftime('%s', TIMESTAMP) AS INTEGER) "
+                                    "FROM applications WHERE FINGERPRINT = ?;",
+                           -1, &stmt, 0) == SQLITE_OK)
+    {
+        sqlite3_bind_text(stmt, 1, fingerprint.c_str(), -1, SQLITE_STATIC);
+        if (sqlite3_step(stmt) == SQLITE_ROW)
+        {
+            id = sqlite3_column_int64(stmt, 0);
+            age_sec = sqlite3_column_int64(stmt, 1);
+            found = true;
+        }
+    }
+    sqlite3_finalize(stmt);
+    return found;
+}
+
+// Добавление новой заявки в базу с проверкой дублей.
+// Поиск отпечатка и вставка идут в одной транзакции BEGIN IMMEDIATE, уникальный индекс
+// по FINGERPRINT не даёт двум одинаковым заявкам одновременно остаться оригиналами.
+ApplicationInsertResult db_add_application(int64_t user_id, const UserData &data, const std::string &full_address, int total_monthly)
+{
+    DB_PROFILE("db_add_application");
+    ApplicationInsertResult result;
+    const bool dedup = config.applications_dedup_window_sec > 0;
+    const std::string fingerprint = dedup ? applicationFingerprint(data.phone, full_address, data.final_tariff_string) : std::string();
+
+    if (!db_exec_simple("BEGIN IMMEDIATE;"))
+    {
+        return result;
+    }
+    int64_t previous_id = 0;
+    int64_t previous_age = 0;
+    if (dedup && db_find_fingerprint(fingerprint, previous_id, previous_age))
+    {
+        if (previous_age < config.applications_dedup_window_sec)
+        {
+            result.original_id = previous_id;
+            if (config.applications_dedup_reject)
+            {
+                db_exec_simple("ROLLBACK;");
+                static Counter &rejected = MetricsRegistry::instance().counter(
+                    "bot_application_duplicates_total", "Duplicate applications detected by fingerprint", {{"action", "rejected"}});
+                rejected.inc();
+                result.outcome = ApplicationInsertOutcome::Rejected;
+                return result;
+            }
+        }
+        else
+        {
+            // Старая заявка вышла из окна: отпечаток переходит к новой
+            std::string sql = "UPDATE applications SET FINGERPRINT = NULL WHERE ID = " + std::to_string(previous_id) + ";";
+            if (!db_exec_simple(sql.c_str()))
+            {
+                db_exec_simple("ROLLBACK;");
+                return result;
+            }
+        }
+    }
+
+    const std::string price_str = std::to_string(total_monthly) + " ₽/мес";
+    sqlite3_stmt *stmt = nullptr;
+    if (sqlite3_prepare_v2(db_main, "INSERT INTO applications (USER_ID,TARIFF,PRICE,NAME,PHONE,MESSENGER,EMAIL,ADDRESS,FLYER_CODE,FINGERPRINT,DUPLICATE_OF) "
+                                    "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);",
+                           -1, &stmt, 0) != SQLITE_OK)
     {
         LOG(LogLevel::L_ERROR, "Failed to add application to DB: " << sqlite3_errmsg(db_main));
+        sqlite3_finalize(stmt);
+        db_exec_simple("ROLLBACK;");
+        return result;
     }
-    sqlite3_free(sql);
+    sqlite3_bind_int64(stmt, 1, user_id);
+    sqlite3_bind_text(stmt, 2, data.final_tariff_string.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 3, price_str.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 4, data.name.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 5, data.phone.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 6, messengerName(data.preferred_messenger), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 7, data.email.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 8, full_address.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 9, data.flyer_code.c_str(), -1, SQLITE_STATIC);
+    if (dedup && result.original_id == 0)
+    {
+        sqlite3_bind_text(stmt, 10, fingerprint.c_str(), -1, SQLITE_STATIC);
+    }
+    else
+    {
+        sqlite3_bind_null(stmt, 10);
+    }
+    if (result.original_id != 0)
+    {
+        sqlite3_bind_int64(stmt, 11, result.original_id);
+    }
+    else
+    {
+        sqlite3_bind_null(stmt, 11);
+    }
+    const int rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    if (rc != SQLITE_DONE)
+    {
+        LOG(LogLevel::L_ERROR, "Failed to add application to DB: " << sqlite3_errmsg(db_main));
+        db_exec_simple("ROLLBACK;");
+        return result;
+    }
+    result.id = sqlite3_last_insert_rowid(db_main);
+    if (!db_exec_simple("COMMIT;"))
+    {
+        db_exec_simple("ROLLBACK;");
+        result.id = 0;
+        return result;
+    }
+    result.outcome = result.original_id != 0 ? ApplicationInsertOutcome::Linked : ApplicationInsertOutcome::Created;
+    if (result.outcome == ApplicationInsertOutcome::Linked)
+    {
+        static Counter &linked = MetricsRegistry::instance().counter(
+            "bot_application_duplicates_total", "Duplicate applications detected by fingerprint", {{"action", "linked"}});
+        linked.inc();
+        return result; // дубль не попадает в ленту админ-панели
+    }
+
+    // Событие несёт строку в том же виде, что и GET /api/applications
+    auto app = db_get_application_by_id(result.id);
+    if (app)
+    {
+        std::string event;
+        JsonWriter w(event);
+        writeJson(w, *app);
+        EventBus::instance().publish("application_created", std::move(event));
+    }
+    return result;
 }
 
 // Получение списка заявок для конкретного пользователя.
 std::string db_get_my_apps(int64_t user_id)
 {
+    DB_PROFILE("db_get_my_apps");
     std::string result = "📂 *Ваши оставленные заявки:*\n\n";
     std::string sql = "SELECT TARIFF, PRICE, ADDRESS, STATUS, strftime('%Y-%m-%d %H:%M', TIMESTAMP) FROM applications WHERE USER_ID = " + std::to_string(user_id) + " ORDER BY ID DESC;";
     sqlite3_exec(db_main, sql.c_str(), db_my_apps_callback, &result, 0);
@@ -244,8 +554,9 @@ std::string db_get_my_apps(int64_t user_id)
 // Получение списка заявок для конкретной торговой точки.
 std::string db_get_apps_by_trade_point(const std::string &trade_point_code)
 {
+    DB_PROFILE("db_get_apps_by_trade_point");
     std::string result = "👑 *Заявки для точки " + trade_point_code + ":*\n\n";
-    std::string sql = "SELECT ID, USER_ID, TARIFF, NAME, PRICE, PHONE, EMAIL, ADDRESS, STATUS, strftime('%Y-%m-%d %H:%M', TIMESTAMP) FROM applications WHERE FLYER_CODE = ? ORDER BY ID DESC;";
+    std::string sql = "SELECT ID, USER_ID, TARIFF, NAME, PRICE, PHONE, EMAIL, ADDRESS, STATUS, strftime('%Y-%m-%d %H:%M', TIMESTAMP) FROM applications WHERE FLYER_CODE = ? AND DUPLICATE_OF IS NULL ORDER BY ID DESC;";
     sqlite3_stmt *stmt;
     if (sqlite3_prepare_v2(db_main, sql.c_str(), -1, &stmt, 0) == SQLITE_OK)
     {
@@ -268,41 +579,60 @@ std::string db_get_apps_by_trade_point(const std::string &trade_point_code)
     return result;
 }
 
-// Получение данных о заявках для отчета.
-std::vector<ApplicationDataForReport> db_get_apps_data_for_report(const std::string &trade_point_code)
+// Курсор отчёта: строки точки за период без дублей, по одной в переиспользуемую структуру.
+// Даты 'YYYY-MM-DD' включительно сравниваются с TIMESTAMP (UTC); пустая дата - без границы.
+static size_t db_step_report_rows(sqlite3 *db, const std::string &trade_point_code, const std::string &from_date,
+                                  const std::string &to_date, const std::function<bool(const ApplicationDataForReport &)> &fn)
 {
-    std::vector<ApplicationDataForReport> results;
-    std::string sql = "SELECT ID, USER_ID, TARIFF, NAME, PRICE, PHONE, EMAIL, ADDRESS, strftime('%Y-%m-%d %H:%M', TIMESTAMP), CHAT_STATUS FROM applications WHERE FLYER_CODE = ? ORDER BY ID DESC;";
-    sqlite3_stmt *stmt;
-    if (sqlite3_prepare_v2(db_main, sql.c_str(), -1, &stmt, 0) == SQLITE_OK)
+    const char *sql = "SELECT ID, USER_ID, TARIFF, NAME, PRICE, PHONE, EMAIL, ADDRESS, strftime('%Y-%m-%d %H:%M', TIMESTAMP), CHAT_STATUS "
+                      "FROM applications WHERE FLYER_CODE = ?1 AND DUPLICATE_OF IS NULL "
+                      "AND (?2 = '' OR TIMESTAMP >= date(?2)) AND (?3 = '' OR TIMESTAMP < date(?3, '+1 day')) "
+                      "ORDER BY ID DESC;";
+    sqlite3_stmt *stmt = nullptr;
+    size_t rows = 0;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, 0) == SQLITE_OK)
     {
         sqlite3_bind_text(stmt, 1, trade_point_code.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 2, from_date.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 3, to_date.c_str(), -1, SQLITE_STATIC);
+        ApplicationDataForReport app_data;
         while (sqlite3_step(stmt) == SQLITE_ROW)
         {
-            ApplicationDataForReport app_data;
-            app_data.id = sqlite3_column_int64(stmt, 0);
-            app_data.user_id = sqlite3_column_int64(stmt, 1);
-            app_data.tariff = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 2));
-            app_data.name = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 3));
-            app_data.price = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 4));
-            app_data.phone = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 5));
-            app_data.email = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 6));
-            app_data.address = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 7));
-            app_data.timestamp = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 8));
-            app_data.chat_status = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 9));
-            results.push_back(app_data);
+            read_application_row(stmt, app_data);
+            ++rows;
+            if (!fn(app_data))
+            {
+                break;
+            }
         }
     }
+    else
+    {
+        LOG(LogLevel::L_ERROR, "db_for_each_report_row: SQL prepare failed: " << sqlite3_errmsg(db));
+    }
     sqlite3_finalize(stmt);
-    return results;
+    return rows;
+}
+
+size_t db_for_each_report_row(const std::string &trade_point_code, const std::string &from_date, const std::string &to_date,
+                              const std::function<bool(const ApplicationDataForReport &)> &fn, sqlite3 *db)
+{
+    DB_PROFILE_TIMING("db_for_each_report_row");
+    std::unique_lock<std::recursive_mutex> lock(db_main_mutex, std::defer_lock);
+    if (!db)
+    {
+        lock.lock();
+    }
+    return db_step_report_rows(db ? db : db_main, trade_point_code, from_date, to_date, fn);
 }
 
-// Получение всех заявок для API
+// Получение всех заявок для API (без привязанных дублей, как в ленте событий)
 std::vector<ApplicationDataForReport> db_get_all_applications()
 {
+    DB_PROFILE("db_get_all_applications");
     LOG(LogLevel::INFO, "db_get_all_applications() called");
     std::vector<ApplicationDataForReport> results;
-    std::string sql = "SELECT ID, USER_ID, TARIFF, NAME, PRICE, PHONE, EMAIL, ADDRESS, strftime('%Y-%m-%d %H:%M', TIMESTAMP), STATUS FROM applications ORDER BY ID DESC;";
+    std::string sql = "SELECT " APPLICATION_COLUMNS " FROM applications WHERE DUPLICATE_OF IS NULL ORDER BY ID DESC;";
     sqlite3_stmt *stmt;
     if (sqlite3_prepare_v2(db_main, sql.c_str(), -1, &stmt, 0) == SQLITE_OK)
     {
@@ -310,24 +640,7 @@ std::vector<ApplicationDataForReport> db_get_all_applications()
         while (sqlite3_step(stmt) == SQLITE_ROW)
         {
             ApplicationDataForReport app_data;
-            app_data.id = sqlite3_column_int64(stmt, 0);
-            app_data.user_id = sqlite3_column_int64(stmt, 1);
-            const char *tariff = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 2));
-            app_data.tariff = tariff ? tariff : "";
-            const char *name = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 3));
-            app_data.name = name ? name : "";
-            const char *price = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 4));
-            app_data.price = price ? price : "";
-            const char *phone = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 5));
-            app_data.phone = phone ? phone : "";
-            const char *email = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 6));
-            app_data.email = email ? email : "";
-            const char *address = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 7));
-            app_data.address = address ? address : "";
-            const char *timestamp = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 8));
-            app_data.timestamp = timestamp ? timestamp : "";
-            const char *status = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 9));
-            app_data.chat_status = status ? status : "";
+            read_application_row(stmt, app_data);
             results.push_back(app_data);
             LOG(LogLevel::INFO, "db_get_all_applications: found app ID=" << app_data.id);
         }
@@ -341,10 +654,85 @@ std::vector<ApplicationDataForReport> db_get_all_applications()
     return results;
 }
 
+DashboardStats db_get_dashboard_stats()
+{
+    DB_PROFILE("db_get_dashboard_stats");
+    DashboardStats stats;
+    const std::string status_new = statusToString(ApplicationStatus::New);
+    const std::string status_in_progress = statusToString(ApplicationStatus::InProgress);
+    const std::string status_done = statusToString(ApplicationStatus::Done);
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db_main, "SELECT STATUS, COUNT(*) FROM applications WHERE DUPLICATE_OF IS NULL GROUP BY STATUS;", -1, &stmt, 0) == SQLITE_OK)
+    {
+        std::string status;
+        while (sqlite3_step(stmt) == SQLITE_ROW)
+        {
+            read_text_column(stmt, 0, status);
+            const int64_t count = sqlite3_column_int64(stmt, 1);
+            stats.applications += count;
+            if (status == status_new)
+                stats.new_applications = count;
+            else if (status == status_in_progress)
+                stats.in_progress = count;
+            else if (status == status_done)
+                stats.completed = count;
+        }
+    }
+    else
+    {
+        LOG(LogLevel::L_ERROR, "db_get_dashboard_stats: SQL prepare failed: " << sqlite3_errmsg(db_main));
+    }
+    sqlite3_finalize(stmt);
+
+    if (sqlite3_prepare_v2(db_main, "SELECT IS_APPROVED, COUNT(*) FROM admins GROUP BY IS_APPROVED;", -1, &stmt, 0) == SQLITE_OK)
+    {
+        while (sqlite3_step(stmt) == SQLITE_ROW)
+        {
+            (sqlite3_column_int(stmt, 0) ? stats.admins : stats.pending_admins) = sqlite3_column_int64(stmt, 1);
+        }
+    }
+    sqlite3_finalize(stmt);
+    return stats;
+}
+
+// Постраничный обход заявок по убыванию ID (keyset: ID < before_id, не больше limit строк).
+// Привязанные дубли пропускаются: application_created для них не публикуется.
+// Между страницами запрос не держится открытым, поэтому медленный клиент потокового ответа
+// не задерживает запись в базу. fn получает одну и ту же переиспользуемую структуру.
+size_t db_for_each_application(int64_t before_id, size_t limit, const std::function<bool(const ApplicationDataForReport &)> &fn)
+{
+    DB_PROFILE("db_for_each_application");
+    const char *sql = "SELECT " APPLICATION_COLUMNS " FROM applications WHERE ID < ? AND DUPLICATE_OF IS NULL ORDER BY ID DESC LIMIT ?;";
+    sqlite3_stmt *stmt;
+    size_t rows = 0;
+    if (sqlite3_prepare_v2(db_main, sql, -1, &stmt, 0) == SQLITE_OK)
+    {
+        sqlite3_bind_int64(stmt, 1, before_id);
+        sqlite3_bind_int64(stmt, 2, static_cast<sqlite3_int64>(limit));
+        ApplicationDataForReport app_data;
+        while (sqlite3_step(stmt) == SQLITE_ROW)
+        {
+            read_application_row(stmt, app_data);
+            ++rows;
+            if (!fn(app_data))
+            {
+                break;
+            }
+        }
+    }
+    else
+    {
+        LOG(LogLevel::L_ERROR, "db_for_each_application: SQL prepare failed: " << sqlite3_errmsg(db_main));
+    }
+    sqlite3_finalize(stmt);
+    return rows;
+}
+
 // Получение заявки по ID
 std::optional<ApplicationDataForReport> db_get_application_by_id(int64_t app_id)
 {
-    std::string sql = "SELECT ID, USER_ID, TARIFF, NAME, PRICE, PHONE, EMAIL, ADDRESS, strftime('%Y-%m-%d %H:%M', TIMESTAMP), STATUS FROM applications WHERE ID = ?;";
+    DB_PROFILE("db_get_application_by_id");
+    std::string sql = "SELECT " APPLICATION_COLUMNS " FROM applications WHERE ID = ?;";
     sqlite3_stmt *stmt;
     std::optional<ApplicationDataForReport> result = std::nullopt;
 
@@ -354,24 +742,7 @@ std::optional<ApplicationDataForReport> db_get_application_by_id(int64_t app_id)
         if (sqlite3_step(stmt) == SQLITE_ROW)
         {
             ApplicationDataForReport app_data;
-            app_data.id = sqlite3_column_int64(stmt, 0);
-            app_data.user_id = sqlite3_column_int64(stmt, 1);
-            const char *tariff = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 2));
-            app_data.tariff = tariff ? tariff : "";
-            const char *name = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 3));
-            app_data.name = name ? name : "";
-            const char *price = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 4));
-            app_data.price = price ? price : "";
-            const char *phone = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 5));
-            app_data.phone = phone ? phone : "";
-            const char *email = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 6));
-            app_data.email = email ? email : "";
-            const char *address = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 7));
-            app_data.address = address ? address : "";
-            const char *timestamp = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 8));
-            app_data.timestamp = timestamp ? timestamp : "";
-            const char *status = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 9));
-            app_data.chat_status = status ? status : "";
+            read_application_row(stmt, app_data);
 
             result = app_data;
         }
@@ -383,33 +754,50 @@ std::optional<ApplicationDataForReport> db_get_application_by_id(int64_t app_id)
 // Обновление статуса заявки.
 void db_update_application_status(long long application_id, ApplicationStatus status)
 {
+    DB_PROFILE("db_update_application_status");
     std::string status_str = statusToString(status);
     char *sql = sqlite3_mprintf("UPDATE applications SET STATUS = %Q WHERE ID = %lld;",
                                 status_str.c_str(), application_id);
-    sqlite3_exec(db_main, sql, 0, 0, 0);
+    bool updated = sqlite3_exec(db_main, sql, 0, 0, 0) == SQLITE_OK && sqlite3_changes(db_main) > 0;
     sqlite3_free(sql);
+
+    if (updated)
+    {
+        publish_application_status(application_id, status_str);
+    }
 }
 
 // Добавление запроса на админство.
 void db_add_admin_request(int64_t user_id, const std::string &name, const std::string &trade_point)
 {
+    DB_PROFILE("db_add_admin_request");
     char *sql = sqlite3_mprintf("INSERT OR REPLACE INTO admins (USER_ID, NAME, TRADE_POINT, IS_APPROVED) VALUES (%lld, %Q, %Q, 0);",
                                 (long long)user_id, name.c_str(), trade_point.c_str());
-    sqlite3_exec(db_main, sql, 0, 0, 0);
+    bool ok = sqlite3_exec(db_main, sql, 0, 0, 0) == SQLITE_OK && sqlite3_changes(db_main) > 0;
     sqlite3_free(sql);
+    if (ok)
+    {
+        publish_admin_event("admin_requested", user_id, &name, &trade_point);
+    }
 }
 
 // Одобрение запроса на админство.
 void db_approve_admin(int64_t user_id)
 {
+    DB_PROFILE("db_approve_admin");
     char *sql = sqlite3_mprintf("UPDATE admins SET IS_APPROVED = 1 WHERE USER_ID = %lld;", (long long)user_id);
-    sqlite3_exec(db_main, sql, 0, 0, 0);
+    bool ok = sqlite3_exec(db_main, sql, 0, 0, 0) == SQLITE_OK && sqlite3_changes(db_main) > 0;
     sqlite3_free(sql);
+    if (ok)
+    {
+        publish_admin_event("admin_approved", user_id);
+    }
 }
 
 // Проверка, является ли пользователь одобренным администратором.
 bool db_is_admin_approved(int64_t user_id, std::string &trade_point)
 {
+    DB_PROFILE("db_is_admin_approved");
     std::string sql = "SELECT TRADE_POINT FROM admins WHERE USER_ID = ? AND IS_APPROVED = 1;";
     sqlite3_stmt *stmt;
     bool approved = false;
@@ -429,6 +817,7 @@ bool db_is_admin_approved(int64_t user_id, std::string &trade_point)
 // Получение всех ожидающих одобрения администраторов.
 std::vector<AdminRequestData> db_get_pending_admin_requests()
 {
+    DB_PROFILE("db_get_pending_admin_requests");
     std::vector<AdminRequestData> requests;
     const char *sql = "SELECT USER_ID, NAME, TRADE_POINT FROM admins WHERE IS_APPROVED = 0;";
     sqlite3_stmt *stmt;
@@ -450,14 +839,20 @@ std::vector<AdminRequestData> db_get_pending_admin_requests()
 // Отклонение запроса на админство.
 void db_decline_admin_request(int64_t user_id)
 {
+    DB_PROFILE("db_decline_admin_request");
     char *sql = sqlite3_mprintf("DELETE FROM admins WHERE USER_ID = %lld;", (long long)user_id);
-    sqlite3_exec(db_main, sql, 0, 0, 0);
+    bool ok = sqlite3_exec(db_main, sql, 0, 0, 0) == SQLITE_OK && sqlite3_changes(db_main) > 0;
     sqlite3_free(sql);
+    if (ok)
+    {
+        publish_admin_event("admin_declined", user_id);
+    }
 }
 
 // Получение ID администраторов по коду торговой точки.
 std::vector<int64_t> db_get_admin_ids_by_trade_point(const std::string &trade_point)
 {
+    DB_PROFILE("db_get_admin_ids_by_trade_point");
     std::vector<int64_t> admin_ids;
     const char *sql = "SELECT USER_ID FROM admins WHERE TRADE_POINT = ? AND IS_APPROVED = 1;";
     sqlite3_stmt *stmt;
@@ -476,6 +871,7 @@ std::vector<int64_t> db_get_admin_ids_by_trade_point(const std::string &trade_po
 // Получение всех одобренных администраторов.
 std::vector<AdminRequestData> db_get_all_admins()
 {
+    DB_PROFILE("db_get_all_admins");
     std::vector<AdminRequestData> admins;
     const char *sql = "SELECT USER_ID, NAME, TRADE_POINT FROM admins WHERE IS_APPROVED = 1;";
     sqlite3_stmt *stmt;
@@ -494,27 +890,61 @@ std::vector<AdminRequestData> db_get_all_admins()
     return admins;
 }
 
+// Обход администраторов (approved) или заявок на админство (!approved) без сборки вектора.
+void db_for_each_admin(bool approved, const std::function<bool(const AdminRequestData &)> &fn)
+{
+    DB_PROFILE("db_for_each_admin");
+    const char *sql = "SELECT USER_ID, NAME, TRADE_POINT FROM admins WHERE IS_APPROVED = ?;";
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db_main, sql, -1, &stmt, 0) == SQLITE_OK)
+    {
+        sqlite3_bind_int(stmt, 1, approved ? 1 : 0);
+        AdminRequestData admin;
+        while (sqlite3_step(stmt) == SQLITE_ROW)
+        {
+            admin.user_id = sqlite3_column_int64(stmt, 0);
+            read_text_column(stmt, 1, admin.name);
+            read_text_column(stmt, 2, admin.trade_point);
+            if (!fn(admin))
+            {
+                break;
+            }
+        }
+    }
+    sqlite3_finalize(stmt);
+}
+
 // Добавление администратора вручную.
 void db_add_admin_manual(int64_t user_id, const std::string &name, const std::string &trade_point)
 {
+    DB_PROFILE("db_add_admin_manual");
     char *sql = sqlite3_mprintf("INSERT OR REPLACE INTO admins (USER_ID, NAME, TRADE_POINT, IS_APPROVED) VALUES (%lld, %Q, %Q, 1);",
                                 (long long)user_id, name.c_str(), trade_point.c_str());
-    sqlite3_exec(db_main, sql, 0, 0, 0);
+    bool ok = sqlite3_exec(db_main, sql, 0, 0, 0) == SQLITE_OK && sqlite3_changes(db_main) > 0;
     sqlite3_free(sql);
+    if (ok)
+    {
+        publish_admin_event("admin_added", user_id, &name, &trade_point);
+    }
 }
 
 // Удаление администратора.
 void db_delete_admin(int64_t user_id)
 {
+    DB_PROFILE("db_delete_admin");
     char *sql = sqlite3_mprintf("DELETE FROM admins WHERE USER_ID = %lld;", (long long)user_id);
-    sqlite3_exec(db_main, sql, nullptr, nullptr, nullptr);
+    bool ok = sqlite3_exec(db_main, sql, 0, 0, 0) == SQLITE_OK && sqlite3_changes(db_main) > 0;
     sqlite3_free(sql);
-    db_delete_session(user_id);
+    if (ok)
+    {
+        publish_admin_event("admin_deleted", user_id);
+    }
 }
 
 // Проверка, существует ли администратор.
 bool db_admin_exists(int64_t user_id)
 {
+    DB_PROFILE("db_admin_exists");
     std::string sql = "SELECT COUNT(*) FROM admins WHERE USER_ID = ? AND IS_APPROVED = 1;";
     sqlite3_stmt *stmt;
     bool exists = false;
@@ -540,27 +970,20 @@ bool db_admin_exists(int64_t user_id)
 // Получение режима работы администратора.
 AdminWorkMode db_get_admin_work_mode(int64_t user_id)
 {
-    const char *sql = "SELECT STATE FROM sessions WHERE USER_ID = ?;";
+    DB_PROFILE("db_get_admin_work_mode");
+    const char *sql = "SELECT ADMIN_MODE FROM sessions WHERE USER_ID = ?;";
     sqlite3_stmt *stmt;
     AdminWorkMode mode = AdminWorkMode::UNKNOWN;
     if (sqlite3_prepare_v2(db_main, sql, -1, &stmt, 0) == SQLITE_OK)
     {
         sqlite3_bind_int64(stmt, 1, user_id);
-        if (sqlite3_step(stmt) == SQLITE_ROW)
+        if (sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_type(stmt, 0) != SQLITE_NULL)
         {
-            int stored_state = sqlite3_column_int(stmt, 0);
-            if (stored_state >= 100)
-            {
-                mode = static_cast<AdminWorkMode>(stored_state - 100);
-            }
-            else
-            {
-                LOG(LogLevel::L_WARNING, "User " << user_id << " has a non-admin session state (" << stored_state << ") when admin work mode was requested.");
-            }
+            mode = static_cast<AdminWorkMode>(sqlite3_column_int(stmt, 0));
         }
         else
         {
-            LOG(LogLevel::INFO, "No session state found for user " << user_id << ". Defaulting to UNKNOWN.");
+            LOG(LogLevel::INFO, "No admin work mode found for user " << user_id << ". Defaulting to UNKNOWN.");
         }
     }
     else
@@ -571,66 +994,301 @@ AdminWorkMode db_get_admin_work_mode(int64_t user_id)
     return mode;
 }
 
-// Сохранение состояния пользователя.
-void db_save_user_state(int64_t user_id, UserState state)
+// Загрузка одной сессии по требованию (SessionManager при промахе кеша).
+bool db_load_session(int64_t user_id, SessionRecord &record)
 {
-    char *sql = sqlite3_mprintf("INSERT OR REPLACE INTO sessions (USER_ID, STATE) VALUES (%lld, %d);",
-                                (long long)user_id, static_cast<int>(state));
-    sqlite3_exec(db_main, sql, 0, 0, 0);
-    sqlite3_free(sql);
-}
-
-// Загрузка состояний пользователей.
-void db_load_user_states(std::map<int64_t, UserData> &session_map)
-{
-    const char *sql = "SELECT USER_ID, STATE FROM sessions;";
+    DB_PROFILE("db_load_session");
+    const char *sql = "SELECT STATE, ADMIN_MODE, DATA FROM sessions WHERE USER_ID = ?;";
     sqlite3_stmt *stmt;
+    bool found = false;
     if (sqlite3_prepare_v2(db_main, sql, -1, &stmt, 0) == SQLITE_OK)
     {
-        while (sqlite3_step(stmt) == SQLITE_ROW)
+        sqlite3_bind_int64(stmt, 1, user_id);
+        if (sqlite3_step(stmt) == SQLITE_ROW)
         {
-            int64_t user_id = sqlite3_column_int64(stmt, 0);
-            auto state = static_cast<UserState>(sqlite3_column_int(stmt, 1));
-            session_map[user_id].state = state;
+            found = true;
+            record.user_id = user_id;
+            record.state = sqlite3_column_int(stmt, 0);
+            record.has_admin_mode = sqlite3_column_type(stmt, 1) != SQLITE_NULL;
+            record.admin_mode = record.has_admin_mode ? sqlite3_column_int(stmt, 1) : 0;
+            const void *blob = sqlite3_column_blob(stmt, 2);
+            if (blob)
+            {
+                record.data.assign(static_cast<const char *>(blob), static_cast<size_t>(sqlite3_column_bytes(stmt, 2)));
+            }
         }
     }
+    else
+    {
+        LOG(LogLevel::L_ERROR, "Failed to prepare SQL statement for db_load_session: " << sqlite3_errmsg(db_main));
+    }
     sqlite3_finalize(stmt);
-    printf("Loaded %zu user states from DB.\n", session_map.size());
+    return found;
 }
 
-// Сохранение режима работы администратора.
-void db_save_admin_work_mode(int64_t user_id, AdminWorkMode mode)
+// Удаление сессии пользователя.
+void db_delete_session(int64_t user_id)
 {
-    char *sql = sqlite3_mprintf("INSERT OR REPLACE INTO sessions (USER_ID, STATE) VALUES (%lld, %d);",
-                                (long long)user_id, static_cast<int>(mode) + 100);
+    DB_PROFILE("db_delete_session");
+    char *sql = sqlite3_mprintf("DELETE FROM sessions WHERE USER_ID = %lld;", (long long)user_id);
     sqlite3_exec(db_main, sql, 0, 0, 0);
     sqlite3_free(sql);
 }
 
-// Загрузка режимов работы администраторов.
-void db_load_admin_work_modes(std::map<int64_t, AdminWorkMode> &mode_map)
+// ========== ПАКЕТНЫЕ ОПЕРАЦИИ ==========
+// Пакет выполняется одной транзакцией с переиспользуемыми подготовленными запросами.
+// Ошибка элемента (нет такой записи) не откатывает остальные; при неудачном COMMIT
+// транзакция откатывается и все элементы помечаются ошибкой. События для ленты
+// публикуются только после успешного COMMIT.
+
+static bool db_exec_simple(const char *sql)
 {
-    const char *sql = "SELECT USER_ID, STATE FROM sessions WHERE STATE >= 100;";
-    sqlite3_stmt *stmt;
-    if (sqlite3_prepare_v2(db_main, sql, -1, &stmt, 0) == SQLITE_OK)
+    char *err = nullptr;
+    if (sqlite3_exec(db_main, sql, 0, 0, &err) != SQLITE_OK)
     {
-        while (sqlite3_step(stmt) == SQLITE_ROW)
+        LOG(LogLevel::L_ERROR, "SQL error (" << sql << "): " << (err ? err : "unknown"));
+        sqlite3_free(err);
+        return false;
+    }
+    return true;
+}
+
+// Выполняет подготовленный запрос изменения; 1 - изменена хотя бы одна строка, 0 - ни одной, -1 - ошибка
+static int db_step_change(sqlite3_stmt *stmt)
+{
+    int rc = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+    if (rc != SQLITE_DONE)
+    {
+        return -1;
+    }
+    return sqlite3_changes(db_main) > 0 ? 1 : 0;
+}
+
+static void db_fail_batch(std::vector<BatchItemResult> &results, const std::string &error)
+{
+    for (auto &result : results)
+    {
+        result.success = false;
+        result.error = error;
+    }
+}
+
+std::vector<BatchItemResult> db_batch_update_application_status(const std::vector<ApplicationStatusUpdate> &items)
+{
+    DB_PROFILE("db_batch_update_application_status");
+    std::vector<BatchItemResult> results(items.size());
+    if (items.empty())
+    {
+        return results;
+    }
+    if (!db_exec_simple("BEGIN IMMEDIATE;"))
+    {
+        db_fail_batch(results, "database is busy");
+        return results;
+    }
+
+    sqlite3_stmt *stmt = nullptr;
+    if (sqlite3_prepare_v2(db_main, "UPDATE applications SET STATUS = ? WHERE ID = ?;", -1, &stmt, 0) != SQLITE_OK)
+    {
+        LOG(LogLevel::L_ERROR, "db_batch_update_application_status: SQL prepare failed: " << sqlite3_errmsg(db_main));
+        sqlite3_finalize(stmt);
+        db_exec_simple("ROLLBACK;");
+        db_fail_batch(results, "database error");
+        return results;
+    }
+
+    std::vector<std::string> statuses(items.size());
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        statuses[i] = statusToString(items[i].status);
+        sqlite3_bind_text(stmt, 1, statuses[i].c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int64(stmt, 2, items[i].id);
+        int changed = db_step_change(stmt);
+        results[i].success = changed > 0;
+        if (changed == 0)
+        {
+            results[i].error = "Application not found";
+        }
+        else if (changed < 0)
         {
-            int64_t user_id = sqlite3_column_int64(stmt, 0);
-            auto mode = static_cast<AdminWorkMode>(sqlite3_column_int(stmt, 1) - 100);
-            mode_map[user_id] = mode;
+            results[i].error = sqlite3_errmsg(db_main);
         }
     }
     sqlite3_finalize(stmt);
-    printf("Loaded %zu super admin modes from DB.\n", mode_map.size());
+
+    if (!db_exec_simple("COMMIT;"))
+    {
+        db_exec_simple("ROLLBACK;");
+        db_fail_batch(results, "transaction failed");
+        return results;
+    }
+
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        if (results[i].success)
+        {
+            publish_application_status(items[i].id, statuses[i]);
+        }
+    }
+    return results;
 }
 
-// Удаление сессии пользователя.
-void db_delete_session(int64_t user_id)
+std::vector<BatchItemResult> db_batch_admin_actions(const std::vector<AdminBatchItem> &items)
 {
-    char *sql = sqlite3_mprintf("DELETE FROM sessions WHERE USER_ID = %lld;", (long long)user_id);
-    sqlite3_exec(db_main, sql, 0, 0, 0);
-    sqlite3_free(sql);
+    DB_PROFILE("db_batch_admin_actions");
+    std::vector<BatchItemResult> results(items.size());
+    if (items.empty())
+    {
+        return results;
+    }
+    if (!db_exec_simple("BEGIN IMMEDIATE;"))
+    {
+        db_fail_batch(results, "database is busy");
+        return results;
+    }
+
+    // Те же запросы, что в db_add_admin_manual / db_approve_admin / db_decline_admin_request / db_delete_admin
+    const char *sqls[] = {
+        "INSERT OR REPLACE INTO admins (USER_ID, NAME, TRADE_POINT, IS_APPROVED) VALUES (?, ?, ?, 1);",
+        "UPDATE admins SET IS_APPROVED = 1 WHERE USER_ID = ?;",
+        "DELETE FROM admins WHERE USER_ID = ?;"};
+    sqlite3_stmt *stmts[3] = {};
+    bool prepared = true;
+    for (int i = 0; i < 3; ++i)
+    {
+        prepared = prepared && sqlite3_prepare_v2(db_main, sqls[i], -1, &stmts[i], 0) == SQLITE_OK;
+    }
+    sqlite3_stmt *add_stmt = stmts[0], *approve_stmt = stmts[1], *delete_stmt = stmts[2];
+
+    for (size_t i = 0; prepared && i < items.size(); ++i)
+    {
+        const AdminBatchItem &item = items[i];
+        int changed = 0;
+        switch (item.action)
+        {
+        case AdminBatchAction::Add:
+            sqlite3_bind_int64(add_stmt, 1, item.user_id);
+            sqlite3_bind_text(add_stmt, 2, item.name.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(add_stmt, 3, item.trade_point.c_str(), -1, SQLITE_TRANSIENT);
+            changed = db_step_change(add_stmt);
+            break;
+        case AdminBatchAction::Approve:
+            sqlite3_bind_int64(approve_stmt, 1, item.user_id);
+            changed = db_step_change(approve_stmt);
+            break;
+        case AdminBatchAction::Decline:
+        case AdminBatchAction::Delete:
+            sqlite3_bind_int64(delete_stmt, 1, item.user_id);
+            changed = db_step_change(delete_stmt);
+            break;
+        }
+        results[i].success = changed > 0;
+        if (changed == 0)
+        {
+            results[i].error = "Admin not found";
+        }
+        else if (changed < 0)
+        {
+            results[i].error = sqlite3_errmsg(db_main);
+        }
+    }
+    for (sqlite3_stmt *stmt : stmts)
+    {
+        sqlite3_finalize(stmt);
+    }
+
+    if (!prepared)
+    {
+        LOG(LogLevel::L_ERROR, "db_batch_admin_actions: SQL prepare failed: " << sqlite3_errmsg(db_main));
+        db_exec_simple("ROLLBACK;");
+        db_fail_batch(results, "database error");
+        return results;
+    }
+    if (!db_exec_simple("COMMIT;"))
+    {
+        db_exec_simple("ROLLBACK;");
+        db_fail_batch(results, "transaction failed");
+        return results;
+    }
+
+    static const char *event_types[] = {"admin_added", "admin_approved", "admin_declined", "admin_deleted"};
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        if (!results[i].success)
+        {
+            continue;
+        }
+        const AdminBatchItem &item = items[i];
+        const char *type = event_types[static_cast<int>(item.action)];
+        if (item.action == AdminBatchAction::Add)
+        {
+            publish_admin_event(type, item.user_id, &item.name, &item.trade_point);
+        }
+        else
+        {
+            publish_admin_event(type, item.user_id);
+        }
+    }
+    return results;
+}
+
+bool db_save_sessions(const std::vector<SessionRecord> &records)
+{
+    DB_PROFILE("db_save_sessions");
+    if (records.empty())
+    {
+        return true;
+    }
+    if (!db_exec_simple("BEGIN IMMEDIATE;"))
+    {
+        return false;
+    }
+
+    sqlite3_stmt *upsert = nullptr;
+    sqlite3_stmt *remove = nullptr;
+    bool ok = sqlite3_prepare_v2(db_main,
+                                 "INSERT INTO sessions (USER_ID, STATE, ADMIN_MODE, DATA) VALUES (?, ?, ?, ?) "
+                                 "ON CONFLICT(USER_ID) DO UPDATE SET STATE = excluded.STATE, "
+                                 "ADMIN_MODE = excluded.ADMIN_MODE, DATA = excluded.DATA;",
+                                 -1, &upsert, 0) == SQLITE_OK &&
+              sqlite3_prepare_v2(db_main, "DELETE FROM sessions WHERE USER_ID = ?;", -1, &remove, 0) == SQLITE_OK;
+
+    for (size_t i = 0; ok && i < records.size(); ++i)
+    {
+        const SessionRecord &record = records[i];
+        if (record.data.empty())
+        {
+            sqlite3_bind_int64(remove, 1, record.user_id);
+            ok = db_step_change(remove) >= 0;
+            continue;
+        }
+        sqlite3_bind_int64(upsert, 1, record.user_id);
+        sqlite3_bind_int(upsert, 2, record.state);
+        if (record.has_admin_mode)
+        {
+            sqlite3_bind_int(upsert, 3, record.admin_mode);
+        }
+        else
+        {
+            sqlite3_bind_null(upsert, 3);
+        }
+        sqlite3_bind_blob(upsert, 4, record.data.data(), static_cast<int>(record.data.size()), SQLITE_STATIC);
+        ok = db_step_change(upsert) >= 0;
+    }
+    if (!ok)
+    {
+        LOG(LogLevel::L_ERROR, "db_save_sessions: " << sqlite3_errmsg(db_main));
+    }
+    sqlite3_finalize(upsert);
+    sqlite3_finalize(remove);
+
+    if (ok && db_exec_simple("COMMIT;"))
+    {
+        return true;
+    }
+    db_exec_simple("ROLLBACK;");
+    return false;
 }
 
 // Конвертация статуса заявки в строку.
@@ -672,6 +1330,7 @@ std::string chatStatusToString(ChatStatus status)
 // Обновление статуса чата.
 void db_update_chat_status(long long application_id, ChatStatus status, int64_t admin_id, const std::string &postponed_until)
 {
+    DB_PROFILE("db_update_chat_status");
     std::string status_str = chatStatusToString(status);
     char *sql = nullptr;
     if (status == ChatStatus::Postponed && !postponed_until.empty())
@@ -692,6 +1351,7 @@ void db_update_chat_status(long long application_id, ChatStatus status, int64_t
 // Добавление сообщения в историю чата.
 void db_add_chat_message(long long application_id, const ChatMessage &message)
 {
+    DB_PROFILE("db_add_chat_message");
     char *sql = sqlite3_mprintf("INSERT INTO conversations (APPLICATION_ID, SENDER, MESSAGE) VALUES (%lld, %Q, %Q);",
                                 application_id, message.sender.c_str(), message.text.c_str());
     sqlite3_exec(db_main, sql, 0, 0, 0);
@@ -701,6 +1361,7 @@ void db_add_chat_message(long long application_id, const ChatMessage &message)
 // Получение истории чата.
 std::vector<ChatMessage> db_get_chat_history(long long application_id)
 {
+    DB_PROFILE("db_get_chat_history");
     std::vector<ChatMessage> history;
     char *sql = sqlite3_mprintf("SELECT SENDER, MESSAGE, TIMESTAMP FROM conversations WHERE APPLICATION_ID = %lld ORDER BY TIMESTAMP ASC;", application_id);
     sqlite3_exec(db_main, sql, db_chat_history_callback, &history, 0);
@@ -711,6 +1372,7 @@ std::vector<ChatMessage> db_get_chat_history(long long application_id)
 // Получение ID администратора, который ведет чат.
 int64_t db_get_chat_admin(long long application_id)
 {
+    DB_PROFILE("db_get_chat_admin");
     const char *sql = "SELECT CHAT_ADMIN_ID FROM applications WHERE ID = ?;";
     sqlite3_stmt *stmt;
     int64_t admin_id = 0;
@@ -724,4 +1386,122 @@ int64_t db_get_chat_admin(long long application_id)
     }
     sqlite3_finalize(stmt);
     return admin_id;
-}
\ No newline at end of file
+}
+
+// Отложенные чаты, срок которых наступил.
+std::vector<PostponedChat> db_get_due_postponed_chats()
+{
+    DB_PROFILE("db_get_due_postponed_chats");
+    std::vector<PostponedChat> chats;
+    const char *sql = "SELECT ID, USER_ID, CHAT_ADMIN_ID, NAME, PHONE, CHAT_POSTPONED_UNTIL FROM applications "
+                      "WHERE CHAT_STATUS = 'Postponed' AND CHAT_ADMIN_ID != 0 "
+                      "AND CHAT_POSTPONED_UNTIL IS NOT NULL AND CHAT_POSTPONED_UNTIL <= datetime('now') "
+                      "ORDER BY CHAT_POSTPONED_UNTIL;";
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db_main, sql, -1, &stmt, 0) == SQLITE_OK)
+    {
+        while (sqlite3_step(stmt) == SQLITE_ROW)
+        {
+            PostponedChat chat;
+            chat.application_id = sqlite3_column_int64(stmt, 0);
+            chat.user_id = sqlite3_column_int64(stmt, 1);
+            chat.admin_id = sqlite3_column_int64(stmt, 2);
+            read_text_column(stmt, 3, chat.name);
+            read_text_column(stmt, 4, chat.phone);
+            read_text_column(stmt, 5, chat.postponed_until);
+            chats.push_back(std::move(chat));
+        }
+    }
+    else
+    {
+        LOG(LogLevel::L_ERROR, "db_get_due_postponed_chats: SQL prepare failed: " << sqlite3_errmsg(db_main));
+    }
+    sqlite3_finalize(stmt);
+    return chats;
+}
+
+// Снятие срока отложенного чата.
+void db_clear_chat_postponed(long long application_id)
+{
+    DB_PROFILE("db_clear_chat_postponed");
+    const char *sql = "UPDATE applications SET CHAT_POSTPONED_UNTIL = NULL WHERE ID = ?;";
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db_main, sql, -1, &stmt, 0) == SQLITE_OK)
+    {
+        sqlite3_bind_int64(stmt, 1, application_id);
+        if (sqlite3_step(stmt) != SQLITE_DONE)
+        {
+            LOG(LogLevel::L_ERROR, "db_clear_chat_postponed: " << sqlite3_errmsg(db_main));
+        }
+    }
+    sqlite3_finalize(stmt);
+}
+
+// Загрузка состояния задач планировщика.
+std::vector<ScheduledJobRecord> db_load_scheduled_jobs()
+{
+    DB_PROFILE("db_load_scheduled_jobs");
+    std::vector<ScheduledJobRecord> jobs;
+    const char *sql = "SELECT NAME, KIND, PAYLOAD, SCHEDULE, NEXT_RUN, LAST_RUN FROM scheduled_jobs;";
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db_main, sql, -1, &stmt, 0) == SQLITE_OK)
+    {
+        while (sqlite3_step(stmt) == SQLITE_ROW)
+        {
+            ScheduledJobRecord job;
+            read_text_column(stmt, 0, job.name);
+            read_text_column(stmt, 1, job.kind);
+            read_text_column(stmt, 2, job.payload);
+            read_text_column(stmt, 3, job.schedule);
+            job.next_run = sqlite3_column_int64(stmt, 4);
+            job.last_run = sqlite3_column_int64(stmt, 5);
+            jobs.push_back(std::move(job));
+        }
+    }
+    else
+    {
+        LOG(LogLevel::L_ERROR, "db_load_scheduled_jobs: SQL prepare failed: " << sqlite3_errmsg(db_main));
+    }
+    sqlite3_finalize(stmt);
+    return jobs;
+}
+
+// Сохранение (вставка или замена) задачи планировщика.
+void db_save_scheduled_job(const ScheduledJobRecord &job)
+{
+    DB_PROFILE("db_save_scheduled_job");
+    const char *sql = "INSERT OR REPLACE INTO scheduled_jobs (NAME, KIND, PAYLOAD, SCHEDULE, NEXT_RUN, LAST_RUN) "
+                      "VALUES (?, ?, ?, ?, ?, ?);";
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db_main, sql, -1, &stmt, 0) == SQLITE_OK)
+    {
+        sqlite3_bind_text(stmt, 1, job.name.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 2, job.kind.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 3, job.payload.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 4, job.schedule.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_int64(stmt, 5, job.next_run);
+        sqlite3_bind_int64(stmt, 6, job.last_run);
+        if (sqlite3_step(stmt) != SQLITE_DONE)
+        {
+            LOG(LogLevel::L_ERROR, "db_save_scheduled_job '" << job.name << "': " << sqlite3_errmsg(db_main));
+        }
+    }
+    sqlite3_finalize(stmt);
+}
+
+// Удаление задачи планировщика.
+void db_delete_scheduled_job(const std::string &name)
+{
+    DB_PROFILE("db_delete_scheduled_job");
+    const char *sql = "DELETE FROM scheduled_jobs WHERE NAME = ?;";
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db_main, sql, -1, &stmt, 0) == SQLITE_OK)
+    {
+        sqlite3_bind_text(stmt, 1, name.c_str(), -1, SQLITE_STATIC);
+        if (sqlite3_step(stmt) != SQLITE_DONE)
+        {
+            LOG(LogLevel::L_ERROR, "db_delete_scheduled_job '" << name << "': " << sqlite3_errmsg(db_main));
+        }
+    }
+    sqlite3_finalize(stmt);
+}
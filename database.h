@@ -2,9 +2,10 @@
 #include <string>
 #include <vector>
 #include <cstdint>
-#include <map>
+#include <functional>
 
 // Forward declarations
+struct sqlite3;
 struct UserData;
 struct ApplicationDataForReport;
 enum class UserState;
@@ -28,11 +29,62 @@ struct ChatMessage
     std::string timestamp;
 };
 
+// Результат одного элемента пакетной операции
+struct BatchItemResult
+{
+    bool success = false;
+    std::string error;
+};
+
+struct ApplicationStatusUpdate
+{
+    long long id;
+    ApplicationStatus status;
+};
+
+// Порядок совпадает с типами событий admin_added/approved/declined/deleted
+enum class AdminBatchAction
+{
+    Add,
+    Approve,
+    Decline,
+    Delete
+};
+
+struct AdminBatchItem
+{
+    AdminBatchAction action;
+    int64_t user_id;
+    std::string name;        // только для Add
+    std::string trade_point; // только для Add
+};
+
+// Итог db_add_application (поиск дублей по applications.FINGERPRINT, см. application_fingerprint.h)
+enum class ApplicationInsertOutcome
+{
+    Created,  // новая заявка
+    Linked,   // дубль в окне: сохранён с DUPLICATE_OF = original_id, админам не показывается
+    Rejected, // дубль в окне при applications.dedup_action = "reject": не сохранён
+    Failed
+};
+
+struct ApplicationInsertResult
+{
+    ApplicationInsertOutcome outcome = ApplicationInsertOutcome::Failed;
+    int64_t id = 0;          // ID сохранённой заявки
+    int64_t original_id = 0; // ID заявки, дублем которой оказалась эта
+};
+
 // Определяем путь к базе данных
 #define DB_PATH "db/bot_data.db"
 
+// db_* функции можно вызывать из любого потока: обращения к основному соединению
+// сериализуются, транзакция одной функции не смешивается с запросами других потоков
 void db_init();
 void db_close();
+// Read-only соединение для фоновых выгрузок (один поток на соединение); nullptr - ошибка
+sqlite3 *db_open_readonly();
+void db_close_readonly(sqlite3 *db);
 
 // Функции для управления статусом бота
 void db_init_bot_settings();
@@ -40,11 +92,30 @@ bool db_get_bot_status();
 void db_set_bot_status(bool active_status);
 
 // Функции для работы с заявками
-void db_add_application(int64_t user_id, const UserData &data, const std::string &full_address, int total_monthly);
+ApplicationInsertResult db_add_application(int64_t user_id, const UserData &data, const std::string &full_address, int total_monthly);
 std::string db_get_my_apps(int64_t user_id);
 std::string db_get_apps_by_trade_point(const std::string &trade_point_code);
-std::vector<ApplicationDataForReport> db_get_apps_data_for_report(const std::string &trade_point_code);
+// Сводка для /api/stats: заявки по статусам (без привязанных дублей) и админы
+struct DashboardStats
+{
+    int64_t applications = 0;
+    int64_t new_applications = 0;
+    int64_t in_progress = 0;
+    int64_t completed = 0;
+    int64_t admins = 0;
+    int64_t pending_admins = 0;
+};
+
+// Списки для HTTP API без привязанных дублей (DUPLICATE_OF), как лента application_created
 std::vector<ApplicationDataForReport> db_get_all_applications();
+size_t db_for_each_application(int64_t before_id, size_t limit, const std::function<bool(const ApplicationDataForReport &)> &fn);
+// Счётчики агрегатами GROUP BY, без загрузки строк
+DashboardStats db_get_dashboard_stats();
+// Потоковый обход заявок точки для отчёта (без дублей, по убыванию ID); from/to - 'YYYY-MM-DD'
+// включительно, пустая строка - без границы. fn получает одну переиспользуемую структуру.
+// db - соединение из db_open_readonly (nullptr - основное).
+size_t db_for_each_report_row(const std::string &trade_point_code, const std::string &from_date, const std::string &to_date,
+                              const std::function<bool(const ApplicationDataForReport &)> &fn, sqlite3 *db = nullptr);
 #include <optional>
 std::optional<ApplicationDataForReport> db_get_application_by_id(int64_t app_id);
 void db_update_application_status(long long application_id, ApplicationStatus status);
@@ -57,19 +128,36 @@ std::vector<AdminRequestData> db_get_pending_admin_requests();
 void db_decline_admin_request(int64_t user_id);
 std::vector<int64_t> db_get_admin_ids_by_trade_point(const std::string &trade_point);
 std::vector<AdminRequestData> db_get_all_admins();
+void db_for_each_admin(bool approved, const std::function<bool(const AdminRequestData &)> &fn);
 void db_add_admin_manual(int64_t user_id, const std::string &name, const std::string &trade_point);
+// Сессию админа не трогает: её удаляет SessionManager::removeUserData
 void db_delete_admin(int64_t user_id);
 bool db_admin_exists(int64_t user_id);
 int64_t db_get_chat_admin(long long application_id); // <-- Добавлено
 
+// Снимок сессии для отложенной записи (см. SessionManager::markDirty)
+struct SessionRecord
+{
+    int64_t user_id = 0;
+    int state = 0;
+    bool has_admin_mode = false;
+    int admin_mode = 0;
+    std::string data; // encodeUserData; пусто - сессия удалена
+};
+
 // Функции для управления сессиями пользователей
-void db_save_user_state(int64_t user_id, UserState state);
-void db_load_user_states(std::map<int64_t, UserData> &session_map);
-void db_save_admin_work_mode(int64_t user_id, AdminWorkMode mode);
-void db_load_admin_work_modes(std::map<int64_t, AdminWorkMode> &mode_map);
+// Записывает пакет сессий одной транзакцией (пустой data удаляет строку); false - откат
+bool db_save_sessions(const std::vector<SessionRecord> &records);
+// Одна сессия (состояние, режим админа, DATA) для ленивой загрузки; false - строки нет
+bool db_load_session(int64_t user_id, SessionRecord &record);
+// Только для SessionManager::removeUserData (строку иначе вернёт write-behind)
 void db_delete_session(int64_t user_id);
 AdminWorkMode db_get_admin_work_mode(int64_t user_id);
 
+// Пакетные операции: одна транзакция, результат на каждый элемент в порядке запроса
+std::vector<BatchItemResult> db_batch_update_application_status(const std::vector<ApplicationStatusUpdate> &items);
+std::vector<BatchItemResult> db_batch_admin_actions(const std::vector<AdminBatchItem> &items);
+
 // Вспомогательные функции
 std::string statusToString(ApplicationStatus status);
 std::string chatStatusToString(ChatStatus status);
@@ -77,4 +165,35 @@ std::string chatStatusToString(ChatStatus status);
 // Функции для работы с чатом
 void db_update_chat_status(long long application_id, ChatStatus status, int64_t admin_id = 0, const std::string &postponed_until = "");
 void db_add_chat_message(long long application_id, const ChatMessage &message);
-std::vector<ChatMessage> db_get_chat_history(long long application_id);
\ No newline at end of file
+std::vector<ChatMessage> db_get_chat_history(long long application_id);
+
+// Отложенный чат, время которого наступило (см. db_get_due_postponed_chats)
+struct PostponedChat
+{
+    int64_t application_id = 0;
+    int64_t user_id = 0;
+    int64_t admin_id = 0;
+    std::string name;
+    std::string phone;
+    std::string postponed_until;
+};
+
+// Отложенные чаты с назначенным админом и CHAT_POSTPONED_UNTIL <= текущего времени (UTC, как TIMESTAMP)
+std::vector<PostponedChat> db_get_due_postponed_chats();
+// Снимает срок отложенного чата после напоминания (статус Postponed остаётся)
+void db_clear_chat_postponed(long long application_id);
+
+// Состояние задачи планировщика (таблица scheduled_jobs); пустое schedule - разовая задача
+struct ScheduledJobRecord
+{
+    std::string name;
+    std::string kind;
+    std::string payload;
+    std::string schedule;
+    int64_t next_run = 0; // unix-время
+    int64_t last_run = 0; // 0 - ещё не запускалась
+};
+
+std::vector<ScheduledJobRecord> db_load_scheduled_jobs();
+void db_save_scheduled_job(const ScheduledJobRecord &job);
+void db_delete_scheduled_job(const std::string &name);
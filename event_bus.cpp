@@ -0,0 +1,140 @@
+#include "event_bus.h"
+#include "metrics.h"
+#include <algorithm>
+#include <cstdlib>
+
+EventBus &EventBus::instance()
+{
+    static EventBus bus;
+    return bus;
+}
+
+EventBus::EventBus()
+    : boot_id_(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(
+                                         std::chrono::system_clock::now().time_since_epoch())
+                                         .count()))
+{
+    MetricsRegistry::instance().gaugeCallback("bot_sse_subscribers", "Connected /api/events subscribers", [this]()
+                                              { return static_cast<double>(subscriberCount()); });
+}
+
+void EventBus::publish(const char *type, std::string data)
+{
+    static Counter &published = MetricsRegistry::instance().counter("bot_events_published_total", "Events published to the dashboard event bus");
+    static Counter &overflows = MetricsRegistry::instance().counter("bot_sse_overflows_total", "SSE subscriber buffers that overflowed and required a resync");
+
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto event = std::make_shared<const BusEvent>(BusEvent{next_seq_++, type, std::move(data)});
+    published.inc();
+
+    history_.push_back(event);
+    if (history_.size() > kHistorySize)
+    {
+        history_.pop_front();
+    }
+
+    for (auto &sub : subscribers_)
+    {
+        if (sub->resync)
+        {
+            continue; // клиент всё равно перечитает данные целиком
+        }
+        if (sub->queue.size() >= kSubscriberBuffer)
+        {
+            sub->queue.clear();
+            sub->resync = true;
+            overflows.inc();
+            continue;
+        }
+        sub->queue.push_back(event);
+    }
+    cv_.notify_all();
+}
+
+std::shared_ptr<EventBus::Subscription> EventBus::subscribe(const std::string &last_event_id)
+{
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (stopped_ || subscribers_.size() >= max_subscribers_)
+    {
+        return nullptr;
+    }
+
+    auto sub = std::make_shared<Subscription>();
+    if (!last_event_id.empty())
+    {
+        // Продолжение возможно только в том же процессе и пока нужные события есть в истории
+        char *end = nullptr;
+        uint64_t boot = std::strtoull(last_event_id.c_str(), &end, 10);
+        uint64_t last_seq = (end && *end == '-') ? std::strtoull(end + 1, nullptr, 10) : 0;
+        uint64_t oldest = history_.empty() ? next_seq_ : history_.front()->seq;
+        if (boot != boot_id_ || last_seq + 1 < oldest || last_seq >= next_seq_)
+        {
+            sub->resync = true;
+        }
+        else
+        {
+            for (const auto &event : history_)
+            {
+                if (event->seq > last_seq)
+                {
+                    sub->queue.push_back(event);
+                }
+            }
+            if (sub->queue.size() > kSubscriberBuffer)
+            {
+                sub->queue.clear();
+                sub->resync = true;
+            }
+        }
+    }
+    subscribers_.push_back(sub);
+    return sub;
+}
+
+void EventBus::setMaxSubscribers(size_t max_subscribers)
+{
+    std::lock_guard<std::mutex> lock(mtx_);
+    max_subscribers_ = max_subscribers;
+}
+
+void EventBus::unsubscribe(const std::shared_ptr<Subscription> &sub)
+{
+    std::lock_guard<std::mutex> lock(mtx_);
+    subscribers_.erase(std::remove(subscribers_.begin(), subscribers_.end(), sub), subscribers_.end());
+}
+
+bool EventBus::wait(Subscription &sub, std::vector<std::shared_ptr<const BusEvent>> &out, bool &resync,
+                    std::chrono::milliseconds timeout)
+{
+    std::unique_lock<std::mutex> lock(mtx_);
+    cv_.wait_for(lock, timeout, [&]()
+                 { return stopped_ || sub.resync || !sub.queue.empty(); });
+    if (stopped_)
+    {
+        return false;
+    }
+    resync = sub.resync;
+    sub.resync = false;
+    out.assign(sub.queue.begin(), sub.queue.end());
+    sub.queue.clear();
+    return true;
+}
+
+void EventBus::shutdown()
+{
+    std::lock_guard<std::mutex> lock(mtx_);
+    stopped_ = true;
+    subscribers_.clear();
+    cv_.notify_all();
+}
+
+std::string EventBus::formatId(uint64_t seq) const
+{
+    return std::to_string(boot_id_) + "-" + std::to_string(seq);
+}
+
+size_t EventBus::subscriberCount() const
+{
+    std::lock_guard<std::mutex> lock(mtx_);
+    return subscribers_.size();
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Событие шины: тип ("application_created", "application_status", ...) и JSON-тело
+struct BusEvent
+{
+    uint64_t seq;
+    std::string type;
+    std::string data;
+};
+
+/**
+ * EventBus - внутрипроцессная шина изменений для живой ленты админ-панели (GET /api/events).
+ * db_* функции публикуют небольшие дельты, каждый SSE-подписчик получает их через
+ * собственную ограниченную очередь. Последние kHistorySize событий хранятся для
+ * продолжения после переподключения по Last-Event-ID.
+ */
+class EventBus
+{
+public:
+    static constexpr size_t kHistorySize = 512;
+    static constexpr size_t kSubscriberBuffer = 128;
+
+    struct Subscription
+    {
+        std::deque<std::shared_ptr<const BusEvent>> queue;
+        // Очередь переполнилась или Last-Event-ID устарел: клиент должен перечитать данные
+        bool resync = false;
+    };
+
+    static EventBus &instance();
+
+    // Публикует событие всем подписчикам (data - готовый JSON)
+    void publish(const char *type, std::string data);
+
+    // nullptr, если подписчиков слишком много или шина остановлена.
+    // last_event_id - значение заголовка Last-Event-ID ("" для нового подключения).
+    std::shared_ptr<Subscription> subscribe(const std::string &last_event_id);
+    void unsubscribe(const std::shared_ptr<Subscription> &sub);
+
+    // Каждый подписчик занимает поток пула httplib, поэтому их число ограничено
+    void setMaxSubscribers(size_t max_subscribers);
+
+    // Ждёт событий подписчика до timeout и забирает их в out; resync выставляется,
+    // если часть событий потеряна. false - шина остановлена.
+    bool wait(Subscription &sub, std::vector<std::shared_ptr<const BusEvent>> &out, bool &resync,
+              std::chrono::milliseconds timeout);
+
+    // Будит всех ожидающих и закрывает подписки (вызывается при остановке HTTP-сервера)
+    void shutdown();
+
+    // Значение поля id SSE-события: "<boot>-<seq>", boot отличает перезапуски процесса
+    std::string formatId(uint64_t seq) const;
+
+    size_t subscriberCount() const;
+
+private:
+    EventBus();
+    EventBus(const EventBus &) = delete;
+    EventBus &operator=(const EventBus &) = delete;
+
+    mutable std::mutex mtx_;
+    std::condition_variable cv_;
+    std::deque<std::shared_ptr<const BusEvent>> history_;
+    std::vector<std::shared_ptr<Subscription>> subscribers_;
+    size_t max_subscribers_ = 4;
+    uint64_t next_seq_ = 1;
+    uint64_t boot_id_;
+    bool stopped_ = false;
+};
@@ -1,41 +1,136 @@
 #include "main.h"
 #include "excel_generate.h"
-#include <vector>
 #include <string>
 #include <chrono>
-#include <sstream>
-#include <cstdio>
-#include <fstream>
+#include <iterator>
 #include "database.h"
 
 #ifdef HAS_XLNT
 #include <xlnt/xlnt.hpp>
+#include <vector>
 #endif
 
-std::string generate_excel_report(const std::string& trade_point) {
-    // 1. Получаем данные из БД
-    std::vector<ApplicationDataForReport> data = db_get_apps_data_for_report(trade_point);
+namespace {
+    const char* const kColumnTitles[] = {"ID Заявки", "Дата и время", "Имя клиента", "Телефон", "Почта",
+                                         "Тариф", "Стоимость", "Адрес", "ID клиента в TG"};
+
+    // report_<точка>[_<с>_<по>]_<время>.<ext>
+    std::string report_file_name(const std::string& trade_point, const ReportDateRange& range, const char* extension) {
+        std::string name = "report_" + trade_point;
+        if (!range.from.empty() || !range.to.empty()) {
+            name += "_" + (range.from.empty() ? std::string("start") : range.from) + "_" + (range.to.empty() ? std::string("now") : range.to);
+        }
+        name += "_" + std::to_string(std::chrono::system_clock::to_time_t(std::chrono::system_clock::now()));
+        name += extension;
+        return name;
+    }
+
+    bool is_date(std::string_view s) {
+        if (s.size() != 10 || s[4] != '-' || s[7] != '-') {
+            return false;
+        }
+        for (size_t i : {0, 1, 2, 3, 5, 6, 8, 9}) {
+            if (s[i] < '0' || s[i] > '9') {
+                return false;
+            }
+        }
+        const int month = (s[5] - '0') * 10 + (s[6] - '0');
+        const int day = (s[8] - '0') * 10 + (s[9] - '0');
+        return month >= 1 && month <= 12 && day >= 1 && day <= 31;
+    }
+}
+
+void append_csv_field(std::string& out, std::string_view value) {
+    if (value.find_first_of(";\"\r\n") == std::string_view::npos) {
+        out.append(value.data(), value.size());
+        return;
+    }
+    out += '"';
+    for (char c : value) {
+        if (c == '"') {
+            out += '"';
+        }
+        out += c;
+    }
+    out += '"';
+}
+
+void append_csv_report_header(std::string& out) {
+    // BOM для корректного отображения кириллицы в Excel
+    out += "\xEF\xBB\xBF";
+    for (size_t i = 0; i < std::size(kColumnTitles); ++i) {
+        if (i > 0) {
+            out += ';';
+        }
+        out += kColumnTitles[i];
+    }
+    out += '\n';
+}
+
+size_t append_csv_report_rows(const std::string& trade_point, const ReportDateRange& range, std::string& out, sqlite3* db) {
+    return db_for_each_report_row(trade_point, range.from, range.to, [&out](const ApplicationDataForReport& app) {
+        out += std::to_string(app.id);
+        out += ';';
+        append_csv_field(out, app.timestamp);
+        out += ';';
+        append_csv_field(out, app.name);
+        out += ';';
+        append_csv_field(out, app.phone);
+        out += ';';
+        append_csv_field(out, app.email);
+        out += ';';
+        append_csv_field(out, app.tariff);
+        out += ';';
+        append_csv_field(out, app.price);
+        out += ';';
+        append_csv_field(out, app.address);
+        out += ';';
+        out += std::to_string(app.user_id);
+        out += '\n';
+        return true;
+    }, db);
+}
+
+bool parse_report_date_range(std::string_view text, ReportDateRange& range) {
+    while (!text.empty() && text.front() == ' ') {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && text.back() == ' ') {
+        text.remove_suffix(1);
+    }
+    const size_t space = text.find(' ');
+    const std::string_view from = text.substr(0, space);
+    std::string_view to = from;
+    if (space != std::string_view::npos) {
+        to = text.substr(space + 1);
+        while (!to.empty() && to.front() == ' ') {
+            to.remove_prefix(1);
+        }
+    }
+    // Даты в формате ISO сравниваются как строки
+    if (!is_date(from) || !is_date(to) || to < from) {
+        return false;
+    }
+    range.from.assign(from.data(), from.size());
+    range.to.assign(to.data(), to.size());
+    return true;
+}
+
+ReportFile generate_excel_report(const std::string& trade_point, const ReportDateRange& range, sqlite3* db) {
+    ReportFile report;
 
 #ifdef HAS_XLNT
-    // С xlnt - создаем настоящий Excel файл
+    // С xlnt - настоящий Excel файл, сохраняемый в память
     xlnt::workbook wb;
     xlnt::worksheet ws = wb.active_sheet();
     ws.title("Заявки");
 
-    // Заполняем заголовки
-    ws.cell("A1").value("ID Заявки");
-    ws.cell("B1").value("Дата и время");
-    ws.cell("C1").value("Имя клиента");
-    ws.cell("D1").value("Телефон");
-    ws.cell("E1").value("Почта");
-    ws.cell("F1").value("Тариф");
-    ws.cell("G1").value("Стоимость");
-    ws.cell("H1").value("Адрес");
-    ws.cell("I1").value("ID клиента в TG");
+    for (size_t i = 0; i < std::size(kColumnTitles); ++i) {
+        ws.cell(static_cast<xlnt::column_t::index_t>(i + 1), 1).value(kColumnTitles[i]);
+    }
 
-    // Заполняем данными
-    int row = 2;
-    for (const auto& app : data) {
+    xlnt::row_t row = 2;
+    report.rows = db_for_each_report_row(trade_point, range.from, range.to, [&ws, &row](const ApplicationDataForReport& app) {
         ws.cell(1, row).value(app.id);
         ws.cell(2, row).value(app.timestamp);
         ws.cell(3, row).value(app.name);
@@ -46,43 +141,21 @@ std::string generate_excel_report(const std::string& trade_point) {
         ws.cell(8, row).value(app.address);
         ws.cell(9, row).value(app.user_id);
         row++;
-    }
-
-    // Генерируем имя файла
-    auto now = std::chrono::system_clock::now();
-    auto in_time_t = std::chrono::system_clock::to_time_t(now);
-    std::stringstream ss;
-    ss << "report_" << trade_point << "_" << in_time_t << ".xlsx";
-    std::string filename = ss.str();
+        return true;
+    }, db);
 
-    wb.save(filename);
-    return filename;
+    std::vector<std::uint8_t> bytes;
+    wb.save(bytes);
+    report.data.assign(bytes.begin(), bytes.end());
+    report.file_name = report_file_name(trade_point, range, ".xlsx");
+    report.mime_type = "application/vnd.openxmlformats-officedocument.spreadsheetml.sheet";
 
 #else
-    // Без xlnt - создаем CSV файл (совместим с Excel)
-    auto now = std::chrono::system_clock::now();
-    auto in_time_t = std::chrono::system_clock::to_time_t(now);
-    std::stringstream ss;
-    ss << "report_" << trade_point << "_" << in_time_t << ".csv";
-    std::string filename = ss.str();
-
-    std::ofstream file(filename);
-    // BOM для корректного отображения кириллицы в Excel
-    file << "\xEF\xBB\xBF";
-    file << "ID Заявки;Дата и время;Имя клиента;Телефон;Почта;Тариф;Стоимость;Адрес;ID клиента в TG\n";
-    
-    for (const auto& app : data) {
-        file << app.id << ";"
-             << app.timestamp << ";"
-             << app.name << ";"
-             << app.phone << ";"
-             << app.email << ";"
-             << app.tariff << ";"
-             << app.price << ";"
-             << app.address << ";"
-             << app.user_id << "\n";
-    }
-    file.close();
-    return filename;
+    // Без xlnt - CSV (совместим с Excel), строки пишутся в буфер прямо из курсора
+    append_csv_report_header(report.data);
+    report.rows = append_csv_report_rows(trade_point, range, report.data, db);
+    report.file_name = report_file_name(trade_point, range, ".csv");
+    report.mime_type = "text/csv";
 #endif
-}
\ No newline at end of file
+    return report;
+}
@@ -1,4 +1,35 @@
 #pragma once
+#include <cstddef>
 #include <string>
+#include <string_view>
 
-std::string generate_excel_report(const std::string& trade_point);
\ No newline at end of file
+struct sqlite3;
+
+// Период отчёта: даты "YYYY-MM-DD" включительно, пустая строка - без границы
+struct ReportDateRange {
+    std::string from;
+    std::string to;
+};
+
+// Готовый отчёт в памяти - отправляется как InputFile без записи на диск
+struct ReportFile {
+    std::string file_name;
+    std::string mime_type;
+    std::string data;
+    size_t rows = 0;
+};
+
+// Отчёт по заявкам точки: xlsx при сборке с xlnt, иначе CSV. Строки читаются курсором
+// db_for_each_report_row и сразу пишутся в буфер, промежуточного вектора заявок нет.
+// db - read-only соединение фоновой задачи (nullptr - основное)
+ReportFile generate_excel_report(const std::string& trade_point, const ReportDateRange& range = {}, sqlite3* db = nullptr);
+
+// CSV для Excel: UTF-8 с BOM, разделитель ';'. Заголовок и строки дописываются в out
+void append_csv_report_header(std::string& out);
+// Строки точки за период; возвращает их количество. db - read-only соединение (nullptr - основное)
+size_t append_csv_report_rows(const std::string& trade_point, const ReportDateRange& range, std::string& out, sqlite3* db = nullptr);
+// Поле CSV: в кавычках с удвоением '"', если содержит ';', '"' или перевод строки
+void append_csv_field(std::string& out, std::string_view value);
+
+// Разбор "YYYY-MM-DD YYYY-MM-DD" (или одной даты - отчёт за день); false - неверный формат
+bool parse_report_date_range(std::string_view text, ReportDateRange& range);
@@ -0,0 +1,205 @@
+#include "http_compression.h"
+#include <cstdlib>
+#include <zlib.h>
+
+namespace
+{
+    std::string trim(const std::string &s)
+    {
+        size_t begin = s.find_first_not_of(" \t");
+        if (begin == std::string::npos)
+        {
+            return "";
+        }
+        size_t end = s.find_last_not_of(" \t");
+        return s.substr(begin, end - begin + 1);
+    }
+
+    std::string toLower(std::string s)
+    {
+        for (char &c : s)
+        {
+            if (c >= 'A' && c <= 'Z')
+            {
+                c = static_cast<char>(c - 'A' + 'a');
+            }
+        }
+        return s;
+    }
+
+    // q-значение элемента Accept-Encoding ("gzip;q=0.5" -> 0.5, без параметра - 1)
+    double parseQuality(const std::string &params)
+    {
+        size_t pos = params.find("q=");
+        if (pos == std::string::npos)
+        {
+            return 1.0;
+        }
+        return std::strtod(params.c_str() + pos + 2, nullptr);
+    }
+}
+
+ContentCoding negotiateContentCoding(const std::string &accept_encoding)
+{
+    double gzip_q = -1.0;
+    double deflate_q = -1.0;
+    double wildcard_q = -1.0;
+
+    size_t pos = 0;
+    while (pos < accept_encoding.size())
+    {
+        size_t comma = accept_encoding.find(',', pos);
+        std::string item = accept_encoding.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos);
+        pos = comma == std::string::npos ? accept_encoding.size() : comma + 1;
+
+        size_t semicolon = item.find(';');
+        std::string coding = toLower(trim(item.substr(0, semicolon)));
+        double q = semicolon == std::string::npos ? 1.0 : parseQuality(item.substr(semicolon + 1));
+
+        if (coding == "gzip" || coding == "x-gzip")
+        {
+            gzip_q = q;
+        }
+        else if (coding == "deflate")
+        {
+            deflate_q = q;
+        }
+        else if (coding == "*")
+        {
+            wildcard_q = q;
+        }
+    }
+
+    // "*" распространяется на кодирования, не названные явно
+    if (gzip_q < 0)
+    {
+        gzip_q = wildcard_q;
+    }
+    if (deflate_q < 0)
+    {
+        deflate_q = wildcard_q;
+    }
+
+    if (gzip_q > 0 && gzip_q >= deflate_q)
+    {
+        return ContentCoding::Gzip;
+    }
+    if (deflate_q > 0)
+    {
+        return ContentCoding::Deflate;
+    }
+    return ContentCoding::Identity;
+}
+
+const char *contentCodingName(ContentCoding coding)
+{
+    switch (coding)
+    {
+    case ContentCoding::Gzip:
+        return "gzip";
+    case ContentCoding::Deflate:
+        return "deflate";
+    default:
+        return "";
+    }
+}
+
+std::string compressBody(const std::string &body, ContentCoding coding)
+{
+    if (coding == ContentCoding::Identity)
+    {
+        return body;
+    }
+
+    z_stream strm{};
+    // windowBits 15 - zlib-заголовок (deflate), +16 - gzip-обёртка
+    const int window_bits = coding == ContentCoding::Gzip ? 15 + 16 : 15;
+    if (deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+        return "";
+    }
+
+    std::string out;
+    out.resize(deflateBound(&strm, static_cast<uLong>(body.size())));
+    strm.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(body.data()));
+    strm.avail_in = static_cast<uInt>(body.size());
+    strm.next_out = reinterpret_cast<Bytef *>(&out[0]);
+    strm.avail_out = static_cast<uInt>(out.size());
+
+    // Буфер размером deflateBound гарантирует завершение за один вызов
+    int ret = deflate(&strm, Z_FINISH);
+    size_t written = strm.total_out;
+    deflateEnd(&strm);
+    if (ret != Z_STREAM_END)
+    {
+        return "";
+    }
+    out.resize(written);
+    return out;
+}
+
+struct StreamCompressor::State
+{
+    z_stream strm{};
+};
+
+StreamCompressor::StreamCompressor(ContentCoding coding)
+{
+    if (coding == ContentCoding::Identity)
+    {
+        return;
+    }
+    auto state = std::make_unique<State>();
+    const int window_bits = coding == ContentCoding::Gzip ? 15 + 16 : 15;
+    if (deflateInit2(&state->strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY) == Z_OK)
+    {
+        state_ = std::move(state);
+    }
+}
+
+StreamCompressor::~StreamCompressor()
+{
+    if (state_)
+    {
+        deflateEnd(&state_->strm);
+    }
+}
+
+bool StreamCompressor::compress(const char *data, size_t size, bool last, std::string &out)
+{
+    if (!state_)
+    {
+        return false;
+    }
+    z_stream &strm = state_->strm;
+    strm.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+    strm.avail_in = static_cast<uInt>(size);
+    const int flush = last ? Z_FINISH : Z_SYNC_FLUSH;
+
+    char buf[16384];
+    int ret = Z_OK;
+    do
+    {
+        strm.next_out = reinterpret_cast<Bytef *>(buf);
+        strm.avail_out = sizeof(buf);
+        ret = deflate(&strm, flush);
+        if (ret == Z_STREAM_ERROR)
+        {
+            return false;
+        }
+        out.append(buf, sizeof(buf) - strm.avail_out);
+    } while (strm.avail_out == 0);
+
+    return !last || ret == Z_STREAM_END;
+}
+
+bool isCompressibleContentType(const std::string &content_type)
+{
+    const std::string type = toLower(trim(content_type.substr(0, content_type.find(';'))));
+    if (type == "text/event-stream")
+    {
+        return false;
+    }
+    return type.rfind("text/", 0) == 0 || type == "application/json" || type == "application/javascript" ||
+           type == "application/xml" || type == "image/svg+xml" || type == "application/manifest+json";
+}
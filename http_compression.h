@@ -0,0 +1,45 @@
+#pragma once
+#include <memory>
+#include <string>
+
+// Кодирование тела ответа, выбранное по Accept-Encoding
+enum class ContentCoding
+{
+    Identity,
+    Gzip,
+    Deflate
+};
+
+// Выбирает кодирование с наибольшим q (gzip предпочтительнее deflate при равенстве).
+// Учитывает q=0 и "*"; пустой или отсутствующий заголовок - Identity.
+ContentCoding negotiateContentCoding(const std::string &accept_encoding);
+
+// Значение для заголовка Content-Encoding ("gzip", "deflate"; "" для Identity)
+const char *contentCodingName(ContentCoding coding);
+
+// Сжимает тело через zlib (gzip - RFC 1952, deflate - zlib-поток RFC 1950).
+// При ошибке возвращает пустую строку; для Identity - копию тела.
+std::string compressBody(const std::string &body, ContentCoding coding);
+
+// Типы, которые имеет смысл сжимать (JSON, текст, JS, SVG); SSE не сжимается
+bool isCompressibleContentType(const std::string &content_type);
+
+/**
+ * StreamCompressor - сжатие chunked-ответа по порциям. После каждой порции делается
+ * Z_SYNC_FLUSH, чтобы клиент мог разбирать данные, не дожидаясь конца потока.
+ */
+class StreamCompressor
+{
+public:
+    explicit StreamCompressor(ContentCoding coding);
+    ~StreamCompressor();
+
+    bool valid() const { return state_ != nullptr; }
+
+    // Дописывает сжатую порцию в out; last завершает поток
+    bool compress(const char *data, size_t size, bool last, std::string &out);
+
+private:
+    struct State;
+    std::unique_ptr<State> state_;
+};
@@ -6,9 +6,24 @@
 #include "trade_points.h"
 #include "user_data_types.h"
 #include "application_status.h"
+#include "metrics.h"
+#include "tracing.h"
+#include "response_cache.h"
+#include "http_compression.h"
+#include "json_writer.h"
+#include "event_bus.h"
+#include "static_assets.h"
+#include "rate_limiter.h"
+#include "init_data_verifier.h"
+#include "session_manager.h"
 
 #include <tgbot/tgbot.h>
 #include <nlohmann/json.hpp>
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
 
 // cpp-httplib is header-only
 #define CPPHTTPLIB_OPENSSL_SUPPORT
@@ -16,10 +31,163 @@
 
 using json = nlohmann::json;
 
+// ========== ПУЛ СОЕДИНЕНИЙ ==========
+
+namespace
+{
+    // Поток-отбойник: соединение принято сверх очереди, маршруты отвечают 503 без обработчика
+    thread_local bool t_shedding = false;
+
+    /**
+     * BoundedTaskQueue - пул потоков httplib с ограниченной очередью соединений.
+     * Когда в очереди max_queued соединений, новые отдаются отдельному потоку, который
+     * сразу отвечает 503 вместо того, чтобы держать клиента до освобождения воркера.
+     * Если переполнена и очередь отбойника, соединение закрывается без ответа.
+     */
+    class BoundedTaskQueue : public httplib::TaskQueue
+    {
+    public:
+        static constexpr size_t kMaxShedQueue = 64;
+
+        BoundedTaskQueue(size_t threads, size_t max_queued)
+            : max_queued_(max_queued),
+              active_(MetricsRegistry::instance().gauge("bot_http_active_connections", "HTTP connections being served by worker threads")),
+              depth_(MetricsRegistry::instance().gauge("bot_http_queue_depth", "HTTP connections waiting for a worker thread")),
+              wait_(MetricsRegistry::instance().histogram("bot_http_queue_wait_seconds", "Time an HTTP connection waited for a worker thread")),
+              shed_(MetricsRegistry::instance().counter("bot_http_shed_total", "HTTP connections answered with 503 because the queue was full")),
+              dropped_(MetricsRegistry::instance().counter("bot_http_dropped_total", "HTTP connections closed without a response under overload"))
+        {
+            workers_.reserve(threads);
+            for (size_t i = 0; i < threads; ++i)
+            {
+                workers_.emplace_back([this]()
+                                      { workerLoop(); });
+            }
+            shedder_ = std::thread([this]()
+                                   { shedLoop(); });
+        }
+
+        bool enqueue(std::function<void()> fn) override
+        {
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                if (queue_.size() < max_queued_)
+                {
+                    queue_.push_back({std::move(fn), std::chrono::steady_clock::now()});
+                    depth_.set(static_cast<int64_t>(queue_.size()));
+                    cv_.notify_one();
+                    return true;
+                }
+                if (shed_queue_.size() < kMaxShedQueue)
+                {
+                    shed_queue_.push_back(std::move(fn));
+                    shed_.inc();
+                    shed_cv_.notify_one();
+                    return true;
+                }
+            }
+            dropped_.inc();
+            return false;
+        }
+
+        void shutdown() override
+        {
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                shutdown_ = true;
+            }
+            cv_.notify_all();
+            shed_cv_.notify_all();
+            for (auto &t : workers_)
+            {
+                t.join();
+            }
+            shedder_.join();
+        }
+
+    private:
+        struct Task
+        {
+            std::function<void()> fn;
+            std::chrono::steady_clock::time_point enqueued;
+        };
+
+        void workerLoop()
+        {
+            for (;;)
+            {
+                Task task;
+                {
+                    std::unique_lock<std::mutex> lock(mtx_);
+                    cv_.wait(lock, [this]()
+                             { return shutdown_ || !queue_.empty(); });
+                    if (queue_.empty())
+                    {
+                        break; // shutdown, очередь разобрана
+                    }
+                    task = std::move(queue_.front());
+                    queue_.pop_front();
+                    depth_.set(static_cast<int64_t>(queue_.size()));
+                }
+                wait_.observe(std::chrono::steady_clock::now() - task.enqueued);
+                active_.add(1);
+                task.fn();
+                active_.add(-1);
+            }
+        }
+
+        void shedLoop()
+        {
+            t_shedding = true;
+            for (;;)
+            {
+                std::function<void()> fn;
+                {
+                    std::unique_lock<std::mutex> lock(mtx_);
+                    shed_cv_.wait(lock, [this]()
+                                  { return shutdown_ || !shed_queue_.empty(); });
+                    if (shed_queue_.empty())
+                    {
+                        break;
+                    }
+                    fn = std::move(shed_queue_.front());
+                    shed_queue_.pop_front();
+                }
+                fn();
+            }
+        }
+
+        const size_t max_queued_;
+        std::mutex mtx_;
+        std::condition_variable cv_;
+        std::condition_variable shed_cv_;
+        std::deque<Task> queue_;
+        std::deque<std::function<void()>> shed_queue_;
+        std::vector<std::thread> workers_;
+        std::thread shedder_;
+        bool shutdown_ = false;
+
+        Gauge &active_;
+        Gauge &depth_;
+        Histogram &wait_;
+        Counter &shed_;
+        Counter &dropped_;
+    };
+}
+
 // Global server instance
 static HttpServer *g_http_server = nullptr;
 static httplib::Server *g_svr = nullptr;
 
+static void compressResponse(const httplib::Request &req, httplib::Response &res);
+// Файлы webapp/ (загружаются в serverLoop, если включён static_files)
+static StaticAssets g_static_assets;
+static void setupStaticRoutes();
+static bool admitRequest(const httplib::Request &req, httplib::Response &res);
+static std::unique_ptr<RateLimiter> g_rate_limiter;
+static bool authenticateRequest(const httplib::Request &req, httplib::Response &res);
+static std::unique_ptr<InitDataVerifier> g_init_data_verifier;
+
 HttpServer *getHttpServer()
 {
     return g_http_server;
@@ -33,7 +201,7 @@ void initHttpServer(TgBot::Bot &bot)
     }
 }
 
-HttpServer::HttpServer(TgBot::Bot &bot) : bot_(bot), port_(8080)
+HttpServer::HttpServer(TgBot::Bot &bot) : bot_(bot), port_(config.http_port)
 {
     g_http_server = this;
 }
@@ -57,6 +225,8 @@ void HttpServer::stop()
     if (running_ && g_svr)
     {
         running_ = false;
+        // SSE-подписчики ждут событий на шине; будим их, чтобы потоки пула завершились
+        EventBus::instance().shutdown();
         g_svr->stop();
         if (server_thread_.joinable())
         {
@@ -79,13 +249,55 @@ void HttpServer::start(int port)
     server_thread_ = std::thread([this]()
                                  { serverLoop(); });
 
-    LOG(LogLevel::INFO, "HTTP API server started on port " + std::to_string(port_));
+    LOG(LogLevel::INFO, "HTTP API server started on port " << port_ << " (" << config.http_threads << " threads, queue "
+                                                           << config.http_max_queued << ")");
 }
 
 void HttpServer::serverLoop()
 {
     g_svr = new httplib::Server();
 
+    // Пул потоков, keep-alive, таймауты и лимит тела - из секции http_server конфигурации
+    const size_t threads = config.http_threads;
+    const size_t max_queued = config.http_max_queued;
+    g_svr->new_task_queue = [threads, max_queued]()
+    { return new BoundedTaskQueue(threads, max_queued); };
+    g_svr->set_keep_alive_timeout(config.http_keep_alive_timeout_sec);
+    g_svr->set_keep_alive_max_count(config.http_keep_alive_max_count);
+    g_svr->set_read_timeout(config.http_read_timeout_sec);
+    g_svr->set_write_timeout(config.http_write_timeout_sec);
+    g_svr->set_payload_max_length(config.http_payload_max_bytes);
+    // SSE держит поток на всё время подключения: оставляем хотя бы половину пула для API
+    EventBus::instance().setMaxSubscribers(std::min(config.http_max_event_subscribers, threads / 2));
+
+    // Вызывается до чтения тела и вызова обработчика: соединения сверх очереди (503) и клиенты
+    // сверх лимита (429) отсекаются сразу, затем проверяется авторизация
+    g_svr->set_pre_routing_handler([](const httplib::Request &req, httplib::Response &res)
+                                   {
+                                       if (t_shedding)
+                                       {
+                                           res.status = 503;
+                                           res.set_header("Retry-After", "1");
+                                           res.set_content("{\"error\":\"Server is overloaded\"}", "application/json");
+                                           return httplib::Server::HandlerResponse::Handled;
+                                       }
+                                       return admitRequest(req, res) && authenticateRequest(req, res)
+                                                  ? httplib::Server::HandlerResponse::Unhandled
+                                                  : httplib::Server::HandlerResponse::Handled;
+                                   });
+
+    if (config.rate_limit_enabled && !g_rate_limiter)
+    {
+        g_rate_limiter = std::make_unique<RateLimiter>(config.rate_limit_rate, config.rate_limit_burst);
+        MetricsRegistry::instance().gaugeCallback("bot_http_rate_limit_clients", "Clients tracked by the HTTP rate limiter", []()
+                                                  { return static_cast<double>(g_rate_limiter->bucketCount()); });
+    }
+
+    if (config.webapp_auth_required && !g_init_data_verifier)
+    {
+        g_init_data_verifier = std::make_unique<InitDataVerifier>(config.bot_token, config.webapp_auth_max_age_sec);
+    }
+
     // Enable CORS for all origins (for development)
     g_svr->set_default_headers({{"Access-Control-Allow-Origin", "*"},
                                 {"Access-Control-Allow-Methods", "GET, POST, PUT, PATCH, DELETE, OPTIONS"},
@@ -100,7 +312,30 @@ void HttpServer::serverLoop()
                        res.status = 204;
                    });
 
+    // Route latency is recorded once the response has been written
+    g_svr->set_logger([](const httplib::Request &req, const httplib::Response &res)
+                      {
+                          const std::string route = req.matched_route.empty() ? "unmatched" : req.matched_route;
+                          const auto now = std::chrono::steady_clock::now();
+                          auto &registry = MetricsRegistry::instance();
+                          registry.histogram("bot_http_request_duration_seconds", "HTTP API request latency by route",
+                                             {{"method", req.method}, {"route", route}})
+                              .observe(now - req.start_time_);
+                          Tracer::instance().record("http", req.method + " " + route, req.start_time_, now);
+                          registry.counter("bot_http_requests_total", "HTTP API requests by route and status",
+                                           {{"method", req.method}, {"route", route}, {"status", std::to_string(res.status)}})
+                              .inc();
+                      });
+
+    // Сжатие по Accept-Encoding для тел не меньше http_compression.min_size
+    g_svr->set_post_routing_handler(compressResponse);
+
     setupRoutes();
+    // Файлы читаются один раз; маршруты регистрируются на каждом новом экземпляре сервера
+    if (config.static_files_enabled && (g_static_assets.size() > 0 || g_static_assets.load(config.static_files_root)))
+    {
+        setupStaticRoutes();
+    }
 
     g_svr->listen("0.0.0.0", port_);
 
@@ -108,6 +343,516 @@ void HttpServer::serverLoop()
     g_svr = nullptr;
 }
 
+// ========== ОГРАНИЧЕНИЕ ЧАСТОТЫ ==========
+
+// Стоимость запроса в токенах: полные списки и пакетные операции нагружают общее
+// соединение SQLite сильнее, служебные маршруты не ограничиваются.
+// rate_limit.costs из конфигурации переопределяет значения по точному пути.
+static double requestCost(const httplib::Request &req, std::string &route)
+{
+    static const std::map<std::string, double> kDefaultCosts = {
+        {"/api/health", 0},
+        {"/metrics", 0},
+        {"/api/applications", 10},
+        {"/api/admins", 5},
+        {"/api/stats", 10},
+        {"/api/events", 5},
+        {"/api/broadcast", 20},
+        {"/api/applications/status:batch", 20},
+        {"/api/admins:batch", 20},
+    };
+    route = req.path;
+    auto custom = config.rate_limit_costs.find(req.path);
+    if (custom != config.rate_limit_costs.end())
+    {
+        return custom->second;
+    }
+    auto builtin = kDefaultCosts.find(req.path);
+    if (builtin != kDefaultCosts.end())
+    {
+        return builtin->second;
+    }
+    route = "other"; // произвольные пути не раздувают метки метрики
+    return 1;
+}
+
+// Ключ ведра - только IP клиента: заголовки авторизации на этом этапе ещё не проверены,
+// и их смена давала бы клиенту новое ведро
+static std::string clientKey(const httplib::Request &req)
+{
+    std::string ip = req.remote_addr;
+    if (config.rate_limit_trust_forwarded_for && req.has_header("X-Forwarded-For"))
+    {
+        const std::string forwarded = req.get_header_value("X-Forwarded-For");
+        ip = forwarded.substr(0, forwarded.find(','));
+        ip.erase(0, ip.find_first_not_of(' '));
+        ip.erase(ip.find_last_not_of(' ') + 1);
+    }
+    return ip;
+}
+
+// false - лимит клиента исчерпан, res уже содержит 429
+static bool admitRequest(const httplib::Request &req, httplib::Response &res)
+{
+    if (!g_rate_limiter || req.method == "OPTIONS")
+    {
+        return true;
+    }
+    std::string route;
+    const double cost = requestCost(req, route);
+    RateLimiter::Decision decision = g_rate_limiter->acquire(clientKey(req), cost);
+    if (decision.allowed)
+    {
+        return true;
+    }
+
+    MetricsRegistry::instance()
+        .counter("bot_http_rate_limited_total", "HTTP requests rejected with 429 by the per-client rate limiter", {{"route", route}})
+        .inc();
+    res.status = 429;
+    res.set_header("Retry-After", std::to_string(decision.retry_after_sec));
+    res.set_content("{\"error\":\"Too many requests\"}", "application/json");
+    return false;
+}
+
+// ========== АУТЕНТИФИКАЦИЯ ==========
+
+// При webapp_auth.required маршруты /api/* (кроме /api/health) принимают только запросы
+// из админ-панели, открытой в Telegram главным админом: "Authorization: tma <initData>"
+// или ?initData=... (EventSource не передаёт заголовки). false - res уже содержит 401/403.
+static bool authenticateRequest(const httplib::Request &req, httplib::Response &res)
+{
+    if (!g_init_data_verifier || req.method == "OPTIONS" || req.path.rfind("/api/", 0) != 0 || req.path == "/api/health")
+    {
+        return true;
+    }
+
+    static Counter &rejected = MetricsRegistry::instance().counter("bot_http_auth_rejected_total", "HTTP API requests rejected by WebApp initData verification");
+    static const char kScheme[] = "tma ";
+    const std::string authorization = req.get_header_value("Authorization");
+    InitDataAuth auth;
+    if (authorization.compare(0, sizeof(kScheme) - 1, kScheme) == 0)
+    {
+        auth = g_init_data_verifier->verify(authorization.data() + sizeof(kScheme) - 1,
+                                            authorization.size() - (sizeof(kScheme) - 1), time(nullptr));
+    }
+    else
+    {
+        auth = g_init_data_verifier->verify(req.get_param_value("initData"), time(nullptr));
+    }
+
+    if (!auth.valid)
+    {
+        rejected.inc();
+        res.status = 401;
+        json response = {{"error", auth.error}};
+        res.set_content(response.dump(), "application/json");
+        return false;
+    }
+    if (auth.user_id != config.main_admin_id)
+    {
+        rejected.inc();
+        LOG(LogLevel::L_WARNING, "API: initData of user " << auth.user_id << " rejected for " << req.path);
+        res.status = 403;
+        res.set_content("{\"error\":\"Forbidden\"}", "application/json");
+        return false;
+    }
+    return true;
+}
+
+// ========== КЕШИРУЕМЫЕ ОТВЕТЫ ==========
+
+// Каталоги сериализуются без промежуточного json-дерева (см. writeJson в json_writer.h)
+template <typename Items, typename WriteFn>
+static std::string buildJsonArray(const Items &items, WriteFn write)
+{
+    std::string out;
+    JsonWriter w(out);
+    w.beginArray();
+    for (const auto &item : items)
+    {
+        write(w, item);
+    }
+    w.endArray();
+    return out;
+}
+
+static std::string buildTradePointsJson()
+{
+    return buildJsonArray(get_all_trade_points(), [](JsonWriter &w, const TradePoint &point)
+                          { writeJson(w, point); });
+}
+
+static std::string buildTariffsJson()
+{
+    return buildJsonArray(get_tariff_catalog()->plans, [](JsonWriter &w, const TariffPlan &tariff)
+                          { writeJson(w, tariff); });
+}
+
+// webapp/data/*.json в формате каталогов из json-cfg, который читает webapp/js/app.js
+static std::string buildWebappTradePointsJson()
+{
+    return buildJsonArray(get_all_trade_points(), [](JsonWriter &w, const TradePoint &point)
+                          { writeCatalogJson(w, point); });
+}
+
+static std::string buildWebappTariffsJson()
+{
+    return buildJsonArray(get_tariff_catalog()->plans, [](JsonWriter &w, const TariffPlan &tariff)
+                          { writeCatalogJson(w, tariff); });
+}
+
+// Кодирование для тела размера body_size: сжимаем только если включено и тело не меньше порога
+static ContentCoding chooseCoding(const httplib::Request &req, size_t body_size)
+{
+    if (!config.http_compression || body_size < config.http_compression_min_size)
+    {
+        return ContentCoding::Identity;
+    }
+    return negotiateContentCoding(req.get_header_value("Accept-Encoding"));
+}
+
+// У каждого представления свой сильный ETag: "<fnv64>-<size>" -> "<fnv64>-<size>-gzip"
+static std::string variantEtag(const std::string &etag, ContentCoding coding)
+{
+    if (coding == ContentCoding::Identity || etag.size() < 2)
+    {
+        return etag;
+    }
+    return etag.substr(0, etag.size() - 1) + "-" + contentCodingName(coding) + "\"";
+}
+
+static void countCompressed(ContentCoding coding, size_t original_size, size_t compressed_size)
+{
+    auto &registry = MetricsRegistry::instance();
+    registry.counter("bot_http_compressed_responses_total", "HTTP API responses sent with Content-Encoding",
+                     {{"encoding", contentCodingName(coding)}})
+        .inc();
+    if (original_size > compressed_size)
+    {
+        registry.counter("bot_http_compression_saved_bytes_total", "Response bytes saved by HTTP compression")
+            .inc(original_size - compressed_size);
+    }
+}
+
+// Отдаёт закешированный ответ: 304 при совпадении валидаторов, иначе тело (или его
+// заранее сжатый вариант) из общего буфера
+static void serveCached(const httplib::Request &req, httplib::Response &res, const std::string &key)
+{
+    std::shared_ptr<const CachedResponse> cached = ResponseCache::instance().get(key);
+    if (!cached)
+    {
+        res.status = 404;
+        return;
+    }
+
+    ContentCoding coding = chooseCoding(req, cached->body.size());
+    const std::string &body = cached->bodyFor(coding);
+    if (&body == &cached->body)
+    {
+        coding = ContentCoding::Identity;
+    }
+    const std::string etag = variantEtag(cached->etag, coding);
+
+    res.set_header("ETag", etag);
+    res.set_header("Last-Modified", cached->last_modified);
+    res.set_header("Cache-Control", "no-cache");
+    if (config.http_compression && cached->body.size() >= config.http_compression_min_size)
+    {
+        res.set_header("Vary", "Accept-Encoding");
+    }
+
+    // If-None-Match имеет приоритет над If-Modified-Since (RFC 9110, 13.2.2)
+    bool not_modified = req.has_header("If-None-Match")
+                            ? ResponseCache::etagMatches(req.get_header_value("If-None-Match"), etag)
+                            : req.get_header_value("If-Modified-Since") == cached->last_modified;
+    if (not_modified)
+    {
+        res.status = 304;
+        return;
+    }
+
+    if (coding != ContentCoding::Identity)
+    {
+        res.set_header("Content-Encoding", contentCodingName(coding));
+        countCompressed(coding, cached->body.size(), body.size());
+    }
+
+    // Провайдер пишет прямо из закешированной строки; shared_ptr держит её до конца ответа
+    const std::string *data = &body;
+    res.set_content_provider(body.size(), cached->content_type,
+                             [cached, data](size_t offset, size_t length, httplib::DataSink &sink)
+                             {
+                                 return sink.write(data->data() + offset, length);
+                             });
+}
+
+// Сжимает обычные ответы (res.body) после обработчика маршрута. Потоковые ответы
+// и закешированные маршруты выбирают кодирование сами.
+static void compressResponse(const httplib::Request &req, httplib::Response &res)
+{
+    if (res.status != 200 || res.body.empty() || res.has_header("Content-Encoding") ||
+        res.has_header("Content-Range") || !isCompressibleContentType(res.get_header_value("Content-Type")))
+    {
+        return;
+    }
+
+    ContentCoding coding = chooseCoding(req, res.body.size());
+    if (config.http_compression && res.body.size() >= config.http_compression_min_size)
+    {
+        res.set_header("Vary", "Accept-Encoding");
+    }
+    if (coding == ContentCoding::Identity)
+    {
+        return;
+    }
+
+    std::string compressed = compressBody(res.body, coding);
+    if (compressed.empty() || compressed.size() >= res.body.size())
+    {
+        return;
+    }
+
+    countCompressed(coding, res.body.size(), compressed.size());
+    res.body.swap(compressed);
+    // Content-Length уже выставлен httplib по несжатому телу
+    res.headers.erase("Content-Length");
+    res.set_header("Content-Length", std::to_string(res.body.size()));
+    res.set_header("Content-Encoding", contentCodingName(coding));
+}
+
+// ========== СТАТИЧЕСКИЕ ФАЙЛЫ ==========
+
+// Отдаёт файл webapp/ из памяти. HTML всегда перепроверяется по ETag; ресурс, запрошенный
+// с ?v=<hash> своего текущего содержимого, кешируется навсегда (URL меняется вместе с файлом).
+static void serveStaticAsset(const httplib::Request &req, httplib::Response &res, const std::string &path)
+{
+    std::shared_ptr<const StaticAsset> asset = g_static_assets.find(path);
+    if (!asset)
+    {
+        res.status = 404;
+        return;
+    }
+
+    ContentCoding coding = ContentCoding::Identity;
+    if (!asset->gzip_body.empty())
+    {
+        res.set_header("Vary", "Accept-Encoding");
+        if (config.http_compression && negotiateContentCoding(req.get_header_value("Accept-Encoding")) == ContentCoding::Gzip)
+        {
+            coding = ContentCoding::Gzip;
+        }
+    }
+    const std::string etag = variantEtag(asset->etag, coding);
+
+    res.set_header("ETag", etag);
+    if (asset->content_type.rfind("text/html", 0) == 0)
+    {
+        res.set_header("Cache-Control", "no-cache");
+    }
+    else if (req.get_param_value("v") == asset->hash)
+    {
+        res.set_header("Cache-Control", "public, max-age=31536000, immutable");
+    }
+    else
+    {
+        res.set_header("Cache-Control", "public, max-age=" + std::to_string(config.static_files_max_age_sec));
+    }
+
+    if (ResponseCache::etagMatches(req.get_header_value("If-None-Match"), etag))
+    {
+        res.status = 304;
+        return;
+    }
+
+    const std::string *data = &asset->body;
+    if (coding == ContentCoding::Gzip)
+    {
+        data = &asset->gzip_body;
+        res.set_header("Content-Encoding", "gzip");
+        countCompressed(coding, asset->body.size(), data->size());
+    }
+    res.set_content_provider(data->size(), asset->content_type,
+                             [asset, data](size_t offset, size_t length, httplib::DataSink &sink)
+                             {
+                                 return sink.write(data->data() + offset, length);
+                             });
+}
+
+// Маршрут <mount>/...: "" -> редирект на "<mount>/" (иначе относительные ссылки ломаются),
+// каталог -> index.html, data/*.json каталогов -> живые данные через ResponseCache
+static void setupStaticRoutes()
+{
+    const std::string mount = config.static_files_mount == "/" ? "" : config.static_files_mount;
+    ResponseCache::instance().registerEntry("webapp:data/trade_points.json", get_trade_points_version, buildWebappTradePointsJson);
+    ResponseCache::instance().registerEntry("webapp:data/tariffs.json", get_tariff_catalog_version, buildWebappTariffsJson);
+
+    g_svr->Get(mount + "(/.*)?", [mount](const httplib::Request &req, httplib::Response &res)
+               {
+                   std::string path = req.matches[1];
+                   if (path.empty())
+                   {
+                       res.set_redirect(mount + "/", 301);
+                       return;
+                   }
+                   path.erase(0, 1);
+                   if (path.empty() || path.back() == '/')
+                   {
+                       path += "index.html";
+                   }
+                   if (path == "data/trade_points.json" || path == "data/tariffs.json")
+                   {
+                       serveCached(req, res, "webapp:" + path);
+                       return;
+                   }
+                   serveStaticAsset(req, res, path);
+               });
+}
+
+// ========== ПОТОКОВЫЕ ОТВЕТЫ ==========
+
+// Строк в одной странице потокового списка: одна страница - один chunk
+static constexpr size_t kStreamPageRows = 256;
+
+// Потоковый JSON-ответ: produce дописывает в буфер следующую порцию и возвращает false,
+// когда данные закончились. Порции сжимаются по Accept-Encoding и уходят chunked,
+// так что память не зависит от числа строк, а заголовки уходят до первого запроса к БД.
+static void streamJson(const httplib::Request &req, httplib::Response &res, std::function<bool(std::string &)> produce)
+{
+    ContentCoding coding = config.http_compression ? negotiateContentCoding(req.get_header_value("Accept-Encoding"))
+                                                   : ContentCoding::Identity;
+    std::shared_ptr<StreamCompressor> compressor;
+    if (coding != ContentCoding::Identity)
+    {
+        compressor = std::make_shared<StreamCompressor>(coding);
+        if (compressor->valid())
+        {
+            res.set_header("Content-Encoding", contentCodingName(coding));
+        }
+        else
+        {
+            compressor.reset();
+        }
+    }
+    if (config.http_compression)
+    {
+        res.set_header("Vary", "Accept-Encoding");
+    }
+
+    auto buffer = std::make_shared<std::string>();
+    auto encoded = std::make_shared<std::string>();
+    res.set_chunked_content_provider("application/json",
+                                     [produce, compressor, buffer, encoded](size_t, httplib::DataSink &sink)
+                                     {
+                                         buffer->clear();
+                                         const bool more = produce(*buffer);
+                                         const std::string *out = buffer.get();
+                                         if (compressor)
+                                         {
+                                             encoded->clear();
+                                             if (!compressor->compress(buffer->data(), buffer->size(), !more, *encoded))
+                                             {
+                                                 return false;
+                                             }
+                                             out = encoded.get();
+                                         }
+                                         if (!out->empty() && !sink.write(out->data(), out->size()))
+                                         {
+                                             return false;
+                                         }
+                                         if (!more)
+                                         {
+                                             sink.done();
+                                         }
+                                         return true;
+                                     });
+}
+
+// Статус заявки из строки API ("Новая", "В работе", "Выполнена", "Отменена")
+static bool parseApplicationStatus(const std::string &status, ApplicationStatus &out)
+{
+    if (status == "Новая")
+        out = ApplicationStatus::New;
+    else if (status == "В работе")
+        out = ApplicationStatus::InProgress;
+    else if (status == "Выполнена")
+        out = ApplicationStatus::Done;
+    else if (status == "Отменена")
+        out = ApplicationStatus::Cancelled;
+    else
+        return false;
+    return true;
+}
+
+// Разбор тела пакетного запроса {"items": [...]}: false и готовый ответ об ошибке,
+// если тело некорректно или элементов больше http_server.max_batch_items
+static bool parseBatchItems(const httplib::Request &req, httplib::Response &res, json &items)
+{
+    json body = json::parse(req.body, nullptr, false);
+    if (body.is_discarded() || !body.is_object() || !body.contains("items") || !body["items"].is_array())
+    {
+        res.status = 400;
+        json response = {{"error", "Expected {\"items\": [...]}"}};
+        res.set_content(response.dump(), "application/json");
+        return false;
+    }
+    items = body["items"];
+    if (items.empty() || items.size() > config.http_max_batch_items)
+    {
+        res.status = items.empty() ? 400 : 413;
+        json response = {{"error", "Batch must contain 1.." + std::to_string(config.http_max_batch_items) + " items"}};
+        res.set_content(response.dump(), "application/json");
+        return false;
+    }
+    return true;
+}
+
+// Строковое поле элемента пакета; "" - поля нет или оно не строка (json::value бросил бы type_error)
+static std::string batchStringField(const json &item, const char *key)
+{
+    auto it = item.find(key);
+    return it != item.end() && it->is_string() ? it->get<std::string>() : std::string();
+}
+
+// Ответ пакетного маршрута: результат на каждый элемент в порядке запроса
+static void sendBatchResults(httplib::Response &res, const std::vector<BatchItemResult> &results,
+                             const std::vector<int64_t> &ids, const char *id_field)
+{
+    std::string out;
+    JsonWriter w(out);
+    size_t succeeded = 0;
+    w.beginObject();
+    w.key("results");
+    w.beginArray();
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        w.beginObject();
+        w.field("index", i);
+        w.field(id_field, ids[i]);
+        w.field("success", results[i].success);
+        if (!results[i].success)
+        {
+            w.field("error", results[i].error);
+        }
+        w.endObject();
+        succeeded += results[i].success;
+    }
+    w.endArray();
+    w.field("succeeded", succeeded);
+    w.field("failed", results.size() - succeeded);
+    w.endObject();
+    res.set_content(out, "application/json");
+}
+
+// Регистрирует GET-маршрут, ответ которого зависит только от версии источника данных
+static void cachedGet(const std::string &path, ResponseCache::VersionFn version, ResponseCache::BuildFn build,
+                      const std::string &content_type = "application/json")
+{
+    ResponseCache::instance().registerEntry(path, std::move(version), std::move(build), content_type);
+    g_svr->Get(path, [path](const httplib::Request &req, httplib::Response &res)
+               { serveCached(req, res, path); });
+}
+
 void HttpServer::setupRoutes()
 {
     // ========== HEALTH CHECK ==========
@@ -117,6 +862,91 @@ void HttpServer::setupRoutes()
                    res.set_content(response.dump(), "application/json");
                });
 
+    // ========== METRICS ==========
+    g_svr->Get("/metrics", [](const httplib::Request &, httplib::Response &res)
+               {
+                   res.set_content(MetricsRegistry::instance().renderPrometheus(), "text/plain; version=0.0.4; charset=utf-8");
+               });
+
+    // ========== TRACING ==========
+    g_svr->Post("/api/trace/start", [](const httplib::Request &, httplib::Response &res)
+                {
+                    Tracer::instance().start();
+                    LOG(LogLevel::INFO, "API: tracing started");
+                    json response = {{"success", true}, {"tracing", true}};
+                    res.set_content(response.dump(), "application/json");
+                });
+
+    g_svr->Post("/api/trace/stop", [](const httplib::Request &, httplib::Response &res)
+                {
+                    Tracer::instance().stop();
+                    LOG(LogLevel::INFO, "API: tracing stopped");
+                    json response = {{"success", true}, {"tracing", false}, {"events", Tracer::instance().eventCount()}};
+                    res.set_content(response.dump(), "application/json");
+                });
+
+    // Chrome trace-event JSON: открыть в chrome://tracing или ui.perfetto.dev
+    g_svr->Get("/api/trace", [](const httplib::Request &, httplib::Response &res)
+               {
+                   res.set_header("Content-Disposition", "attachment; filename=\"bot_trace.json\"");
+                   res.set_content(Tracer::instance().exportChromeJson(), "application/json");
+               });
+
+    // ========== LIVE EVENTS (SSE) ==========
+    // Дельты заявок и админов для админ-панели; при resync клиент перечитывает списки
+    g_svr->Get("/api/events", [](const httplib::Request &req, httplib::Response &res)
+               {
+                   auto sub = EventBus::instance().subscribe(req.get_header_value("Last-Event-ID"));
+                   if (!sub)
+                   {
+                       res.status = 503;
+                       res.set_header("Retry-After", "10");
+                       json response = {{"error", "Too many event subscribers"}};
+                       res.set_content(response.dump(), "application/json");
+                       return;
+                   }
+
+                   res.set_header("Cache-Control", "no-cache");
+                   res.set_header("X-Accel-Buffering", "no");
+                   auto first = std::make_shared<bool>(true);
+                   res.set_chunked_content_provider(
+                       "text/event-stream",
+                       [sub, first](size_t, httplib::DataSink &sink)
+                       {
+                           std::string out;
+                           if (*first)
+                           {
+                               *first = false;
+                               out = "retry: 3000\n\n";
+                           }
+
+                           std::vector<std::shared_ptr<const BusEvent>> events;
+                           bool resync = false;
+                           if (!EventBus::instance().wait(*sub, events, resync, std::chrono::seconds(15)))
+                           {
+                               sink.done();
+                               return true;
+                           }
+                           if (resync)
+                           {
+                               out += "event: resync\ndata: {}\n\n";
+                           }
+                           for (const auto &event : events)
+                           {
+                               out += "id: " + EventBus::instance().formatId(event->seq) + "\n";
+                               out += "event: " + event->type + "\n";
+                               out += "data: " + event->data + "\n\n";
+                           }
+                           if (out.empty())
+                           {
+                               out = ": ping\n\n"; // держит соединение через прокси
+                           }
+                           return sink.write(out.data(), out.size());
+                       },
+                       [sub](bool)
+                       { EventBus::instance().unsubscribe(sub); });
+               });
+
     // ========== BOT STATUS ==========
     g_svr->Get("/api/status", [](const httplib::Request &, httplib::Response &res)
                {
@@ -144,28 +974,41 @@ void HttpServer::setupRoutes()
                 });
 
     // ========== APPLICATIONS ==========
-    g_svr->Get("/api/applications", [](const httplib::Request &, httplib::Response &res)
+    // Список отдаётся страницами по kStreamPageRows строк (keyset по ID), без сборки вектора и json-дерева
+    g_svr->Get("/api/applications", [](const httplib::Request &req, httplib::Response &res)
                {
-                   LOG(LogLevel::INFO, "API: /api/applications called");
-                   auto applications = db_get_all_applications();
-                   LOG(LogLevel::INFO, "API: db_get_all_applications returned " << applications.size() << " items");
-                   json apps = json::array();
-
-                   for (const auto &app : applications)
+                   struct Cursor
                    {
-                       apps.push_back({{"id", app.id},
-                                       {"userId", app.user_id},
-                                       {"name", app.name},
-                                       {"phone", app.phone},
-                                       {"email", app.email},
-                                       {"tariff", app.tariff},
-                                       {"address", app.address},
-                                       {"status", app.chat_status},
-                                       {"date", app.timestamp},
-                                       {"price", app.price}});
-                   }
-
-                   res.set_content(apps.dump(), "application/json");
+                       int64_t before_id = INT64_MAX;
+                       bool first = true;
+                   };
+                   auto cursor = std::make_shared<Cursor>();
+                   streamJson(req, res, [cursor](std::string &buf)
+                              {
+                                  if (cursor->first)
+                                  {
+                                      buf += '[';
+                                  }
+                                  size_t rows = db_for_each_application(cursor->before_id, kStreamPageRows,
+                                                                        [&](const ApplicationDataForReport &app)
+                                                                        {
+                                                                            if (!cursor->first)
+                                                                            {
+                                                                                buf += ',';
+                                                                            }
+                                                                            cursor->first = false;
+                                                                            JsonWriter w(buf);
+                                                                            writeJson(w, app);
+                                                                            cursor->before_id = app.id;
+                                                                            return true;
+                                                                        });
+                                  if (rows < kStreamPageRows)
+                                  {
+                                      buf += ']';
+                                      return false;
+                                  }
+                                  return true;
+                              });
                });
 
     g_svr->Get(R"(/api/applications/(\d+))", [](const httplib::Request &req, httplib::Response &res)
@@ -177,19 +1020,10 @@ void HttpServer::setupRoutes()
 
                        if (app_opt)
                        {
-                           const auto &app = *app_opt;
-                           json response = {
-                               {"id", app.id},
-                               {"userId", app.user_id},
-                               {"name", app.name},
-                               {"phone", app.phone},
-                               {"email", app.email},
-                               {"tariff", app.tariff},
-                               {"address", app.address},
-                               {"status", app.chat_status},
-                               {"date", app.timestamp},
-                               {"price", app.price}};
-                           res.set_content(response.dump(), "application/json");
+                           std::string out;
+                           JsonWriter w(out);
+                           writeJson(w, *app_opt);
+                           res.set_content(out, "application/json");
                        }
                        else
                        {
@@ -215,15 +1049,7 @@ void HttpServer::setupRoutes()
                          std::string status = body.value("status", "");
 
                          ApplicationStatus app_status;
-                         if (status == "Новая")
-                             app_status = ApplicationStatus::New;
-                         else if (status == "В работе")
-                             app_status = ApplicationStatus::InProgress;
-                         else if (status == "Выполнена")
-                             app_status = ApplicationStatus::Done;
-                         else if (status == "Отменена")
-                             app_status = ApplicationStatus::Cancelled;
-                         else
+                         if (!parseApplicationStatus(status, app_status))
                          {
                              res.status = 400;
                              json response = {{"error", "Invalid status"}};
@@ -243,31 +1069,74 @@ void HttpServer::setupRoutes()
                      }
                  });
 
-    // ========== ADMINS ==========
-    g_svr->Get("/api/admins", [](const httplib::Request &, httplib::Response &res)
-               {
-                   auto admins = db_get_all_admins();
-                   auto pending = db_get_pending_admin_requests();
+    // Пакетная смена статусов: {"items": [{"id": 1, "status": "В работе"}, ...]}, одна транзакция
+    g_svr->Post("/api/applications/status:batch", [](const httplib::Request &req, httplib::Response &res)
+                {
+                    json items;
+                    if (!parseBatchItems(req, res, items))
+                    {
+                        return;
+                    }
 
-                   json admins_json = json::array();
-                   for (const auto &admin : admins)
-                   {
-                       admins_json.push_back({{"userId", admin.user_id},
-                                              {"name", admin.name},
-                                              {"tradePoint", admin.trade_point},
-                                              {"status", "active"}});
-                   }
+                    // Некорректные элементы получают ошибку сразу, остальные уходят в БД одним пакетом
+                    std::vector<BatchItemResult> results(items.size());
+                    std::vector<int64_t> ids(items.size(), 0);
+                    std::vector<ApplicationStatusUpdate> updates;
+                    std::vector<size_t> positions;
+                    for (size_t i = 0; i < items.size(); ++i)
+                    {
+                        const json &item = items.at(i);
+                        ApplicationStatus status;
+                        if (!item.is_object() || !item.contains("id") || !item["id"].is_number_integer())
+                        {
+                            results[i].error = "Missing id";
+                            continue;
+                        }
+                        ids[i] = item["id"].get<int64_t>();
+                        if (!parseApplicationStatus(batchStringField(item, "status"), status))
+                        {
+                            results[i].error = "Invalid status";
+                            continue;
+                        }
+                        updates.push_back({ids[i], status});
+                        positions.push_back(i);
+                    }
 
-                   json pending_json = json::array();
-                   for (const auto &req : pending)
-                   {
-                       pending_json.push_back({{"userId", req.user_id},
-                                               {"name", req.name},
-                                               {"tradePoint", req.trade_point}});
-                   }
+                    std::vector<BatchItemResult> db_results = db_batch_update_application_status(updates);
+                    for (size_t k = 0; k < positions.size(); ++k)
+                    {
+                        results[positions[k]] = std::move(db_results[k]);
+                    }
+                    sendBatchResults(res, results, ids, "id");
+                });
 
-                   json response = {{"admins", admins_json}, {"pending", pending_json}};
-                   res.set_content(response.dump(), "application/json");
+    // ========== ADMINS ==========
+    g_svr->Get("/api/admins", [](const httplib::Request &req, httplib::Response &res)
+               {
+                   // Таблица админов небольшая: обе выборки пишутся одной порцией прямо из курсора
+                   streamJson(req, res, [](std::string &buf)
+                              {
+                                  JsonWriter w(buf);
+                                  w.beginObject();
+                                  w.key("admins");
+                                  w.beginArray();
+                                  db_for_each_admin(true, [&](const AdminRequestData &admin)
+                                                    {
+                                                        writeJson(w, admin, true);
+                                                        return true;
+                                                    });
+                                  w.endArray();
+                                  w.key("pending");
+                                  w.beginArray();
+                                  db_for_each_admin(false, [&](const AdminRequestData &admin)
+                                                    {
+                                                        writeJson(w, admin, false);
+                                                        return true;
+                                                    });
+                                  w.endArray();
+                                  w.endObject();
+                                  return false;
+                              });
                });
 
     g_svr->Post("/api/admins", [](const httplib::Request &req, httplib::Response &res)
@@ -299,12 +1168,78 @@ void HttpServer::setupRoutes()
                     }
                 });
 
+    // Пакетные действия с админами: {"items": [{"action": "approve|decline|delete|add", "userId": 1,
+    // "name": "...", "tradePoint": "..."}, ...]}, одна транзакция
+    g_svr->Post("/api/admins:batch", [](const httplib::Request &req, httplib::Response &res)
+                {
+                    json items;
+                    if (!parseBatchItems(req, res, items))
+                    {
+                        return;
+                    }
+
+                    std::vector<BatchItemResult> results(items.size());
+                    std::vector<int64_t> ids(items.size(), 0);
+                    std::vector<AdminBatchItem> actions;
+                    std::vector<size_t> positions;
+                    for (size_t i = 0; i < items.size(); ++i)
+                    {
+                        const json &item = items.at(i);
+                        if (!item.is_object() || !item.contains("userId") || !item["userId"].is_number_integer())
+                        {
+                            results[i].error = "Missing userId";
+                            continue;
+                        }
+                        AdminBatchItem action;
+                        action.user_id = item["userId"].get<int64_t>();
+                        ids[i] = action.user_id;
+                        const std::string name = batchStringField(item, "action");
+                        if (name == "add")
+                            action.action = AdminBatchAction::Add;
+                        else if (name == "approve")
+                            action.action = AdminBatchAction::Approve;
+                        else if (name == "decline")
+                            action.action = AdminBatchAction::Decline;
+                        else if (name == "delete")
+                            action.action = AdminBatchAction::Delete;
+                        else
+                        {
+                            results[i].error = "Invalid action";
+                            continue;
+                        }
+                        if (action.action == AdminBatchAction::Add)
+                        {
+                            action.name = batchStringField(item, "name");
+                            action.trade_point = batchStringField(item, "tradePoint");
+                            if (action.user_id == 0 || action.name.empty() || action.trade_point.empty())
+                            {
+                                results[i].error = "Missing required fields";
+                                continue;
+                            }
+                        }
+                        actions.push_back(std::move(action));
+                        positions.push_back(i);
+                    }
+
+                    std::vector<BatchItemResult> db_results = db_batch_admin_actions(actions);
+                    for (size_t k = 0; k < positions.size(); ++k)
+                    {
+                        if (db_results[k].success && actions[k].action == AdminBatchAction::Delete)
+                        {
+                            SessionManager::instance().removeUserData(actions[k].user_id);
+                        }
+                        results[positions[k]] = std::move(db_results[k]);
+                    }
+                    sendBatchResults(res, results, ids, "userId");
+                });
+
     g_svr->Delete(R"(/api/admins/(\d+))", [](const httplib::Request &req, httplib::Response &res)
                   {
                       try
                       {
                           int64_t user_id = std::stoll(req.matches[1]);
                           db_delete_admin(user_id);
+                          SessionManager::instance().removeUserData(user_id);
                           json response = {{"success", true}, {"userId", user_id}};
                           res.set_content(response.dump(), "application/json");
                       }
@@ -351,50 +1286,10 @@ void HttpServer::setupRoutes()
                 });
 
     // ========== TRADE POINTS ==========
-    g_svr->Get("/api/trade-points", [](const httplib::Request &, httplib::Response &res)
-               {
-                   auto points = get_all_trade_points();
-                   json result = json::array();
-
-                   for (const auto &point : points)
-                   {
-                       result.push_back({{"code", point.code},
-                                         {"name", point.name},
-                                         {"address", point.address}});
-                   }
-
-                   res.set_content(result.dump(), "application/json");
-               });
+    cachedGet("/api/trade-points", get_trade_points_version, buildTradePointsJson);
 
     // ========== TARIFFS ==========
-    g_svr->Get("/api/tariffs", [](const httplib::Request &, httplib::Response &res)
-               {
-                   // Используем глобальный вектор tariff_plans из tariff_manager.h
-                   auto &tariffs = tariff_plans;
-                   json result = json::array();
-
-                   for (const auto &tariff : tariffs)
-                   {
-                       json speeds = json::array();
-                       for (const auto &speed_opt : tariff.speeds)
-                       {
-                           speeds.push_back({{"speed", speed_opt.value + " " + speed_opt.unit},
-                                             {"price", speed_opt.price}});
-                       }
-
-                       // Addons не поддерживаются в текущей структуре TariffPlan
-                       json addons = json::array();
-
-                       result.push_back({{"id", tariff.id},
-                                         {"name", tariff.name},
-                                         {"speeds", speeds},
-                                         {"addons", addons},
-                                         {"connectionFee", tariff.connection_fee},
-                                         {"routerRental", tariff.router_rental}});
-                   }
-
-                   res.set_content(result.dump(), "application/json");
-               });
+    cachedGet("/api/tariffs", get_tariff_catalog_version, buildTariffsJson);
 
     // ========== BROADCAST ==========
     g_svr->Post("/api/broadcast", [this](const httplib::Request &req, httplib::Response &res)
@@ -430,27 +1325,18 @@ void HttpServer::setupRoutes()
     // ========== STATISTICS ==========
     g_svr->Get("/api/stats", [](const httplib::Request &, httplib::Response &res)
                {
-                   auto applications = db_get_all_applications();
-                   int newCount = 0, inProgress = 0, completed = 0;
-
-                   for (const auto &app : applications)
-                   {
-                       if (app.chat_status == "Новая")
-                           newCount++;
-                       else if (app.chat_status == "В работе")
-                           inProgress++;
-                       else if (app.chat_status == "Выполнена")
-                           completed++;
-                   }
-
-                   json response = {
-                       {"totalApplications", applications.size()},
-                       {"newToday", newCount},
-                       {"inProgress", inProgress},
-                       {"completed", completed},
-                       {"totalAdmins", db_get_all_admins().size()},
-                       {"pendingAdmins", db_get_pending_admin_requests().size()}};
-                   res.set_content(response.dump(), "application/json");
+                   const DashboardStats stats = db_get_dashboard_stats();
+                   std::string out;
+                   JsonWriter w(out);
+                   w.beginObject();
+                   w.field("totalApplications", stats.applications);
+                   w.field("newToday", stats.new_applications);
+                   w.field("inProgress", stats.in_progress);
+                   w.field("completed", stats.completed);
+                   w.field("totalAdmins", stats.admins);
+                   w.field("pendingAdmins", stats.pending_admins);
+                   w.endObject();
+                   res.set_content(out, "application/json");
                });
 
     LOG(LogLevel::INFO, "HTTP API routes configured");
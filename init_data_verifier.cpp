@@ -0,0 +1,284 @@
+#include "init_data_verifier.h"
+#include <algorithm>
+#include <cstring>
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+
+namespace
+{
+    // Поле initData до декодирования: указатели в исходную строку
+    struct Field
+    {
+        const char *key;
+        size_t key_len;
+        const char *value;
+        size_t value_len;
+    };
+
+    bool keyEquals(const Field &field, const char *name)
+    {
+        const size_t len = std::strlen(name);
+        return field.key_len == len && std::memcmp(field.key, name, len) == 0;
+    }
+
+    int hexValue(char c)
+    {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F')
+            return c - 'A' + 10;
+        return -1;
+    }
+
+    // application/x-www-form-urlencoded -> out; возвращает длину (не больше size)
+    size_t urlDecode(const char *data, size_t size, char *out)
+    {
+        size_t n = 0;
+        for (size_t i = 0; i < size; ++i)
+        {
+            if (data[i] == '%' && i + 2 < size && hexValue(data[i + 1]) >= 0 && hexValue(data[i + 2]) >= 0)
+            {
+                out[n++] = static_cast<char>(hexValue(data[i + 1]) * 16 + hexValue(data[i + 2]));
+                i += 2;
+            }
+            else
+            {
+                out[n++] = data[i] == '+' ? ' ' : data[i];
+            }
+        }
+        return n;
+    }
+
+    // Десятичное число в начале [p, end); false, если цифр нет
+    bool parseInt64(const char *p, const char *end, int64_t &out)
+    {
+        bool negative = p < end && *p == '-';
+        if (negative)
+        {
+            ++p;
+        }
+        if (p == end || *p < '0' || *p > '9')
+        {
+            return false;
+        }
+        int64_t value = 0;
+        while (p < end && *p >= '0' && *p <= '9')
+        {
+            value = value * 10 + (*p++ - '0');
+        }
+        out = negative ? -value : value;
+        return true;
+    }
+
+    uint64_t fnv1a(const char *data, size_t size)
+    {
+        uint64_t h = 1469598103934665603ULL;
+        for (size_t i = 0; i < size; ++i)
+        {
+            h ^= static_cast<unsigned char>(data[i]);
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+
+    // Допустимое опережение auth_date относительно часов сервера
+    constexpr int64_t kClockSkewSec = 300;
+}
+
+InitDataVerifier::InitDataVerifier(const std::string &bot_token, int64_t max_age_sec)
+    : max_age_sec_(max_age_sec)
+{
+    static const char kKey[] = "WebAppData";
+    unsigned int len = sizeof(secret_key_);
+    HMAC(EVP_sha256(), kKey, static_cast<int>(sizeof(kKey) - 1),
+         reinterpret_cast<const unsigned char *>(bot_token.data()), bot_token.size(), secret_key_, &len);
+}
+
+InitDataAuth InitDataVerifier::verify(const char *init_data, size_t size, int64_t now)
+{
+    InitDataAuth auth;
+    if (size == 0 || size > kMaxInitDataSize)
+    {
+        auth.error = size == 0 ? "initData missing" : "initData too large";
+        return auth;
+    }
+
+    const uint64_t key = fnv1a(init_data, size);
+    {
+        std::lock_guard<std::mutex> lock(cache_mtx_);
+        auto it = cache_.find(key);
+        if (it != cache_.end() && it->second.init_data.size() == size &&
+            CRYPTO_memcmp(it->second.init_data.data(), init_data, size) == 0)
+        {
+            if (now - it->second.auth_date > max_age_sec_)
+            {
+                cache_.erase(it);
+                auth.error = "initData expired";
+                return auth;
+            }
+            auth.valid = true;
+            auth.user_id = it->second.user_id;
+            auth.auth_date = it->second.auth_date;
+            return auth;
+        }
+    }
+
+    auth = verifySignature(init_data, size, now);
+    if (auth.valid)
+    {
+        remember(key, init_data, size, auth, now);
+    }
+    return auth;
+}
+
+InitDataAuth InitDataVerifier::verifySignature(const char *init_data, size_t size, int64_t now) const
+{
+    InitDataAuth auth;
+
+    Field fields[kMaxFields];
+    size_t field_count = 0;
+    const Field *hash = nullptr;
+    const char *end = init_data + size;
+    for (const char *p = init_data; p < end;)
+    {
+        const char *amp = static_cast<const char *>(std::memchr(p, '&', end - p));
+        const char *item_end = amp ? amp : end;
+        const char *eq = static_cast<const char *>(std::memchr(p, '=', item_end - p));
+        if (eq && eq != p)
+        {
+            if (field_count == kMaxFields)
+            {
+                auth.error = "initData has too many fields";
+                return auth;
+            }
+            fields[field_count] = {p, static_cast<size_t>(eq - p), eq + 1, static_cast<size_t>(item_end - eq - 1)};
+            ++field_count;
+        }
+        p = item_end + 1;
+    }
+
+    // hash не входит в data-check-string; остальные поля сортируются по ключу
+    for (size_t i = 0; i < field_count; ++i)
+    {
+        if (keyEquals(fields[i], "hash"))
+        {
+            std::swap(fields[i], fields[field_count - 1]);
+            hash = &fields[field_count - 1];
+            break;
+        }
+    }
+    if (!hash || hash->value_len != 64)
+    {
+        auth.error = "initData hash missing";
+        return auth;
+    }
+    unsigned char expected[32];
+    for (size_t i = 0; i < 32; ++i)
+    {
+        const int hi = hexValue(hash->value[2 * i]);
+        const int lo = hexValue(hash->value[2 * i + 1]);
+        if (hi < 0 || lo < 0)
+        {
+            auth.error = "initData hash malformed";
+            return auth;
+        }
+        expected[i] = static_cast<unsigned char>(hi * 16 + lo);
+    }
+    const size_t data_fields = field_count - 1;
+    std::sort(fields, fields + data_fields, [](const Field &a, const Field &b)
+              {
+                  const int cmp = std::memcmp(a.key, b.key, std::min(a.key_len, b.key_len));
+                  return cmp != 0 ? cmp < 0 : a.key_len < b.key_len;
+              });
+
+    // data-check-string: "key=<декодированное значение>" через '\n'; не длиннее исходной строки
+    char check[kMaxInitDataSize];
+    size_t len = 0;
+    const char *user_value = nullptr;
+    size_t user_len = 0;
+    const char *auth_date_value = nullptr;
+    size_t auth_date_len = 0;
+    for (size_t i = 0; i < data_fields; ++i)
+    {
+        if (i > 0)
+        {
+            check[len++] = '\n';
+        }
+        std::memcpy(check + len, fields[i].key, fields[i].key_len);
+        len += fields[i].key_len;
+        check[len++] = '=';
+        const size_t value_len = urlDecode(fields[i].value, fields[i].value_len, check + len);
+        if (keyEquals(fields[i], "user"))
+        {
+            user_value = check + len;
+            user_len = value_len;
+        }
+        else if (keyEquals(fields[i], "auth_date"))
+        {
+            auth_date_value = check + len;
+            auth_date_len = value_len;
+        }
+        len += value_len;
+    }
+
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int digest_len = 0;
+    HMAC(EVP_sha256(), secret_key_, sizeof(secret_key_), reinterpret_cast<const unsigned char *>(check), len,
+         digest, &digest_len);
+    if (digest_len != sizeof(expected) || CRYPTO_memcmp(digest, expected, sizeof(expected)) != 0)
+    {
+        auth.error = "initData signature mismatch";
+        return auth;
+    }
+
+    if (!auth_date_value || !parseInt64(auth_date_value, auth_date_value + auth_date_len, auth.auth_date))
+    {
+        auth.error = "initData auth_date missing";
+        return auth;
+    }
+    if (now - auth.auth_date > max_age_sec_ || auth.auth_date - now > kClockSkewSec)
+    {
+        auth.error = "initData expired";
+        return auth;
+    }
+
+    // user - JSON-объект; нужен только его "id"
+    if (user_value)
+    {
+        static const char kIdKey[] = "\"id\":";
+        const char *user_end = user_value + user_len;
+        const char *id = std::search(user_value, user_end, kIdKey, kIdKey + sizeof(kIdKey) - 1);
+        if (id != user_end)
+        {
+            parseInt64(id + sizeof(kIdKey) - 1, user_end, auth.user_id);
+        }
+    }
+    if (auth.user_id == 0)
+    {
+        auth.error = "initData user missing";
+        return auth;
+    }
+
+    auth.valid = true;
+    return auth;
+}
+
+void InitDataVerifier::remember(uint64_t key, const char *init_data, size_t size, const InitDataAuth &auth, int64_t now)
+{
+    std::lock_guard<std::mutex> lock(cache_mtx_);
+    if (cache_.size() >= kMaxCacheEntries)
+    {
+        for (auto it = cache_.begin(); it != cache_.end();)
+        {
+            it = now - it->second.auth_date > max_age_sec_ ? cache_.erase(it) : std::next(it);
+        }
+        if (cache_.size() >= kMaxCacheEntries)
+        {
+            cache_.clear(); // все записи живые: проще пересчитать HMAC, чем расти без предела
+        }
+    }
+    cache_[key] = CacheEntry{std::string(init_data, size), auth.user_id, auth.auth_date};
+}
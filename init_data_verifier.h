@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Результат проверки Telegram WebApp initData
+struct InitDataAuth
+{
+    bool valid = false;
+    int64_t user_id = 0;
+    int64_t auth_date = 0;
+    const char *error = ""; // причина отказа для лога и ответа 401
+};
+
+/**
+ * InitDataVerifier - проверка подписи Telegram.WebApp.initData
+ * (https://core.telegram.org/bots/webapps#validating-data-received-via-the-mini-app).
+ * Секретный ключ HMAC_SHA256("WebAppData", bot_token) вычисляется один раз в конструкторе.
+ * Разбор и сборка data-check-string идут в буферах на стеке, подпись сравнивается
+ * за постоянное время. Успешно проверенные строки кешируются до истечения auth_date + max_age,
+ * поэтому повторные запросы той же вкладки не считают HMAC.
+ */
+class InitDataVerifier
+{
+public:
+    static constexpr size_t kMaxInitDataSize = 4096;
+    static constexpr size_t kMaxFields = 32;
+    static constexpr size_t kMaxCacheEntries = 10000;
+
+    InitDataVerifier(const std::string &bot_token, int64_t max_age_sec);
+
+    // init_data - строка Telegram.WebApp.initData как есть (URL-encoded); now - unix time
+    InitDataAuth verify(const char *init_data, size_t size, int64_t now);
+    InitDataAuth verify(const std::string &init_data, int64_t now) { return verify(init_data.data(), init_data.size(), now); }
+
+private:
+    struct CacheEntry
+    {
+        std::string init_data; // исходная строка: совпадение хеша ключа ещё не означает ту же подпись
+        int64_t user_id;
+        int64_t auth_date;
+    };
+
+    InitDataAuth verifySignature(const char *init_data, size_t size, int64_t now) const;
+    void remember(uint64_t key, const char *init_data, size_t size, const InitDataAuth &auth, int64_t now);
+
+    unsigned char secret_key_[32];
+    const int64_t max_age_sec_;
+
+    std::mutex cache_mtx_;
+    std::unordered_map<uint64_t, CacheEntry> cache_;
+};
@@ -0,0 +1,348 @@
+#include "json_writer.h"
+#include "database.h"
+#include "tariff_manager.h"
+#include "trade_points.h"
+#include "user_data_types.h"
+#include <cstring>
+
+namespace
+{
+    const char kHex[] = "0123456789abcdef";
+    const char kReplacement[] = "\xEF\xBF\xBD"; // U+FFFD
+
+    // Длина корректной UTF-8 последовательности, начинающейся с p (0 - некорректна)
+    size_t utf8SequenceLength(const unsigned char *p, size_t avail)
+    {
+        const unsigned char c = p[0];
+        if (c >= 0xC2 && c <= 0xDF)
+        {
+            return avail >= 2 && (p[1] & 0xC0) == 0x80 ? 2 : 0;
+        }
+        if (c >= 0xE0 && c <= 0xEF)
+        {
+            if (avail < 3 || (p[1] & 0xC0) != 0x80 || (p[2] & 0xC0) != 0x80)
+            {
+                return 0;
+            }
+            // Отсекаем overlong-формы и суррогаты
+            if ((c == 0xE0 && p[1] < 0xA0) || (c == 0xED && p[1] > 0x9F))
+            {
+                return 0;
+            }
+            return 3;
+        }
+        if (c >= 0xF0 && c <= 0xF4)
+        {
+            if (avail < 4 || (p[1] & 0xC0) != 0x80 || (p[2] & 0xC0) != 0x80 || (p[3] & 0xC0) != 0x80)
+            {
+                return 0;
+            }
+            if ((c == 0xF0 && p[1] < 0x90) || (c == 0xF4 && p[1] > 0x8F))
+            {
+                return 0;
+            }
+            return 4;
+        }
+        return 0;
+    }
+}
+
+void JsonWriter::appendEscaped(std::string &out, const char *data, size_t size)
+{
+    const unsigned char *p = reinterpret_cast<const unsigned char *>(data);
+    const unsigned char *end = p + size;
+    out += '"';
+    while (p < end)
+    {
+        // Длинные участки без спецсимволов копируются одним append
+        const unsigned char *run = p;
+        while (p < end && *p >= 0x20 && *p < 0x80 && *p != '"' && *p != '\\')
+        {
+            ++p;
+        }
+        if (p != run)
+        {
+            out.append(reinterpret_cast<const char *>(run), p - run);
+        }
+        if (p == end)
+        {
+            break;
+        }
+
+        const unsigned char c = *p;
+        if (c >= 0x80)
+        {
+            size_t len = utf8SequenceLength(p, end - p);
+            if (len == 0)
+            {
+                out += kReplacement;
+                ++p;
+            }
+            else
+            {
+                out.append(reinterpret_cast<const char *>(p), len);
+                p += len;
+            }
+            continue;
+        }
+
+        switch (c)
+        {
+        case '"':
+            out += "\\\"";
+            break;
+        case '\\':
+            out += "\\\\";
+            break;
+        case '\b':
+            out += "\\b";
+            break;
+        case '\f':
+            out += "\\f";
+            break;
+        case '\n':
+            out += "\\n";
+            break;
+        case '\r':
+            out += "\\r";
+            break;
+        case '\t':
+            out += "\\t";
+            break;
+        default:
+        {
+            char esc[6] = {'\\', 'u', '0', '0', kHex[c >> 4], kHex[c & 0xF]};
+            out.append(esc, sizeof(esc));
+        }
+        }
+        ++p;
+    }
+    out += '"';
+}
+
+void JsonWriter::beforeValue()
+{
+    if (after_key_)
+    {
+        after_key_ = false;
+        return;
+    }
+    if (has_items_[depth_])
+    {
+        out_ += ',';
+    }
+    has_items_[depth_] = true;
+}
+
+void JsonWriter::beginObject()
+{
+    beforeValue();
+    out_ += '{';
+    if (depth_ < kMaxDepth)
+    {
+        has_items_[++depth_] = false;
+    }
+}
+
+void JsonWriter::endObject()
+{
+    out_ += '}';
+    if (depth_ > 0)
+    {
+        --depth_;
+    }
+}
+
+void JsonWriter::beginArray()
+{
+    beforeValue();
+    out_ += '[';
+    if (depth_ < kMaxDepth)
+    {
+        has_items_[++depth_] = false;
+    }
+}
+
+void JsonWriter::endArray()
+{
+    out_ += ']';
+    if (depth_ > 0)
+    {
+        --depth_;
+    }
+}
+
+void JsonWriter::key(const char *name)
+{
+    beforeValue();
+    appendEscaped(out_, name, std::strlen(name));
+    out_ += ':';
+    after_key_ = true;
+}
+
+void JsonWriter::value(const std::string &s)
+{
+    beforeValue();
+    appendEscaped(out_, s.data(), s.size());
+}
+
+void JsonWriter::value(const char *s)
+{
+    if (!s)
+    {
+        null();
+        return;
+    }
+    beforeValue();
+    appendEscaped(out_, s, std::strlen(s));
+}
+
+void JsonWriter::value(bool v)
+{
+    beforeValue();
+    out_ += v ? "true" : "false";
+}
+
+void JsonWriter::null()
+{
+    beforeValue();
+    out_ += "null";
+}
+
+void JsonWriter::writeSigned(int64_t v)
+{
+    beforeValue();
+    // Модуль через uint64_t, чтобы INT64_MIN не переполнялся
+    uint64_t magnitude = v < 0 ? 0 - static_cast<uint64_t>(v) : static_cast<uint64_t>(v);
+    char buf[24];
+    char *pos = buf + sizeof(buf);
+    do
+    {
+        *--pos = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude);
+    if (v < 0)
+    {
+        *--pos = '-';
+    }
+    out_.append(pos, buf + sizeof(buf) - pos);
+}
+
+void JsonWriter::writeUnsigned(uint64_t v)
+{
+    beforeValue();
+    char buf[24];
+    char *pos = buf + sizeof(buf);
+    do
+    {
+        *--pos = static_cast<char>('0' + v % 10);
+        v /= 10;
+    } while (v);
+    out_.append(pos, buf + sizeof(buf) - pos);
+}
+
+void writeJson(JsonWriter &w, const ApplicationDataForReport &app)
+{
+    w.beginObject();
+    w.field("id", app.id);
+    w.field("userId", app.user_id);
+    w.field("name", app.name);
+    w.field("phone", app.phone);
+    w.field("email", app.email);
+    w.field("tariff", app.tariff);
+    w.field("address", app.address);
+    w.field("status", app.chat_status);
+    w.field("date", app.timestamp);
+    w.field("price", app.price);
+    w.endObject();
+}
+
+void writeJson(JsonWriter &w, const AdminRequestData &admin, bool approved)
+{
+    w.beginObject();
+    w.field("userId", admin.user_id);
+    w.field("name", admin.name);
+    w.field("tradePoint", admin.trade_point);
+    if (approved)
+    {
+        w.field("status", "active");
+    }
+    w.endObject();
+}
+
+void writeJson(JsonWriter &w, const TradePoint &point)
+{
+    w.beginObject();
+    w.field("code", point.code);
+    w.field("name", point.name);
+    w.field("address", point.address);
+    w.endObject();
+}
+
+void writeJson(JsonWriter &w, const TariffPlan &tariff)
+{
+    w.beginObject();
+    w.field("id", tariff.id);
+    w.field("name", tariff.name);
+    w.key("speeds");
+    w.beginArray();
+    for (const auto &speed : tariff.speeds)
+    {
+        w.beginObject();
+        w.field("speed", speed.get_full_speed_text());
+        w.field("price", speed.price);
+        w.endObject();
+    }
+    w.endArray();
+    // Addons не поддерживаются в текущей структуре TariffPlan
+    w.key("addons");
+    w.beginArray();
+    w.endArray();
+    w.field("connectionFee", tariff.connection_fee);
+    w.field("routerRental", tariff.router_rental);
+    w.endObject();
+}
+
+void writeCatalogJson(JsonWriter &w, const TradePoint &point)
+{
+    w.beginObject();
+    w.field("code", point.code);
+    if (!point.name.empty())
+    {
+        w.field("name", point.name);
+    }
+    w.field("address", point.address);
+    w.endObject();
+}
+
+void writeCatalogJson(JsonWriter &w, const TariffPlan &tariff)
+{
+    w.beginObject();
+    w.field("id", tariff.id);
+    w.field("name", tariff.name);
+    w.field("mobile_connection_included", tariff.mobile_connection_included);
+    w.field("mobile_internet_gb", tariff.mobile_internet_gb);
+    w.field("mobile_minutes", tariff.mobile_minutes);
+    w.field("mobile_sms", tariff.mobile_sms);
+    w.field("tv_kion", tariff.tv_kion);
+    w.field("tv_channels", tariff.tv_channels);
+    w.field("router_rental", tariff.router_rental);
+    w.field("tv_box_rental", tariff.tv_box_rental);
+    w.field("connection_fee", tariff.connection_fee);
+    w.key("speeds");
+    w.beginArray();
+    for (const auto &speed : tariff.speeds)
+    {
+        w.beginObject();
+        w.field("value", speed.value);
+        w.field("unit", speed.unit);
+        w.field("price", speed.price);
+        w.field("promo_price_duration_months", speed.promo_price_duration_months);
+        w.field("full_price", speed.full_price);
+        w.endObject();
+    }
+    w.endArray();
+    w.field("internet_unlimited", tariff.internet_unlimited);
+    w.field("internet_limit_gb", tariff.internet_limit_gb);
+    w.endObject();
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+struct ApplicationDataForReport;
+struct AdminRequestData;
+struct TradePoint;
+struct TariffPlan;
+
+/**
+ * JsonWriter - потоковая запись JSON прямо в std::string без промежуточного дерева.
+ * Буфер принадлежит вызывающему и переиспользуется между порциями ответа;
+ * запятые между элементами расставляются автоматически.
+ * Строки экранируются по RFC 8259, некорректный UTF-8 заменяется на U+FFFD.
+ */
+class JsonWriter
+{
+public:
+    explicit JsonWriter(std::string &out) : out_(out) {}
+
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+
+    // Имя поля; следующий вызов value/begin* пишет его значение
+    void key(const char *name);
+
+    void value(const std::string &s);
+    void value(const char *s);
+    void value(bool v);
+
+    template <typename T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, int>::type = 0>
+    void value(T v)
+    {
+        if (std::is_signed<T>::value)
+        {
+            writeSigned(static_cast<int64_t>(v));
+        }
+        else
+        {
+            writeUnsigned(static_cast<uint64_t>(v));
+        }
+    }
+    void null();
+
+    // Пара key + value
+    template <typename T>
+    void field(const char *name, const T &v)
+    {
+        key(name);
+        value(v);
+    }
+
+    // Дописывает строку в JSON-кавычках с экранированием
+    static void appendEscaped(std::string &out, const char *data, size_t size);
+
+    // Максимальная вложенность объектов/массивов
+    static constexpr int kMaxDepth = 32;
+
+private:
+    void beforeValue();
+    void writeSigned(int64_t v);
+    void writeUnsigned(uint64_t v);
+
+    std::string &out_;
+    // has_items_[d] - на уровне d уже есть элемент (нужна запятая)
+    bool has_items_[kMaxDepth + 1] = {};
+    int depth_ = 0;
+    bool after_key_ = false;
+};
+
+// Сущности HTTP API в том же виде, что отдают /api/applications, /api/admins,
+// /api/trade-points и /api/tariffs
+void writeJson(JsonWriter &w, const ApplicationDataForReport &app);
+void writeJson(JsonWriter &w, const AdminRequestData &admin, bool approved);
+void writeJson(JsonWriter &w, const TradePoint &point);
+void writeJson(JsonWriter &w, const TariffPlan &tariff);
+
+// Формат каталогов json-cfg (snake_case, все поля), который читает webapp/js/app.js
+void writeCatalogJson(JsonWriter &w, const TradePoint &point);
+void writeCatalogJson(JsonWriter &w, const TariffPlan &tariff);
@@ -0,0 +1,216 @@
+#include "fake_bot_api.h"
+#include <ctime>
+
+using json = nlohmann::json;
+
+namespace
+{
+    // tgbot-cpp шлёт параметры как urlencoded (req.params) либо multipart (req.form)
+    std::string getArg(const httplib::Request &req, const std::string &name)
+    {
+        if (req.has_param(name))
+        {
+            return req.get_param_value(name);
+        }
+        if (req.form.has_field(name))
+        {
+            return req.form.get_field(name);
+        }
+        return "";
+    }
+
+    int64_t toInt64(const std::string &value, int64_t fallback)
+    {
+        try
+        {
+            return value.empty() ? fallback : std::stoll(value);
+        }
+        catch (...)
+        {
+            return fallback;
+        }
+    }
+
+    // Методы, возвращающие объект Message
+    bool returnsMessage(const std::string &method)
+    {
+        return method.rfind("send", 0) == 0 || method.rfind("editMessage", 0) == 0 || method == "forwardMessage";
+    }
+}
+
+FakeBotApi::FakeBotApi()
+{
+    // /bot<token>/<method>
+    auto handler = [this](const httplib::Request &req, httplib::Response &res)
+    { handleMethod(req, res); };
+    svr_.Get(R"(/bot[^/]+/(\w+))", handler);
+    svr_.Post(R"(/bot[^/]+/(\w+))", handler);
+}
+
+FakeBotApi::~FakeBotApi()
+{
+    stop();
+}
+
+bool FakeBotApi::start(const std::string &host, int port)
+{
+    if (!svr_.bind_to_port(host, port))
+    {
+        return false;
+    }
+    thread_ = std::thread([this]()
+                          { svr_.listen_after_bind(); });
+    return true;
+}
+
+void FakeBotApi::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(queue_mtx_);
+        stopping_ = true;
+    }
+    queue_cv_.notify_all();
+    svr_.stop();
+    if (thread_.joinable())
+    {
+        thread_.join();
+    }
+}
+
+void FakeBotApi::enqueue(QueuedUpdate update)
+{
+    {
+        std::lock_guard<std::mutex> lock(queue_mtx_);
+        queue_.push_back(std::move(update));
+    }
+    queue_cv_.notify_all();
+}
+
+size_t FakeBotApi::queuedCount() const
+{
+    std::lock_guard<std::mutex> lock(queue_mtx_);
+    return queue_.size();
+}
+
+bool FakeBotApi::waitForBot(std::chrono::seconds timeout)
+{
+    std::unique_lock<std::mutex> lock(queue_mtx_);
+    return queue_cv_.wait_for(lock, timeout, [this]()
+                              { return bot_seen_ || stopping_; }) &&
+           bot_seen_;
+}
+
+int64_t FakeBotApi::lastMessageId(int64_t chat_id) const
+{
+    std::lock_guard<std::mutex> lock(calls_mtx_);
+    auto it = last_message_id_.find(chat_id);
+    return it == last_message_id_.end() ? 1 : it->second;
+}
+
+std::map<std::string, uint64_t> FakeBotApi::callCounts() const
+{
+    std::lock_guard<std::mutex> lock(calls_mtx_);
+    return call_counts_;
+}
+
+std::vector<FakeBotApi::OutboundCall> FakeBotApi::callLog() const
+{
+    std::lock_guard<std::mutex> lock(calls_mtx_);
+    return call_log_;
+}
+
+void FakeBotApi::handleMethod(const httplib::Request &req, httplib::Response &res)
+{
+    const std::string method = req.matches[1];
+
+    if (method == "getUpdates")
+    {
+        handleGetUpdates(req, res);
+        return;
+    }
+
+    OutboundCall call{Clock::now(), method, toInt64(getArg(req, "chat_id"), 0)};
+    if (call.chat_id == 0 && method == "answerCallbackQuery")
+    {
+        // id колбэка генерирует сценарий в виде "<chat_id>_<seq>"
+        std::string callback_id = getArg(req, "callback_query_id");
+        call.chat_id = toInt64(callback_id.substr(0, callback_id.find('_')), 0);
+    }
+
+    json result = true;
+    if (method == "getMe")
+    {
+        result = {{"id", 100000001}, {"is_bot", true}, {"first_name", "LoadTestBot"}, {"username", "load_test_bot"}};
+    }
+    else if (returnsMessage(method))
+    {
+        int64_t message_id = toInt64(getArg(req, "message_id"), 0);
+        std::lock_guard<std::mutex> lock(calls_mtx_);
+        if (message_id == 0)
+        {
+            message_id = ++next_message_id_;
+            last_message_id_[call.chat_id] = message_id;
+        }
+        result = {{"message_id", message_id},
+                  {"date", static_cast<int64_t>(std::time(nullptr))},
+                  {"chat", {{"id", call.chat_id}, {"type", "private"}}},
+                  {"text", getArg(req, "text")}};
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(calls_mtx_);
+        ++call_counts_[method];
+        call_log_.push_back(call);
+    }
+    if (call_hook_)
+    {
+        call_hook_(call);
+    }
+
+    json response = {{"ok", true}, {"result", result}};
+    res.set_content(response.dump(), "application/json");
+}
+
+void FakeBotApi::handleGetUpdates(const httplib::Request &req, httplib::Response &res)
+{
+    size_t limit = static_cast<size_t>(toInt64(getArg(req, "limit"), 100));
+    int64_t timeout_sec = toInt64(getArg(req, "timeout"), 0);
+
+    if (poll_hook_)
+    {
+        poll_hook_(Clock::now());
+    }
+
+    // offset подтверждает предыдущую пачку; она уже удалена из очереди при выдаче,
+    // повторная доставка после падения бота не поддерживается
+    std::vector<QueuedUpdate> batch;
+    {
+        std::unique_lock<std::mutex> lock(queue_mtx_);
+        if (!bot_seen_)
+        {
+            bot_seen_ = true;
+            queue_cv_.notify_all();
+        }
+        queue_cv_.wait_for(lock, std::chrono::seconds(timeout_sec), [this]()
+                           { return !queue_.empty() || stopping_; });
+        while (!queue_.empty() && batch.size() < limit)
+        {
+            batch.push_back(std::move(queue_.front()));
+            queue_.pop_front();
+            batch.back().update["update_id"] = next_update_id_++;
+        }
+    }
+
+    json updates = json::array();
+    for (const auto &item : batch)
+    {
+        updates.push_back(item.update);
+    }
+    if (deliver_hook_ && !batch.empty())
+    {
+        deliver_hook_(batch, Clock::now());
+    }
+
+    json response = {{"ok", true}, {"result", updates}};
+    res.set_content(response.dump(), "application/json");
+}
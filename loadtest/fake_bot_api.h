@@ -0,0 +1,95 @@
+#pragma once
+#include "httplib.h"
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * FakeBotApi - локальная замена api.telegram.org для нагрузочного тестирования.
+ * Отдаёт боту апдейты через getUpdates из очереди, заполняемой сценарием,
+ * и принимает исходящие вызовы (sendMessage, editMessageText, ...), отвечая
+ * минимально валидным JSON и запоминая время каждого вызова.
+ *
+ * Бот обрабатывает апдейты одного getUpdates последовательно, поэтому следующий
+ * вызов getUpdates означает, что вся предыдущая пачка обработана.
+ */
+class FakeBotApi
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct OutboundCall
+    {
+        Clock::time_point time;
+        std::string method;
+        int64_t chat_id; // 0, если вызов не привязан к чату
+    };
+
+    // Апдейт в очереди: update_id проставляется при выдаче
+    struct QueuedUpdate
+    {
+        int64_t chat_id;
+        nlohmann::json update;
+    };
+
+    // Вызывается в начале каждого getUpdates (до ожидания новых апдейтов)
+    using PollHook = std::function<void(Clock::time_point)>;
+    // Вызывается после выдачи пачки апдейтов боту
+    using DeliverHook = std::function<void(const std::vector<QueuedUpdate> &, Clock::time_point)>;
+    // Вызывается на каждый исходящий вызов бота
+    using CallHook = std::function<void(const OutboundCall &)>;
+
+    FakeBotApi();
+    ~FakeBotApi();
+
+    void setPollHook(PollHook hook) { poll_hook_ = std::move(hook); }
+    void setDeliverHook(DeliverHook hook) { deliver_hook_ = std::move(hook); }
+    void setCallHook(CallHook hook) { call_hook_ = std::move(hook); }
+
+    bool start(const std::string &host, int port);
+    void stop();
+
+    void enqueue(QueuedUpdate update);
+    size_t queuedCount() const;
+
+    // Блокирует до первого getUpdates от бота
+    bool waitForBot(std::chrono::seconds timeout);
+
+    // message_id последнего сообщения, отправленного боту в чат (для callback_query)
+    int64_t lastMessageId(int64_t chat_id) const;
+
+    std::map<std::string, uint64_t> callCounts() const;
+    std::vector<OutboundCall> callLog() const;
+
+private:
+    void handleMethod(const httplib::Request &req, httplib::Response &res);
+    void handleGetUpdates(const httplib::Request &req, httplib::Response &res);
+
+    httplib::Server svr_;
+    std::thread thread_;
+
+    PollHook poll_hook_;
+    DeliverHook deliver_hook_;
+    CallHook call_hook_;
+
+    mutable std::mutex queue_mtx_;
+    std::condition_variable queue_cv_;
+    std::deque<QueuedUpdate> queue_;
+    int64_t next_update_id_ = 1;
+    bool bot_seen_ = false;
+    bool stopping_ = false;
+
+    mutable std::mutex calls_mtx_;
+    std::map<std::string, uint64_t> call_counts_;
+    std::vector<OutboundCall> call_log_;
+    std::map<int64_t, int64_t> last_message_id_;
+    int64_t next_message_id_ = 1;
+};
@@ -0,0 +1,518 @@
+// bot_loadtest - нагрузочный стенд: локальный Bot API + сценарий виртуальных пользователей.
+//
+// Бот запускается отдельно с "api_base_url": "http://127.0.0.1:<port>" в config.json
+// и чистой БД; стенд отдаёт ему апдейты через getUpdates и замеряет время до ответа.
+//
+//   bot_loadtest --scenario application_form --users 10000 --concurrency 200
+//   bot_loadtest --updates recorded.jsonl
+#include "fake_bot_api.h"
+#include "metrics.h"
+#include <nlohmann/json.hpp>
+#include <atomic>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+using Clock = FakeBotApi::Clock;
+
+namespace
+{
+    struct Options
+    {
+        std::string host = "127.0.0.1";
+        int port = 8081;
+        std::string scenario = "application_form";
+        std::string updates_file; // JSONL с записанными апдейтами вместо сценария
+        int users = 1000;
+        int concurrency = 100;
+        int timeout_sec = 600;
+        int bot_wait_sec = 60;
+        std::string trade_points_file = "json-cfg/trade_points.json";
+        std::string tariffs_file = "json-cfg/tariff_plann.json";
+        std::string report_file;
+        std::string calls_log_file;
+    };
+
+    // Шаг сценария: текст, команда или нажатие inline-кнопки
+    struct Step
+    {
+        enum class Kind
+        {
+            Text,
+            Command,
+            Callback
+        } kind;
+        std::string payload;
+    };
+
+    constexpr int64_t kFirstChatId = 900000000;
+
+    void printUsage()
+    {
+        std::cout << "Usage: bot_loadtest [options]\n"
+                  << "  --host <addr>             listen address (default 127.0.0.1)\n"
+                  << "  --port <n>                listen port (default 8081)\n"
+                  << "  --scenario <name>         application_form (default)\n"
+                  << "  --updates <file.jsonl>    replay recorded updates instead of a scenario\n"
+                  << "  --users <n>               virtual users (default 1000)\n"
+                  << "  --concurrency <n>         users active at the same time (default 100)\n"
+                  << "  --timeout-sec <n>         abort the run after n seconds (default 600)\n"
+                  << "  --bot-wait-sec <n>        wait for the bot's first getUpdates (default 60)\n"
+                  << "  --trade-points <file>     trade points catalog (default json-cfg/trade_points.json)\n"
+                  << "  --tariffs <file>          tariff catalog (default json-cfg/tariff_plann.json)\n"
+                  << "  --report <file.json>      write the summary as JSON\n"
+                  << "  --calls-log <file.csv>    write every outbound call (t_us;method;chat_id)\n";
+    }
+
+    bool parseOptions(int argc, char **argv, Options &opts)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            if (arg == "--help" || arg == "-h")
+            {
+                return false;
+            }
+            if (i + 1 >= argc)
+            {
+                std::cerr << "Missing value for " << arg << "\n";
+                return false;
+            }
+            std::string value = argv[++i];
+            if (arg == "--host")
+                opts.host = value;
+            else if (arg == "--port")
+                opts.port = std::stoi(value);
+            else if (arg == "--scenario")
+                opts.scenario = value;
+            else if (arg == "--updates")
+                opts.updates_file = value;
+            else if (arg == "--users")
+                opts.users = std::stoi(value);
+            else if (arg == "--concurrency")
+                opts.concurrency = std::stoi(value);
+            else if (arg == "--timeout-sec")
+                opts.timeout_sec = std::stoi(value);
+            else if (arg == "--bot-wait-sec")
+                opts.bot_wait_sec = std::stoi(value);
+            else if (arg == "--trade-points")
+                opts.trade_points_file = value;
+            else if (arg == "--tariffs")
+                opts.tariffs_file = value;
+            else if (arg == "--report")
+                opts.report_file = value;
+            else if (arg == "--calls-log")
+                opts.calls_log_file = value;
+            else
+            {
+                std::cerr << "Unknown option " << arg << "\n";
+                return false;
+            }
+        }
+        return opts.users > 0 && opts.concurrency > 0;
+    }
+
+    json loadJson(const std::string &path)
+    {
+        std::ifstream file(path);
+        if (!file.is_open())
+        {
+            throw std::runtime_error("Cannot open " + path);
+        }
+        return json::parse(file);
+    }
+
+    // Заполнение заявки: главное меню -> точка -> тариф -> скорость -> анкета
+    std::vector<Step> applicationFormScript(int index, const json &trade_points, const json &tariffs)
+    {
+        const json &trade_point = trade_points[index % trade_points.size()];
+        const json &tariff = tariffs[index % tariffs.size()];
+        const json &speed = tariff["speeds"].at(0);
+        const std::string tariff_id = tariff["id"].get<std::string>();
+
+        std::ostringstream phone;
+        phone << "912" << std::setw(7) << std::setfill('0') << (index % 10000000);
+
+        std::vector<Step> steps = {
+            {Step::Kind::Command, "/start"},
+            {Step::Kind::Text, "📝 Оставить заявку"},
+            {Step::Kind::Callback, "flyer_code_" + trade_point["code"].get<std::string>()},
+            {Step::Kind::Callback, "show_tariff_detail_" + tariff_id},
+            {Step::Kind::Callback, "select_speed_" + tariff_id + "_" + speed["value"].get<std::string>() + "_" +
+                                       speed["unit"].get<std::string>()},
+        };
+        if (!tariff.value("tv_box_rental", std::string()).empty())
+        {
+            steps.push_back({Step::Kind::Callback, "tv_choice_no"});
+        }
+        std::vector<Step> form = {
+            {Step::Kind::Text, "Нагрузочный Тест " + std::to_string(index)},
+            {Step::Kind::Text, phone.str()},
+            {Step::Kind::Callback, "messenger_telegram"},
+            {Step::Kind::Text, "load" + std::to_string(index) + "@example.com"},
+            {Step::Kind::Text, "Москва"},
+            {Step::Kind::Text, "Тестовая"},
+            {Step::Kind::Text, std::to_string(1 + index % 200)},
+            {Step::Kind::Text, "Пропустить"},
+            {Step::Kind::Text, "Пропустить"},
+        };
+        steps.insert(steps.end(), form.begin(), form.end());
+        return steps;
+    }
+
+    json userJson(int64_t chat_id)
+    {
+        return {{"id", chat_id}, {"is_bot", false}, {"first_name", "Load"}, {"last_name", std::to_string(chat_id)}};
+    }
+
+    json buildUpdate(const FakeBotApi &api, int64_t chat_id, const Step &step, int64_t seq)
+    {
+        const int64_t now = static_cast<int64_t>(std::time(nullptr));
+        const json chat = {{"id", chat_id}, {"type", "private"}};
+        if (step.kind == Step::Kind::Callback)
+        {
+            return {{"callback_query",
+                     {{"id", std::to_string(chat_id) + "_" + std::to_string(seq)},
+                      {"from", userJson(chat_id)},
+                      {"message", {{"message_id", api.lastMessageId(chat_id)}, {"chat", chat}, {"date", now}, {"text", ""}}},
+                      {"chat_instance", std::to_string(chat_id)},
+                      {"data", step.payload}}}};
+        }
+        json message = {{"message_id", seq}, {"from", userJson(chat_id)}, {"chat", chat}, {"date", now}, {"text", step.payload}};
+        if (step.kind == Step::Kind::Command)
+        {
+            json entity = {{"type", "bot_command"}, {"offset", 0}, {"length", step.payload.size()}};
+            message["entities"] = json::array();
+            message["entities"].push_back(entity);
+        }
+        return {{"message", message}};
+    }
+
+    int64_t chatIdOf(const json &update)
+    {
+        if (update.contains("message"))
+        {
+            return update["message"]["chat"]["id"].get<int64_t>();
+        }
+        if (update.contains("callback_query") && update["callback_query"].contains("message"))
+        {
+            return update["callback_query"]["message"]["chat"]["id"].get<int64_t>();
+        }
+        return 0;
+    }
+
+    /**
+     * LoadDriver - учёт доставленных апдейтов и латентности ответа бота.
+     * Латентность апдейта: от выдачи в getUpdates до последнего исходящего вызова
+     * бота в тот же чат до следующего getUpdates (или до самого getUpdates, если ответа не было).
+     * В режиме сценария следующий шаг пользователя ставится в очередь только после ответа на предыдущий.
+     */
+    class LoadDriver
+    {
+    public:
+        LoadDriver(FakeBotApi &api, const Options &opts) : api_(api), opts_(opts) {}
+
+        void setScripts(std::vector<std::vector<Step>> scripts)
+        {
+            scripts_ = std::move(scripts);
+            next_step_.assign(scripts_.size(), 0);
+        }
+
+        // Первая волна пользователей (не больше concurrency одновременно)
+        void startScenario()
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            while (next_user_ < static_cast<int>(scripts_.size()) && next_user_ < opts_.concurrency)
+            {
+                enqueueStepLocked(next_user_++);
+            }
+        }
+
+        void enqueueRecorded(const std::vector<json> &updates)
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            for (const auto &update : updates)
+            {
+                json copy = update;
+                copy.erase("update_id");
+                copy.erase("recorded_at_ms");
+                api_.enqueue({chatIdOf(copy), std::move(copy)});
+                ++expected_updates_;
+            }
+        }
+
+        void onDeliver(const std::vector<FakeBotApi::QueuedUpdate> &batch, Clock::time_point now)
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            if (!run_started_)
+            {
+                run_started_ = true;
+                run_start_ = now;
+            }
+            for (const auto &item : batch)
+            {
+                in_flight_.push_back({item.chat_id, now});
+            }
+        }
+
+        void onCall(const FakeBotApi::OutboundCall &call)
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            last_reply_[call.chat_id] = call.time;
+        }
+
+        // Новый getUpdates: предыдущая пачка полностью обработана ботом
+        void onPoll(Clock::time_point now)
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            if (in_flight_.empty())
+            {
+                return;
+            }
+
+            std::set<int64_t> answered_chats;
+            for (const auto &entry : in_flight_)
+            {
+                auto it = last_reply_.find(entry.chat_id);
+                Clock::time_point end = (it != last_reply_.end() && it->second >= entry.delivered) ? it->second : now;
+                latency_.observe(end - entry.delivered);
+                ++completed_updates_;
+                answered_chats.insert(entry.chat_id);
+            }
+            in_flight_.clear();
+            last_reply_.clear();
+            run_end_ = now;
+
+            if (!scripts_.empty())
+            {
+                for (int64_t chat_id : answered_chats)
+                {
+                    int user = static_cast<int>(chat_id - kFirstChatId);
+                    if (user < 0 || user >= static_cast<int>(scripts_.size()))
+                    {
+                        continue;
+                    }
+                    if (next_step_[user] < scripts_[user].size())
+                    {
+                        enqueueStepLocked(user);
+                    }
+                    else
+                    {
+                        ++finished_users_;
+                        if (next_user_ < static_cast<int>(scripts_.size()))
+                        {
+                            enqueueStepLocked(next_user_++);
+                        }
+                    }
+                }
+            }
+            done_cv_.notify_all();
+        }
+
+        bool waitDone(std::chrono::seconds timeout)
+        {
+            std::unique_lock<std::mutex> lock(mtx_);
+            return done_cv_.wait_for(lock, timeout, [this]()
+                                     { return isDoneLocked(); });
+        }
+
+        json summary() const
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            double seconds = run_started_ ? std::chrono::duration<double>(run_end_ - run_start_).count() : 0.0;
+            json result = {
+                {"completed", isDoneLocked()},
+                {"updates", completed_updates_},
+                {"duration_sec", seconds},
+                {"updates_per_sec", seconds > 0 ? completed_updates_ / seconds : 0.0},
+                {"latency_ms",
+                 {{"p50", latency_.percentile(0.50) / 1000.0},
+                  {"p90", latency_.percentile(0.90) / 1000.0},
+                  {"p99", latency_.percentile(0.99) / 1000.0},
+                  {"mean", completed_updates_ ? latency_.sumMicros() / 1000.0 / completed_updates_ : 0.0}}}};
+            if (!scripts_.empty())
+            {
+                result["users"] = scripts_.size();
+                result["users_finished"] = finished_users_;
+            }
+            return result;
+        }
+
+    private:
+        struct InFlight
+        {
+            int64_t chat_id;
+            Clock::time_point delivered;
+        };
+
+        void enqueueStepLocked(int user)
+        {
+            int64_t chat_id = kFirstChatId + user;
+            const Step &step = scripts_[user][next_step_[user]++];
+            api_.enqueue({chat_id, buildUpdate(api_, chat_id, step, ++seq_)});
+            ++expected_updates_;
+        }
+
+        bool isDoneLocked() const
+        {
+            if (!scripts_.empty())
+            {
+                return finished_users_ == scripts_.size();
+            }
+            return expected_updates_ > 0 && completed_updates_ == expected_updates_;
+        }
+
+        FakeBotApi &api_;
+        const Options &opts_;
+
+        mutable std::mutex mtx_;
+        std::condition_variable done_cv_;
+
+        std::vector<std::vector<Step>> scripts_;
+        std::vector<size_t> next_step_;
+        int next_user_ = 0;
+        size_t finished_users_ = 0;
+        int64_t seq_ = 0;
+
+        std::vector<InFlight> in_flight_;
+        std::map<int64_t, Clock::time_point> last_reply_;
+        uint64_t expected_updates_ = 0;
+        uint64_t completed_updates_ = 0;
+        Histogram latency_;
+
+        bool run_started_ = false;
+        Clock::time_point run_start_;
+        Clock::time_point run_end_;
+    };
+}
+
+int main(int argc, char **argv)
+{
+    Options opts;
+    if (!parseOptions(argc, argv, opts))
+    {
+        printUsage();
+        return 1;
+    }
+
+    FakeBotApi api;
+    LoadDriver driver(api, opts);
+
+    try
+    {
+        if (!opts.updates_file.empty())
+        {
+            std::ifstream file(opts.updates_file);
+            if (!file.is_open())
+            {
+                std::cerr << "Cannot open " << opts.updates_file << "\n";
+                return 1;
+            }
+            std::vector<json> updates;
+            std::string line;
+            while (std::getline(file, line))
+            {
+                if (!line.empty())
+                {
+                    updates.push_back(json::parse(line));
+                }
+            }
+            driver.enqueueRecorded(updates);
+            std::cout << "Loaded " << updates.size() << " recorded updates from " << opts.updates_file << "\n";
+        }
+        else if (opts.scenario == "application_form")
+        {
+            json trade_points = loadJson(opts.trade_points_file);
+            json tariffs = loadJson(opts.tariffs_file);
+            if (trade_points.empty() || tariffs.empty())
+            {
+                std::cerr << "Trade point and tariff catalogs must not be empty\n";
+                return 1;
+            }
+            std::vector<std::vector<Step>> scripts;
+            scripts.reserve(opts.users);
+            for (int i = 0; i < opts.users; ++i)
+            {
+                scripts.push_back(applicationFormScript(i, trade_points, tariffs));
+            }
+            driver.setScripts(std::move(scripts));
+        }
+        else
+        {
+            std::cerr << "Unknown scenario " << opts.scenario << "\n";
+            return 1;
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Failed to prepare load: " << e.what() << "\n";
+        return 1;
+    }
+
+    api.setPollHook([&driver](Clock::time_point now)
+                    { driver.onPoll(now); });
+    api.setDeliverHook([&driver](const std::vector<FakeBotApi::QueuedUpdate> &batch, Clock::time_point now)
+                       { driver.onDeliver(batch, now); });
+    api.setCallHook([&driver](const FakeBotApi::OutboundCall &call)
+                    { driver.onCall(call); });
+
+    if (!api.start(opts.host, opts.port))
+    {
+        std::cerr << "Cannot listen on " << opts.host << ":" << opts.port << "\n";
+        return 1;
+    }
+    std::cout << "Fake Bot API listening on http://" << opts.host << ":" << opts.port
+              << ", waiting for the bot to poll..." << std::endl;
+
+    if (!api.waitForBot(std::chrono::seconds(opts.bot_wait_sec)))
+    {
+        std::cerr << "Bot did not call getUpdates within " << opts.bot_wait_sec << "s\n";
+        return 1;
+    }
+    std::cout << "Bot connected, running load..." << std::endl;
+
+    driver.startScenario();
+    bool completed = driver.waitDone(std::chrono::seconds(opts.timeout_sec));
+    api.stop();
+
+    json report = driver.summary();
+    report["scenario"] = opts.updates_file.empty() ? opts.scenario : "replay:" + opts.updates_file;
+    json calls = json::object();
+    uint64_t total_calls = 0;
+    for (const auto &[method, count] : api.callCounts())
+    {
+        calls[method] = count;
+        total_calls += count;
+    }
+    report["outbound_calls"] = calls;
+    report["outbound_calls_total"] = total_calls;
+
+    std::cout << "\n=== Load test " << (completed ? "completed" : "TIMED OUT") << " ===\n"
+              << report.dump(2) << std::endl;
+
+    if (!opts.report_file.empty())
+    {
+        std::ofstream out(opts.report_file);
+        out << report.dump(2) << "\n";
+    }
+    if (!opts.calls_log_file.empty())
+    {
+        std::ofstream out(opts.calls_log_file);
+        out << "t_us;method;chat_id\n";
+        auto log = api.callLog();
+        Clock::time_point origin = log.empty() ? Clock::now() : log.front().time;
+        for (const auto &call : log)
+        {
+            out << std::chrono::duration_cast<std::chrono::microseconds>(call.time - origin).count() << ";"
+                << call.method << ";" << call.chat_id << "\n";
+        }
+    }
+    return completed ? 0 : 2;
+}
@@ -0,0 +1,402 @@
+// bot_replay - воспроизведение записанных апдейтов (UpdateRecorder) через обработчики бота.
+//
+// Апдейты подаются в тот же EventHandler, что и при long polling, на чистой временной БД;
+// исходящие вызовы Bot API перехватываются локальным клиентом без сети.
+//
+//   bot_replay --updates logs/updates.jsonl --speed max --report build_a.json
+//   bot_replay --updates logs/updates.jsonl --speed 10
+#include "config.h"
+#include "database.h"
+#include "faq_manager.h"
+#include "logger.h"
+#include "metrics.h"
+#include "tariff_manager.h"
+#include "trade_points.h"
+#include "update_dispatch.h"
+#include <tgbot/tgbot.h>
+#include <nlohmann/json.hpp>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <process.h>
+#define replay_getpid _getpid
+#else
+#include <unistd.h>
+#define replay_getpid getpid
+#endif
+
+using json = nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+    struct Options
+    {
+        std::string updates_file;
+        double speed = 0; // 0 - максимальная скорость, 1 - исходный темп, N - в N раз быстрее
+        std::string config_dir = "json-cfg";
+        std::string work_dir;
+        std::string report_file;
+        bool verbose = false;
+    };
+
+    void printUsage()
+    {
+        std::cout << "Usage: bot_replay --updates <file.jsonl> [options]\n"
+                  << "  --speed <max|N>        max (default) or N-times the recorded pace (1 = original timing)\n"
+                  << "  --config-dir <dir>     directory with config.json and catalogs (default json-cfg)\n"
+                  << "  --work-dir <dir>       scratch directory for db/ (default: a fresh temp directory)\n"
+                  << "  --report <file.json>   write the summary as JSON\n"
+                  << "  --verbose              keep INFO logs from handlers\n";
+    }
+
+    bool parseOptions(int argc, char **argv, Options &opts)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            if (arg == "--verbose")
+            {
+                opts.verbose = true;
+                continue;
+            }
+            if (arg == "--help" || arg == "-h" || i + 1 >= argc)
+            {
+                return false;
+            }
+            std::string value = argv[++i];
+            if (arg == "--updates")
+                opts.updates_file = value;
+            else if (arg == "--speed")
+                opts.speed = value == "max" ? 0 : std::stod(value);
+            else if (arg == "--config-dir")
+                opts.config_dir = value;
+            else if (arg == "--work-dir")
+                opts.work_dir = value;
+            else if (arg == "--report")
+                opts.report_file = value;
+            else
+            {
+                std::cerr << "Unknown option " << arg << "\n";
+                return false;
+            }
+        }
+        return !opts.updates_file.empty() && opts.speed >= 0;
+    }
+
+    /**
+     * ReplayHttpClient - отвечает на вызовы Bot API минимально валидным JSON без сети
+     * и считает вызовы по методам.
+     */
+    class ReplayHttpClient : public TgBot::HttpClient
+    {
+    public:
+        std::string makeRequest(const TgBot::Url &url, const std::vector<TgBot::HttpReqArg> &args) const override
+        {
+            size_t pos = url.path.rfind('/');
+            std::string method = pos == std::string::npos ? url.path : url.path.substr(pos + 1);
+
+            std::string chat_id = "0";
+            std::string text;
+            for (const auto &arg : args)
+            {
+                if (arg.name == "chat_id")
+                    chat_id = arg.value;
+                else if (arg.name == "text")
+                    text = arg.value;
+            }
+
+            json result = true;
+            if (method.rfind("send", 0) == 0 || method.rfind("editMessage", 0) == 0)
+            {
+                int64_t chat = 0;
+                try
+                {
+                    chat = std::stoll(chat_id);
+                }
+                catch (...)
+                {
+                }
+                result = {{"message_id", ++next_message_id_},
+                          {"date", static_cast<int64_t>(std::time(nullptr))},
+                          {"chat", {{"id", chat}, {"type", "private"}}},
+                          {"text", text}};
+            }
+            else if (method == "getMe")
+            {
+                result = {{"id", 100000001}, {"is_bot", true}, {"first_name", "ReplayBot"}, {"username", "replay_bot"}};
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                ++calls_[method];
+            }
+            json response = {{"ok", true}, {"result", result}};
+            return response.dump();
+        }
+
+        std::map<std::string, uint64_t> calls() const
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            return calls_;
+        }
+
+    private:
+        mutable std::mutex mtx_;
+        mutable std::map<std::string, uint64_t> calls_;
+        mutable std::atomic<int32_t> next_message_id_{1};
+    };
+
+    TgBot::User::Ptr parseUser(const json &data)
+    {
+        auto user = std::make_shared<TgBot::User>();
+        user->id = data.value("id", int64_t(0));
+        user->firstName = data.value("first_name", "");
+        user->lastName = data.value("last_name", "");
+        user->username = data.value("username", "");
+        return user;
+    }
+
+    TgBot::Message::Ptr parseMessage(const json &data)
+    {
+        auto message = std::make_shared<TgBot::Message>();
+        message->messageId = data.value("message_id", 0);
+        message->date = data.value("date", 0);
+        message->text = data.value("text", "");
+        if (data.contains("from"))
+        {
+            message->from = parseUser(data["from"]);
+        }
+        message->chat = std::make_shared<TgBot::Chat>();
+        message->chat->id = data.contains("chat") ? data["chat"].value("id", int64_t(0)) : 0;
+        if (data.contains("contact"))
+        {
+            message->contact = std::make_shared<TgBot::Contact>();
+            message->contact->phoneNumber = data["contact"].value("phone_number", "");
+        }
+        if (data.contains("web_app_data"))
+        {
+            message->webAppData = std::make_shared<TgBot::WebAppData>();
+            message->webAppData->data = data["web_app_data"].value("data", "");
+            message->webAppData->buttonText = data["web_app_data"].value("button_text", "");
+        }
+        return message;
+    }
+
+    // Разбор только тех полей Update, которые читают обработчики бота
+    TgBot::Update::Ptr parseUpdate(const json &data, std::string &type)
+    {
+        auto update = std::make_shared<TgBot::Update>();
+        update->updateId = data.value("update_id", 0);
+        if (data.contains("message"))
+        {
+            update->message = parseMessage(data["message"]);
+            type = update->message->webAppData ? "webapp_data" : (update->message->text.rfind('/', 0) == 0 ? "command" : "message");
+        }
+        else if (data.contains("callback_query"))
+        {
+            const json &query_data = data["callback_query"];
+            auto query = std::make_shared<TgBot::CallbackQuery>();
+            query->id = query_data.value("id", "");
+            query->data = query_data.value("data", "");
+            if (query_data.contains("from"))
+            {
+                query->from = parseUser(query_data["from"]);
+            }
+            if (query_data.contains("message"))
+            {
+                query->message = parseMessage(query_data["message"]);
+            }
+            update->callbackQuery = query;
+            type = "callback_query";
+        }
+        else
+        {
+            type = "other";
+        }
+        return update;
+    }
+
+    json latencySummary(const Histogram &histogram)
+    {
+        uint64_t count = histogram.count();
+        return {{"count", count},
+                {"p50_ms", histogram.percentile(0.50) / 1000.0},
+                {"p90_ms", histogram.percentile(0.90) / 1000.0},
+                {"p99_ms", histogram.percentile(0.99) / 1000.0},
+                {"p999_ms", histogram.percentile(0.999) / 1000.0},
+                {"mean_ms", count ? histogram.sumMicros() / 1000.0 / count : 0.0}};
+    }
+}
+
+int main(int argc, char **argv)
+{
+    Options opts;
+    if (!parseOptions(argc, argv, opts))
+    {
+        printUsage();
+        return 1;
+    }
+
+    std::vector<json> updates;
+    {
+        std::ifstream file(opts.updates_file);
+        if (!file.is_open())
+        {
+            std::cerr << "Cannot open " << opts.updates_file << "\n";
+            return 1;
+        }
+        std::string line;
+        size_t line_no = 0;
+        while (std::getline(file, line))
+        {
+            ++line_no;
+            if (line.empty())
+            {
+                continue;
+            }
+            try
+            {
+                updates.push_back(json::parse(line));
+            }
+            catch (const json::parse_error &)
+            {
+                std::cerr << "Skipping malformed line " << line_no << "\n";
+            }
+        }
+    }
+    if (updates.empty())
+    {
+        std::cerr << "No updates in " << opts.updates_file << "\n";
+        return 1;
+    }
+
+    // Конфигурация и каталоги - из рабочей папки, БД - во временной
+    const std::filesystem::path original_dir = std::filesystem::current_path();
+    std::filesystem::path config_dir = std::filesystem::absolute(opts.config_dir);
+    std::filesystem::path report_path = opts.report_file.empty() ? std::filesystem::path() : std::filesystem::absolute(opts.report_file);
+    bool temp_work_dir = opts.work_dir.empty();
+    std::filesystem::path work_dir = temp_work_dir
+                                         ? std::filesystem::temp_directory_path() / ("bot_replay_" + std::to_string(replay_getpid()))
+                                         : std::filesystem::path(opts.work_dir);
+    try
+    {
+        load_config((config_dir / "config.json").string());
+        Logger::get().setMinLevel(opts.verbose ? LogLevel::INFO : LogLevel::L_ERROR);
+        load_trade_points((config_dir / "trade_points.json").string());
+        load_faq((config_dir / "faq.json").string());
+        load_tariff_plans((config_dir / "tariff_plann.json").string());
+
+        if (temp_work_dir)
+        {
+            std::filesystem::remove_all(work_dir);
+        }
+        std::filesystem::create_directories(work_dir / "db");
+        std::filesystem::current_path(work_dir);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Setup failed: " << e.what() << "\n";
+        return 1;
+    }
+    db_init();
+
+    ReplayHttpClient http_client;
+    TgBot::Bot bot("replay", http_client, "https://replay.invalid");
+    registerUpdateHandlers(bot);
+
+    Histogram total_latency;
+    std::map<std::string, std::unique_ptr<Histogram>> latency_by_type;
+    Histogram schedule_lag;
+    uint64_t errors = 0;
+
+    const int64_t first_recorded_ms = updates.front().value("recorded_at_ms", int64_t(0));
+    const Clock::time_point run_start = Clock::now();
+    for (const auto &data : updates)
+    {
+        if (opts.speed > 0)
+        {
+            int64_t offset_ms = data.value("recorded_at_ms", first_recorded_ms) - first_recorded_ms;
+            auto scheduled = run_start + std::chrono::duration_cast<Clock::duration>(
+                                             std::chrono::duration<double, std::milli>(offset_ms / opts.speed));
+            std::this_thread::sleep_until(scheduled);
+            schedule_lag.observe(Clock::now() - scheduled);
+        }
+
+        std::string type;
+        TgBot::Update::Ptr update = parseUpdate(data, type);
+        auto &type_histogram = latency_by_type[type];
+        if (!type_histogram)
+        {
+            type_histogram = std::make_unique<Histogram>();
+        }
+
+        Clock::time_point start = Clock::now();
+        try
+        {
+            bot.getEventHandler().handleUpdate(update);
+        }
+        catch (const std::exception &e)
+        {
+            ++errors;
+            if (opts.verbose)
+            {
+                std::cerr << "Update " << update->updateId << " failed: " << e.what() << "\n";
+            }
+        }
+        auto elapsed = Clock::now() - start;
+        total_latency.observe(elapsed);
+        type_histogram->observe(elapsed);
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - run_start).count();
+    db_close();
+
+    json report = {{"updates_file", opts.updates_file},
+                   {"speed", opts.speed > 0 ? json(opts.speed) : json("max")},
+                   {"updates", updates.size()},
+                   {"errors", errors},
+                   {"duration_sec", seconds},
+                   {"updates_per_sec", seconds > 0 ? updates.size() / seconds : 0.0},
+                   {"latency", latencySummary(total_latency)}};
+    json by_type = json::object();
+    for (const auto &[type, histogram] : latency_by_type)
+    {
+        by_type[type] = latencySummary(*histogram);
+    }
+    report["latency_by_type"] = by_type;
+    if (opts.speed > 0)
+    {
+        report["schedule_lag"] = latencySummary(schedule_lag);
+    }
+    json calls = json::object();
+    for (const auto &[method, count] : http_client.calls())
+    {
+        calls[method] = count;
+    }
+    report["outbound_calls"] = calls;
+
+    std::cout << report.dump(2) << std::endl;
+    if (!report_path.empty())
+    {
+        std::ofstream out(report_path);
+        out << report.dump(2) << "\n";
+    }
+    std::error_code ec;
+    std::filesystem::current_path(original_dir, ec);
+    if (temp_work_dir)
+    {
+        std::filesystem::remove_all(work_dir, ec);
+    }
+    return errors ? 2 : 0;
+}
@@ -22,6 +22,15 @@
 #include "application_status.h"
 #include "message_to_client.h"
 #include "http_server.h"
+#include "metrics.h"
+#include "tracing.h"
+#include "telegram_client.h"
+#include "update_dispatch.h"
+#include "update_recorder.h"
+#include "session_manager.h"
+#include "report_export.h"
+#include "scheduler.h"
+#include "scheduled_jobs.h"
 
 #if defined(_WIN32) || defined(_WIN64)
 #include <windows.h>
@@ -49,20 +58,6 @@ void signalHandler(int signum)
 }
 #endif
 
-// ================== ГЛОБАЛЬНЫЕ ПЕРЕМЕННЫЕ (теперь через SessionManager) ==================
-// Для обратной совместимости создаём ссылки на данные в SessionManager
-#include "session_manager.h"
-
-// Эти переменные остаются для совместимости с существующим кодом,
-// но фактические данные хранятся в SessionManager
-std::map<int64_t, std::string> &admin_otps = []() -> std::map<int64_t, std::string> &
-{
-    static std::map<int64_t, std::string> otps;
-    return otps;
-}();
-std::map<int64_t, UserData> &user_session_data = SessionManager::instance().getAllUserSessions();
-std::map<int64_t, AdminWorkMode> &admin_work_mode = SessionManager::instance().getAllAdminModes();
-
 // ================== ОСНОВНАЯ ЛОГИКА БОТА ==================
 int main()
 {
@@ -120,223 +115,40 @@ int main()
 
     db_init();
     LOG(LogLevel::INFO, "Database initialized.");
-    db_load_user_states(user_session_data);
-    LOG(LogLevel::INFO, "User states loaded.");
-    db_load_admin_work_modes(admin_work_mode);
-    LOG(LogLevel::INFO, "Admin work modes loaded.");
+    // Сессии не читаются целиком: SessionManager загружает их из БД при первом обращении
+    SessionManager::instance().setEvictionPolicy(std::chrono::seconds(config.session_idle_ttl_sec),
+                                                 config.session_max_memory_mb * 1024 * 1024);
+
+    MetricsRegistry::instance().gaugeCallback("bot_sessions", "Number of user sessions held in memory", []()
+                                              { return static_cast<double>(SessionManager::instance().sessionCount()); });
+    SessionManager::instance().startWriteBehind(std::chrono::milliseconds(config.session_flush_interval_ms));
+
+    // Все вызовы Bot API идут через InstrumentedHttpClient (латентность и ошибки в /metrics)
+    InstrumentedHttpClient telegram_http_client;
+    TgBot::Bot bot(std::string(config.bot_token), telegram_http_client, config.api_base_url);
+    if (config.api_base_url != "https://api.telegram.org")
+    {
+        LOG(LogLevel::L_WARNING, "Using non-default Bot API base URL: " << config.api_base_url);
+    }
 
-    TgBot::Bot bot(std::string(config.bot_token));
+    if (config.record_updates)
+    {
+        UpdateRecorder::instance().open(config.record_updates_file, config.record_scrub_fields, config.record_keep_texts,
+                                        config.record_pseudonymize_ids, config.main_admin_id);
+    }
 
     // Initialize and start HTTP API server
     initHttpServer(bot);
     HttpServer *httpServer = getHttpServer();
-    httpServer->start(8080);
-    LOG(LogLevel::INFO, "HTTP API server started on port 8080");
-
-    bot.getEvents().onCommand("start", [&bot](TgBot::Message::Ptr message)
-                              {
-                                  int64_t chat_id = message->chat->id;
-                                  LOG(LogLevel::INFO, "Received /start command from chat ID: " << chat_id);
-                                  if (chat_id == config.main_admin_id)
-                                  {
-                                      admin_work_mode[chat_id] = AdminWorkMode::ADMIN_VIEW;
-                                      db_save_admin_work_mode(chat_id, AdminWorkMode::ADMIN_VIEW);
-                                      sendSuperAdminPanel(bot, chat_id);
-                                  }
-                                  else
-                                  {
-                                      sendMainMenu(bot, chat_id);
-                                  }
-                              });
-
-    bot.getEvents().onAnyMessage([&bot](TgBot::Message::Ptr message)
-                                 {
-                                     int64_t chat_id = message->chat->id;
-                                     std::string text = message->text;
-                                     LOG(LogLevel::INFO, "Received message from chat ID: " << chat_id << ", text: " << text);
-
-                                     // --- СПЕЦИАЛЬНАЯ ОБРАБОТКА ДЛЯ ГЛАВНОГО АДМИНА ---
-                                     if (chat_id == config.main_admin_id)
-                                     {
-                                         AdminWorkMode current_mode = AdminWorkMode::UNKNOWN;
-                                         if (admin_work_mode.count(chat_id))
-                                         {
-                                             current_mode = admin_work_mode[chat_id];
-                                         }
-                                         else
-                                         {
-                                             current_mode = db_get_admin_work_mode(chat_id);
-                                             admin_work_mode[chat_id] = current_mode;
-                                         }
-                                         LOG(LogLevel::INFO, "Message from main admin (ID: " << chat_id << "), detected work mode: " << static_cast<int>(current_mode));
-
-                                         UserData &user = user_session_data[chat_id];
-                                         if (user.state == UserState::ADMIN_REPLYING_TO_USER || user.state == UserState::AWAITING_ADMIN_PASSWORD)
-                                         {
-                                             handle_admin_panel_message(bot, message);
-                                             return;
-                                         }
-
-                                         handle_super_admin_message(bot, message);
-                                         return;
-                                     }
-
-                                     // --- ОБРАБОТКА СООБЩЕНИЙ ОБЫЧНЫХ ПОЛЬЗОВАТЕЛЕЙ И ОБЫЧНЫХ АДМИНОВ ---
-                                     if (!db_get_bot_status())
-                                     {
-                                         bot.getApi().sendMessage(chat_id, "Бот временно недоступен для обработки запросов. Пожалуйста, попробуйте позже.");
-                                         LOG(LogLevel::INFO, "Rejected message from user " << chat_id << " because bot is inactive.");
-                                         return;
-                                     }
-
-                                     UserData &user = user_session_data[chat_id];
-
-                                     // --- ОБРАБОТКА ДАННЫХ ИЗ WEBAPP ---
-                                     if (message->webAppData != nullptr)
-                                     {
-                                         LOG(LogLevel::INFO, "Received WebApp data from chat ID: " << chat_id);
-                                         try
-                                         {
-                                             nlohmann::json data = nlohmann::json::parse(message->webAppData->data);
-
-                                             // Заполняем UserData из JSON
-                                             user.flyer_code = data.value("tradePoint", "");
-                                             user.final_tariff_string = data.value("tariff", "") + " (" + data.value("speed", "") + ")";
-                                             user.name = data.value("name", "");
-                                             user.phone = data.value("phone", "");
-                                             user.email = data.value("email", "");
-                                             user.city = data.value("city", "");
-                                             user.street = data.value("street", "");
-                                             user.house = data.value("house", "");
-                                             user.apartment = data.value("apartment", "не указана");
-                                             user.needs_tv_box = data.value("needsTvBox", false);
+    httpServer->start(config.http_port);
 
-                                             // Получаем адрес офиса по коду торговой точки
-                                             std::string office_address;
-                                             get_address_by_code(user.flyer_code, office_address);
+    registerUpdateHandlers(bot);
 
-                                             // Расчёт стоимости с учётом аренды роутера и ТВ-приставки
-                                             int tariff_price = 0;
-                                             int router_rental = 149; // Фиксированная аренда роутера
-                                             int tv_box_rental = 0;
-                                             try
-                                             {
-                                                 tariff_price = std::stoi(data.value("price", "0"));
-                                             }
-                                             catch (...)
-                                             {
-                                             }
-
-                                             if (user.needs_tv_box)
-                                             {
-                                                 tv_box_rental = 149; // Аренда ТВ-приставки
-                                             }
-
-                                             int total_monthly = tariff_price + router_rental + tv_box_rental;
-
-                                             std::string full_address = "г. " + user.city + ", ул. " + user.street + ", д. " + user.house;
-                                             if (!user.apartment.empty() && user.apartment != "не указана")
-                                             {
-                                                 full_address += ", кв. " + user.apartment;
-                                             }
-
-                                             db_add_application(chat_id, user, full_address, total_monthly);
-
-                                             std::stringstream confirmation;
-                                             confirmation << "✅ *Ваша заявка принята!*\n\n"
-                                                          << "Скоро с вами свяжутся для уточнения деталей.\n\n";
-                                             if (!office_address.empty())
-                                             {
-                                                 confirmation << "Для подключения интернета подойдите по адресу:\n*"
-                                                              << office_address << "*\n\n"
-                                                              << "**Не забудьте взять с собой паспорт!**";
-                                             }
-
-                                             bot.getApi().sendMessage(chat_id, confirmation.str(), false, 0, nullptr, "Markdown");
-
-                                             LOG(LogLevel::INFO, "WebApp application saved for user " << chat_id << ", total: " << total_monthly);
-                                         }
-                                         catch (const std::exception &e)
-                                         {
-                                             LOG(LogLevel::L_ERROR, "Failed to parse WebApp data: " << e.what());
-                                             bot.getApi().sendMessage(chat_id, "Ошибка обработки заявки. Попробуйте ещё раз.");
-                                         }
-                                         sendPostApplicationMenu(bot, chat_id);
-                                         return;
-                                     }
-
-                                     if (handle_main_menu_buttons(bot, message))
-                                     {
-                                         return;
-                                     }
-
-                                     std::string admin_trade_point;
-                                     if (db_is_admin_approved(chat_id, admin_trade_point))
-                                     {
-                                         if (user.state == UserState::ADMIN_REPLYING_TO_USER || user.state == UserState::AWAITING_ADMIN_PASSWORD)
-                                         {
-                                             handle_admin_panel_message(bot, message);
-                                             return;
-                                         }
-                                     }
-
-                                     switch (user.state)
-                                     {
-                                     case UserState::AWAITING_ADMIN_NAME:
-                                     case UserState::AWAITING_ADMIN_PASSWORD:
-                                     case UserState::ADMIN_PANEL:
-                                     case UserState::ADMIN_REPLYING_TO_USER:
-                                         handle_admin_panel_message(bot, message);
-                                         break;
-                                     default:
-                                         handle_client_message(bot, message);
-                                         break;
-                                     }
-                                 });
-
-    bot.getEvents().onCallbackQuery([&bot](TgBot::CallbackQuery::Ptr query)
-                                    {
-                                        int64_t chat_id = query->message->chat->id;
-                                        LOG(LogLevel::INFO, "Received callback query from chat ID: " << chat_id << ", data: " << query->data);
-
-                                        AdminWorkMode current_mode = AdminWorkMode::UNKNOWN;
-                                        if (admin_work_mode.count(chat_id))
-                                        {
-                                            current_mode = admin_work_mode[chat_id];
-                                        }
-                                        else
-                                        {
-                                            current_mode = db_get_admin_work_mode(chat_id);
-                                            admin_work_mode[chat_id] = current_mode;
-                                        }
-                                        LOG(LogLevel::INFO, "Callback query from chat ID: " << chat_id << ", detected work mode: " << static_cast<int>(current_mode));
-
-                                        if (chat_id == config.main_admin_id)
-                                        {
-                                            handle_super_admin_callbacks(bot, query);
-                                            if (query->data.rfind("admin_tp_", 0) == 0 || query->data.rfind("approve_", 0) == 0 || query->data.rfind("decline_", 0) == 0 || query->data.rfind("status_", 0) == 0 || query->data.rfind("contact_user_", 0) == 0 || query->data.rfind("chat_start_", 0) == 0)
-                                            {
-                                                handle_admin_callbacks(bot, query);
-                                            }
-                                            return;
-                                        }
-
-                                        if (!db_get_bot_status())
-                                        {
-                                            bot.getApi().answerCallbackQuery(query->id, "Бот временно недоступен.");
-                                            LOG(LogLevel::INFO, "Rejected callback from user " << chat_id << " because bot is inactive.");
-                                            return;
-                                        }
-
-                                        if (query->data.rfind("admin_tp_", 0) == 0 || query->data.rfind("approve_", 0) == 0 || query->data.rfind("decline_", 0) == 0 || query->data.rfind("status_", 0) == 0 || query->data.rfind("contact_user_", 0) == 0 || query->data.rfind("chat_start_", 0) == 0)
-                                        {
-                                            handle_admin_callbacks(bot, query);
-                                        }
-                                        else
-                                        {
-                                            handle_client_callback(bot, query);
-                                        }
-                                    });
+    // Напоминания, ежедневные отчёты и истечение OTP; пропущенные за время простоя запуски выполнятся сразу
+    registerScheduledJobs(bot);
+    MetricsRegistry::instance().gaugeCallback("bot_scheduler_jobs", "Number of jobs in the scheduler", []()
+                                              { return static_cast<double>(Scheduler::instance().jobCount()); });
+    Scheduler::instance().start();
 
     try
     {
@@ -362,6 +174,15 @@ int main()
     }
     LOG(LogLevel::INFO, "HTTP API server stopped.");
 
+    UpdateRecorder::instance().close();
+
+    // Фоновая выгрузка отчётов и задачи планировщика используют бота и БД - дожидаемся их до закрытия
+    ReportExporter::instance().stop();
+    Scheduler::instance().stop();
+
+    // Сессии, изменённые после последнего сброса, записываются до закрытия БД
+    SessionManager::instance().stopWriteBehind();
+
     LOG(LogLevel::INFO, "Closing database...");
     db_close();
     LOG(LogLevel::INFO, "Shutdown complete.");
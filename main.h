@@ -9,7 +9,9 @@
 #include "application_status.h"
 #include "message_to_client.h"
 
-// Объявления глобальных переменных (ссылки на данные в SessionManager)
-extern std::map<int64_t, std::string> &admin_otps;
-extern std::map<int64_t, UserData> &user_session_data;
-extern std::map<int64_t, AdminWorkMode> &admin_work_mode;
\ No newline at end of file
+// Объявления глобальных переменных (данные хранятся в SessionManager)
+// Обёртки над SessionManager (определены в session_manager.h)
+class UserSessionMap;
+class AdminModeMap;
+extern UserSessionMap user_session_data;
+extern AdminModeMap admin_work_mode;
\ No newline at end of file
@@ -1,12 +1,15 @@
 #include "message_to_client.h"
 #include "main.h"
+#include "session_manager.h"
 #include "admin_panel.h" // Для sendAdminPanel()
 #include "logger.h"
+#include "tracing.h"
 #include "user_data_types.h" // Для UserData, UserState
 #include <tgbot/tgbot.h>
 #include <sstream>
 
 void handle_client_reply(TgBot::Bot& bot, TgBot::Message::Ptr message) {
+    TRACE_SPAN("handler", __func__);
     int64_t chat_id = message->chat->id;
     UserData& user = user_session_data[chat_id];
     
@@ -0,0 +1,295 @@
+#include "metrics.h"
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace
+{
+    // Номер старшего установленного бита (v > 0)
+    int highestBit(uint64_t v)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return 63 - __builtin_clzll(v);
+#elif defined(_MSC_VER) && defined(_M_X64)
+        unsigned long index;
+        _BitScanReverse64(&index, v);
+        return static_cast<int>(index);
+#else
+        int e = 0;
+        while (v >>= 1)
+        {
+            ++e;
+        }
+        return e;
+#endif
+    }
+
+    std::string formatDouble(double v)
+    {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%.9g", v);
+        return buf;
+    }
+
+    std::string escapeLabelValue(const std::string &value)
+    {
+        std::string out;
+        out.reserve(value.size());
+        for (char c : value)
+        {
+            if (c == '\\' || c == '"')
+            {
+                out += '\\';
+                out += c;
+            }
+            else if (c == '\n')
+            {
+                out += "\\n";
+            }
+            else
+            {
+                out += c;
+            }
+        }
+        return out;
+    }
+
+    // {{"a","1"},{"b","2"}} -> a="1",b="2"
+    std::string renderLabels(const MetricLabels &labels)
+    {
+        std::string out;
+        for (const auto &label : labels)
+        {
+            if (!out.empty())
+            {
+                out += ',';
+            }
+            out += label.first + "=\"" + escapeLabelValue(label.second) + "\"";
+        }
+        return out;
+    }
+
+    std::string withBraces(const std::string &labels, const std::string &extra = "")
+    {
+        if (labels.empty() && extra.empty())
+        {
+            return "";
+        }
+        if (labels.empty())
+        {
+            return "{" + extra + "}";
+        }
+        if (extra.empty())
+        {
+            return "{" + labels + "}";
+        }
+        return "{" + labels + "," + extra + "}";
+    }
+
+    // Границы le для экспорта: степени двойки от 16 мкс до ~134 с
+    constexpr int kExportMinPow = 4;
+    constexpr int kExportMaxPow = 27;
+}
+
+// ================== Histogram ==================
+
+size_t Histogram::bucketIndex(uint64_t value_us)
+{
+    if (value_us < kSubBucketCount)
+    {
+        return static_cast<size_t>(value_us);
+    }
+    int e = highestBit(value_us);
+    if (e > kMaxExponent)
+    {
+        return kBucketCount - 1;
+    }
+    int shift = e - (kSubBucketBits - 1);
+    uint64_t sub = (value_us >> shift) - kHalfCount;
+    return static_cast<size_t>(kSubBucketCount + (e - kSubBucketBits) * kHalfCount + sub);
+}
+
+uint64_t Histogram::bucketUpperBound(size_t index)
+{
+    if (index < kSubBucketCount)
+    {
+        return index + 1;
+    }
+    size_t k = index - kSubBucketCount;
+    int e = kSubBucketBits + static_cast<int>(k / kHalfCount);
+    uint64_t sub = k % kHalfCount;
+    int shift = e - (kSubBucketBits - 1);
+    return (kHalfCount + sub + 1) << shift;
+}
+
+void Histogram::record(uint64_t value_us)
+{
+    buckets_[bucketIndex(value_us)].fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value_us, std::memory_order_relaxed);
+}
+
+void Histogram::observe(std::chrono::steady_clock::duration d)
+{
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+    record(us > 0 ? static_cast<uint64_t>(us) : 0);
+}
+
+uint64_t Histogram::count() const
+{
+    uint64_t total = 0;
+    for (const auto &bucket : buckets_)
+    {
+        total += bucket.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+uint64_t Histogram::countBelow(uint64_t bound_us) const
+{
+    size_t limit = bucketIndex(bound_us);
+    uint64_t total = 0;
+    for (size_t i = 0; i < limit; ++i)
+    {
+        total += buckets_[i].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+uint64_t Histogram::percentile(double q) const
+{
+    std::array<uint64_t, kBucketCount> snapshot;
+    uint64_t total = 0;
+    for (size_t i = 0; i < kBucketCount; ++i)
+    {
+        snapshot[i] = buckets_[i].load(std::memory_order_relaxed);
+        total += snapshot[i];
+    }
+    if (total == 0)
+    {
+        return 0;
+    }
+
+    uint64_t target = static_cast<uint64_t>(std::ceil(q * static_cast<double>(total)));
+    if (target == 0)
+    {
+        target = 1;
+    }
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBucketCount; ++i)
+    {
+        seen += snapshot[i];
+        if (seen >= target)
+        {
+            return bucketUpperBound(i);
+        }
+    }
+    return bucketUpperBound(kBucketCount - 1);
+}
+
+// ================== MetricsRegistry ==================
+
+MetricsRegistry &MetricsRegistry::instance()
+{
+    static MetricsRegistry registry;
+    return registry;
+}
+
+template <typename T>
+T &MetricsRegistry::getOrCreate(std::map<std::string, Family<T>> &families, const std::string &name,
+                                const std::string &help, const MetricLabels &labels)
+{
+    std::string key = renderLabels(labels);
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto &family = families[name];
+    if (family.help.empty())
+    {
+        family.help = help;
+    }
+    auto &slot = family.series[key];
+    if (!slot)
+    {
+        slot = std::make_unique<T>();
+    }
+    return *slot;
+}
+
+Counter &MetricsRegistry::counter(const std::string &name, const std::string &help, const MetricLabels &labels)
+{
+    return getOrCreate(counters_, name, help, labels);
+}
+
+Gauge &MetricsRegistry::gauge(const std::string &name, const std::string &help, const MetricLabels &labels)
+{
+    return getOrCreate(gauges_, name, help, labels);
+}
+
+Histogram &MetricsRegistry::histogram(const std::string &name, const std::string &help, const MetricLabels &labels)
+{
+    return getOrCreate(histograms_, name, help, labels);
+}
+
+void MetricsRegistry::gaugeCallback(const std::string &name, const std::string &help, std::function<double()> fn)
+{
+    std::lock_guard<std::mutex> lock(mtx_);
+    callbacks_[name] = {help, std::move(fn)};
+}
+
+std::string MetricsRegistry::renderPrometheus() const
+{
+    std::ostringstream out;
+    std::lock_guard<std::mutex> lock(mtx_);
+
+    for (const auto &family : counters_)
+    {
+        out << "# HELP " << family.first << " " << family.second.help << "\n"
+            << "# TYPE " << family.first << " counter\n";
+        for (const auto &series : family.second.series)
+        {
+            out << family.first << withBraces(series.first) << " " << series.second->value() << "\n";
+        }
+    }
+
+    for (const auto &family : gauges_)
+    {
+        out << "# HELP " << family.first << " " << family.second.help << "\n"
+            << "# TYPE " << family.first << " gauge\n";
+        for (const auto &series : family.second.series)
+        {
+            out << family.first << withBraces(series.first) << " " << series.second->value() << "\n";
+        }
+    }
+
+    for (const auto &callback : callbacks_)
+    {
+        out << "# HELP " << callback.first << " " << callback.second.first << "\n"
+            << "# TYPE " << callback.first << " gauge\n"
+            << callback.first << " " << formatDouble(callback.second.second()) << "\n";
+    }
+
+    for (const auto &family : histograms_)
+    {
+        const std::string &name = family.first;
+        out << "# HELP " << name << " " << family.second.help << "\n"
+            << "# TYPE " << name << " histogram\n";
+        for (const auto &series : family.second.series)
+        {
+            const Histogram &h = *series.second;
+            uint64_t total = h.count();
+            for (int p = kExportMinPow; p <= kExportMaxPow; ++p)
+            {
+                uint64_t bound_us = uint64_t(1) << p;
+                std::string le = "le=\"" + formatDouble(static_cast<double>(bound_us) / 1e6) + "\"";
+                out << name << "_bucket" << withBraces(series.first, le) << " " << h.countBelow(bound_us) << "\n";
+            }
+            out << name << "_bucket" << withBraces(series.first, "le=\"+Inf\"") << " " << total << "\n"
+                << name << "_sum" << withBraces(series.first) << " " << formatDouble(static_cast<double>(h.sumMicros()) / 1e6) << "\n"
+                << name << "_count" << withBraces(series.first) << " " << total << "\n";
+        }
+    }
+
+    return out.str();
+}
@@ -0,0 +1,139 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Набор меток метрики: {{"route", "/api/tariffs"}, {"method", "GET"}}
+using MetricLabels = std::vector<std::pair<std::string, std::string>>;
+
+/**
+ * Counter - монотонно растущий счётчик
+ */
+class Counter
+{
+public:
+    void inc(uint64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value_{0};
+};
+
+/**
+ * Gauge - текущее значение (количество сессий, активных соединений и т.п.)
+ */
+class Gauge
+{
+public:
+    void set(int64_t v) { value_.store(v, std::memory_order_relaxed); }
+    void add(int64_t d) { value_.fetch_add(d, std::memory_order_relaxed); }
+    int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> value_{0};
+};
+
+/**
+ * Histogram - lock-free гистограмма латентности в стиле HDR.
+ * Значения хранятся в микросекундах: до 2^kSubBucketBits точно, дальше
+ * по kSubBucketCount/2 корзин на каждую степень двойки (погрешность <= 6.25%).
+ * Запись - два relaxed fetch_add (корзина и сумма; count() суммирует корзины),
+ * без блокировок и аллокаций.
+ */
+class Histogram
+{
+public:
+    static constexpr int kSubBucketBits = 5;
+    static constexpr uint64_t kSubBucketCount = uint64_t(1) << kSubBucketBits;
+    static constexpr uint64_t kHalfCount = kSubBucketCount / 2;
+    static constexpr int kMaxExponent = 40; // ~12 суток в микросекундах
+    static constexpr size_t kBucketCount = kSubBucketCount + (kMaxExponent - kSubBucketBits + 1) * kHalfCount;
+
+    void record(uint64_t value_us);
+    void observe(std::chrono::steady_clock::duration d);
+
+    uint64_t count() const;
+    uint64_t sumMicros() const { return sum_.load(std::memory_order_relaxed); }
+
+    // Количество значений строго меньше bound_us (bound_us округляется до границы корзины)
+    uint64_t countBelow(uint64_t bound_us) const;
+    // Квантиль q в [0, 1]; возвращает верхнюю границу корзины в микросекундах
+    uint64_t percentile(double q) const;
+
+    static size_t bucketIndex(uint64_t value_us);
+    static uint64_t bucketUpperBound(size_t index);
+
+private:
+    std::array<std::atomic<uint64_t>, kBucketCount> buckets_{};
+    std::atomic<uint64_t> sum_{0};
+};
+
+/**
+ * ScopedLatency - RAII-замер: записывает время жизни объекта в гистограмму
+ */
+class ScopedLatency
+{
+public:
+    explicit ScopedLatency(Histogram &histogram)
+        : histogram_(histogram), start_(std::chrono::steady_clock::now()) {}
+    ~ScopedLatency() { histogram_.observe(std::chrono::steady_clock::now() - start_); }
+
+    ScopedLatency(const ScopedLatency &) = delete;
+    ScopedLatency &operator=(const ScopedLatency &) = delete;
+
+private:
+    Histogram &histogram_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+/**
+ * MetricsRegistry - реестр метрик (Singleton) с экспортом в формате Prometheus.
+ * Метрики создаются при первом обращении и живут до завершения процесса,
+ * поэтому ссылки на них можно кешировать в static-переменных на месте вызова.
+ */
+class MetricsRegistry
+{
+public:
+    static MetricsRegistry &instance();
+
+    Counter &counter(const std::string &name, const std::string &help, const MetricLabels &labels = {});
+    Gauge &gauge(const std::string &name, const std::string &help, const MetricLabels &labels = {});
+    Histogram &histogram(const std::string &name, const std::string &help, const MetricLabels &labels = {});
+
+    // Gauge, значение которого вычисляется в момент выгрузки
+    void gaugeCallback(const std::string &name, const std::string &help, std::function<double()> fn);
+
+    // Текстовый формат Prometheus (text/plain; version=0.0.4)
+    std::string renderPrometheus() const;
+
+private:
+    MetricsRegistry() = default;
+    MetricsRegistry(const MetricsRegistry &) = delete;
+    MetricsRegistry &operator=(const MetricsRegistry &) = delete;
+
+    template <typename T>
+    struct Family
+    {
+        std::string help;
+        std::map<std::string, std::unique_ptr<T>> series; // ключ - отрендеренные метки
+    };
+
+    template <typename T>
+    T &getOrCreate(std::map<std::string, Family<T>> &families, const std::string &name,
+                   const std::string &help, const MetricLabels &labels);
+
+    std::map<std::string, Family<Counter>> counters_;
+    std::map<std::string, Family<Gauge>> gauges_;
+    std::map<std::string, Family<Histogram>> histograms_;
+    std::map<std::string, std::pair<std::string, std::function<double()>>> callbacks_;
+
+    mutable std::mutex mtx_;
+};
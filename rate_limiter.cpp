@@ -0,0 +1,88 @@
+#include "rate_limiter.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+RateLimiter::RateLimiter(double rate_per_sec, double burst)
+    : rate_(rate_per_sec > 0 ? rate_per_sec : 1.0), burst_(burst > 0 ? burst : 1.0)
+{
+}
+
+RateLimiter::Decision RateLimiter::acquire(const std::string &key, double cost, std::chrono::steady_clock::time_point now)
+{
+    Decision decision;
+    if (cost <= 0)
+    {
+        return decision;
+    }
+    // Запрос дороже всего ведра иначе не прошёл бы никогда
+    cost = std::min(cost, burst_);
+
+    Shard &shard = shards_[std::hash<std::string>{}(key) % kShards];
+    std::lock_guard<std::mutex> lock(shard.mtx);
+
+    auto it = shard.buckets.find(key);
+    if (it == shard.buckets.end())
+    {
+        if (shard.buckets.size() >= kMaxBucketsPerShard)
+        {
+            pruneFull(shard, now);
+        }
+        it = shard.buckets.emplace(key, Bucket{burst_, now}).first;
+    }
+
+    Bucket &bucket = it->second;
+    const double elapsed = std::chrono::duration<double>(now - bucket.updated).count();
+    if (elapsed > 0)
+    {
+        bucket.tokens = std::min(burst_, bucket.tokens + elapsed * rate_);
+        bucket.updated = now;
+    }
+
+    if (bucket.tokens >= cost)
+    {
+        bucket.tokens -= cost;
+        return decision;
+    }
+
+    decision.allowed = false;
+    decision.retry_after_sec = std::max(1, static_cast<int>(std::ceil((cost - bucket.tokens) / rate_)));
+    return decision;
+}
+
+void RateLimiter::pruneFull(Shard &shard, std::chrono::steady_clock::time_point now)
+{
+    const size_t before = shard.buckets.size();
+    auto oldest = shard.buckets.end();
+    for (auto it = shard.buckets.begin(); it != shard.buckets.end();)
+    {
+        const double elapsed = std::chrono::duration<double>(now - it->second.updated).count();
+        if (it->second.tokens + elapsed * rate_ >= burst_)
+        {
+            it = shard.buckets.erase(it);
+            continue;
+        }
+        if (oldest == shard.buckets.end() || it->second.updated < oldest->second.updated)
+        {
+            oldest = it;
+        }
+        ++it;
+    }
+    // Все ведра ещё расходуются (поток новых клиентов): вытесняется дольше всех не обращавшийся,
+    // иначе шард рос бы без предела
+    if (shard.buckets.size() == before && oldest != shard.buckets.end())
+    {
+        shard.buckets.erase(oldest);
+    }
+}
+
+size_t RateLimiter::bucketCount() const
+{
+    size_t total = 0;
+    for (const auto &shard : shards_)
+    {
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        total += shard.buckets.size();
+    }
+    return total;
+}
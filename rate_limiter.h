@@ -0,0 +1,58 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/**
+ * RateLimiter - token bucket на каждого клиента (IP).
+ * Ведро пополняется со скоростью rate токенов в секунду до burst; запрос стоит
+ * cost токенов (дорогие списки - больше). Ключи разнесены по kShards шардам со своим
+ * мьютексом, поэтому параллельные запросы разных клиентов почти не конкурируют.
+ * Полные ведра давно не обращавшихся клиентов удаляются при переполнении шарда; если
+ * таких нет, вытесняется ведро, к которому дольше всех не обращались.
+ */
+class RateLimiter
+{
+public:
+    static constexpr size_t kShards = 16;
+    static constexpr size_t kMaxBucketsPerShard = 4096;
+
+    struct Decision
+    {
+        bool allowed = true;
+        int retry_after_sec = 0; // через сколько секунд наберётся cost токенов (для 429)
+    };
+
+    RateLimiter(double rate_per_sec, double burst);
+
+    // Списывает cost токенов с ведра клиента key; cost <= 0 - без ограничений
+    Decision acquire(const std::string &key, double cost,
+                     std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+
+    size_t bucketCount() const;
+
+private:
+    struct Bucket
+    {
+        double tokens;
+        std::chrono::steady_clock::time_point updated;
+    };
+
+    struct Shard
+    {
+        mutable std::mutex mtx;
+        std::unordered_map<std::string, Bucket> buckets;
+    };
+
+    // Удаляет ведра, которые уже пополнились до burst (клиент давно не обращался);
+    // если таких нет - самое давнее по последнему обращению
+    void pruneFull(Shard &shard, std::chrono::steady_clock::time_point now);
+
+    const double rate_;
+    const double burst_;
+    std::array<Shard, kShards> shards_;
+};
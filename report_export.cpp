@@ -0,0 +1,283 @@
+#include "report_export.h"
+#include "excel_generate.h"
+#include "database.h"
+#include "config.h"
+#include "logger.h"
+#include "metrics.h"
+#include <zlib.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+
+namespace
+{
+    // Сжатый файл архива, подготовленный потоком пула
+    struct ZipEntry
+    {
+        std::string name;
+        std::string data; // raw deflate
+        uint32_t crc = 0;
+        uint32_t size = 0;
+        size_t rows = 0;
+        bool ok = false;
+    };
+
+    void put16(std::string &out, uint16_t v)
+    {
+        out += static_cast<char>(v & 0xFF);
+        out += static_cast<char>(v >> 8);
+    }
+
+    void put32(std::string &out, uint32_t v)
+    {
+        put16(out, static_cast<uint16_t>(v & 0xFFFF));
+        put16(out, static_cast<uint16_t>(v >> 16));
+    }
+
+    bool deflateRaw(const std::string &in, std::string &out)
+    {
+        z_stream strm{};
+        // windowBits -15 - поток без zlib-заголовка, как требует ZIP (метод 8)
+        if (deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        {
+            return false;
+        }
+        out.resize(deflateBound(&strm, static_cast<uLong>(in.size())));
+        strm.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(in.data()));
+        strm.avail_in = static_cast<uInt>(in.size());
+        strm.next_out = reinterpret_cast<Bytef *>(&out[0]);
+        strm.avail_out = static_cast<uInt>(out.size());
+        // Буфер размером deflateBound гарантирует завершение за один вызов
+        const int ret = deflate(&strm, Z_FINISH);
+        out.resize(strm.total_out);
+        deflateEnd(&strm);
+        return ret == Z_STREAM_END;
+    }
+
+    ZipEntry buildEntry(const std::string &trade_point, sqlite3 *db)
+    {
+        ZipEntry entry;
+        entry.name = "report_" + trade_point + ".csv";
+        std::string csv;
+        append_csv_report_header(csv);
+        entry.rows = append_csv_report_rows(trade_point, {}, csv, db);
+        entry.crc = static_cast<uint32_t>(crc32(0L, reinterpret_cast<const Bytef *>(csv.data()), static_cast<uInt>(csv.size())));
+        entry.size = static_cast<uint32_t>(csv.size());
+        entry.ok = deflateRaw(csv, entry.data);
+        return entry;
+    }
+
+    // ZIP без ZIP64: заголовки файлов, центральный каталог и его конец; имена в UTF-8 (флаг 11)
+    std::string buildZip(const std::vector<ZipEntry> &entries)
+    {
+        const std::time_t now = std::time(nullptr);
+        std::tm local{};
+        localtime_r(&now, &local);
+        const uint16_t dos_time = static_cast<uint16_t>((local.tm_hour << 11) | (local.tm_min << 5) | (local.tm_sec / 2));
+        const uint16_t dos_date = static_cast<uint16_t>(((local.tm_year - 80) << 9) | ((local.tm_mon + 1) << 5) | local.tm_mday);
+        const uint16_t kUtf8Names = 1 << 11;
+
+        std::string zip;
+        std::string directory;
+        uint16_t count = 0;
+        for (const auto &entry : entries)
+        {
+            if (!entry.ok)
+            {
+                continue;
+            }
+            const uint32_t offset = static_cast<uint32_t>(zip.size());
+            put32(zip, 0x04034b50);
+            put16(zip, 20);
+            put16(zip, kUtf8Names);
+            put16(zip, 8);
+            put16(zip, dos_time);
+            put16(zip, dos_date);
+            put32(zip, entry.crc);
+            put32(zip, static_cast<uint32_t>(entry.data.size()));
+            put32(zip, entry.size);
+            put16(zip, static_cast<uint16_t>(entry.name.size()));
+            put16(zip, 0);
+            zip += entry.name;
+            zip += entry.data;
+
+            put32(directory, 0x02014b50);
+            put16(directory, 20);
+            put16(directory, 20);
+            put16(directory, kUtf8Names);
+            put16(directory, 8);
+            put16(directory, dos_time);
+            put16(directory, dos_date);
+            put32(directory, entry.crc);
+            put32(directory, static_cast<uint32_t>(entry.data.size()));
+            put32(directory, entry.size);
+            put16(directory, static_cast<uint16_t>(entry.name.size()));
+            put16(directory, 0); // extra
+            put16(directory, 0); // comment
+            put16(directory, 0); // disk
+            put16(directory, 0); // internal attributes
+            put32(directory, 0); // external attributes
+            put32(directory, offset);
+            directory += entry.name;
+            ++count;
+        }
+        const uint32_t directory_offset = static_cast<uint32_t>(zip.size());
+        zip += directory;
+        put32(zip, 0x06054b50);
+        put16(zip, 0);
+        put16(zip, 0);
+        put16(zip, count);
+        put16(zip, count);
+        put32(zip, static_cast<uint32_t>(directory.size()));
+        put32(zip, directory_offset);
+        put16(zip, 0);
+        return zip;
+    }
+
+    std::string progressText(size_t done, size_t total)
+    {
+        return "📦 Выгрузка всех точек: " + std::to_string(done) + " из " + std::to_string(total) + "...";
+    }
+}
+
+ReportExporter &ReportExporter::instance()
+{
+    static ReportExporter exporter;
+    return exporter;
+}
+
+bool ReportExporter::exportAll(TgBot::Bot &bot, int64_t chat_id, int32_t progress_message_id, std::vector<std::string> trade_points)
+{
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (running_.exchange(true))
+    {
+        return false;
+    }
+    // Предыдущая задача уже завершилась (running_ был false) - её поток просто присоединяется
+    if (job_.joinable())
+    {
+        job_.join();
+    }
+    cancel_ = false;
+    job_ = std::thread(&ReportExporter::run, this, std::ref(bot), chat_id, progress_message_id, std::move(trade_points));
+    return true;
+}
+
+void ReportExporter::stop()
+{
+    std::lock_guard<std::mutex> lock(mtx_);
+    cancel_ = true;
+    if (job_.joinable())
+    {
+        job_.join();
+    }
+}
+
+void ReportExporter::run(TgBot::Bot &bot, int64_t chat_id, int32_t progress_message_id, std::vector<std::string> trade_points)
+{
+    static Histogram &duration = MetricsRegistry::instance().histogram("bot_report_export_duration_seconds",
+                                                                      "Duration of the all-trade-points report export");
+    ScopedLatency timer(duration);
+    const size_t total = trade_points.size();
+    std::vector<ZipEntry> entries(total);
+    std::atomic<size_t> next{0};
+    std::mutex done_mtx;
+    std::condition_variable done_cv;
+    size_t done = 0;
+
+    const size_t thread_count = std::max<size_t>(1, std::min(config.report_export_threads, total));
+    std::vector<std::thread> workers;
+    workers.reserve(thread_count);
+    for (size_t t = 0; t < thread_count; ++t)
+    {
+        workers.emplace_back([&]()
+                             {
+                                 sqlite3 *db = db_open_readonly();
+                                 for (size_t i = next++; i < total; i = next++)
+                                 {
+                                     if (db && !cancel_)
+                                     {
+                                         entries[i] = buildEntry(trade_points[i], db);
+                                     }
+                                     std::lock_guard<std::mutex> lock(done_mtx);
+                                     ++done;
+                                     done_cv.notify_one();
+                                 }
+                                 db_close_readonly(db);
+                             });
+    }
+
+    // Прогресс правится не чаще раза в секунду: Telegram ограничивает частоту правок
+    auto safeEdit = [&](const std::string &text)
+    {
+        try
+        {
+            bot.getApi().editMessageText(text, chat_id, progress_message_id);
+        }
+        catch (const std::exception &e)
+        {
+            LOG(LogLevel::L_WARNING, "Report export: progress update failed: " << e.what());
+        }
+    };
+    size_t reported = 0;
+    {
+        std::unique_lock<std::mutex> lock(done_mtx);
+        while (done < total)
+        {
+            done_cv.wait_for(lock, std::chrono::seconds(1), [&]()
+                             { return done == total; });
+            if (done != reported && done < total)
+            {
+                reported = done;
+                lock.unlock();
+                safeEdit(progressText(reported, total));
+                lock.lock();
+            }
+        }
+    }
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+
+    size_t rows = 0;
+    size_t failed = 0;
+    for (const auto &entry : entries)
+    {
+        rows += entry.rows;
+        failed += entry.ok ? 0 : 1;
+    }
+    try
+    {
+        if (cancel_)
+        {
+            safeEdit("Выгрузка прервана.");
+        }
+        else if (total == 0)
+        {
+            safeEdit("Нет торговых точек для выгрузки.");
+        }
+        else if (failed == total)
+        {
+            safeEdit("Не удалось собрать отчёты по точкам.");
+        }
+        else
+        {
+            auto file = std::make_shared<TgBot::InputFile>();
+            file->fileName = "reports_" + std::to_string(std::time(nullptr)) + ".zip";
+            file->mimeType = "application/zip";
+            file->data = buildZip(entries);
+            entries.clear();
+            safeEdit("📦 Выгрузка всех точек готова: " + std::to_string(total - failed) + " из " + std::to_string(total) +
+                     " точек, " + std::to_string(rows) + " заявок.");
+            bot.getApi().sendDocument(chat_id, file);
+        }
+        LOG(LogLevel::INFO, "Report export for " << chat_id << ": " << total << " trade points, " << rows << " rows, " << failed << " failed.");
+    }
+    catch (const std::exception &e)
+    {
+        LOG(LogLevel::L_ERROR, "Report export for " << chat_id << " failed: " << e.what());
+    }
+    running_ = false;
+}
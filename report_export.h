@@ -0,0 +1,37 @@
+#pragma once
+#include <tgbot/tgbot.h>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * ReportExporter - фоновая выгрузка отчётов по всем торговым точкам одним ZIP-архивом.
+ * Поток бота только запускает задачу и сразу возвращается. Координатор задачи раздаёт
+ * точки пулу из reports.export_threads потоков. У каждого потока своё read-only соединение
+ * (db_open_readonly), он собирает CSV точки и сжимает его в элемент архива. Сам координатор
+ * правит сообщение с прогрессом (не чаще раза в секунду), собирает архив и отправляет
+ * документ. Одновременно идёт одна выгрузка.
+ */
+class ReportExporter
+{
+public:
+    static ReportExporter &instance();
+
+    // Запускает выгрузку; progress_message_id - сообщение, которое правится по ходу.
+    // false - предыдущая выгрузка ещё не закончилась
+    bool exportAll(TgBot::Bot &bot, int64_t chat_id, int32_t progress_message_id, std::vector<std::string> trade_points);
+    // Останавливает текущую выгрузку (оставшиеся точки пропускаются) и ждёт её завершения
+    void stop();
+
+private:
+    ReportExporter() = default;
+    void run(TgBot::Bot &bot, int64_t chat_id, int32_t progress_message_id, std::vector<std::string> trade_points);
+
+    std::mutex mtx_;
+    std::thread job_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> cancel_{false};
+};
@@ -0,0 +1,133 @@
+#include "response_cache.h"
+#include "logger.h"
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+
+namespace
+{
+    std::string computeEtag(const std::string &body)
+    {
+        uint64_t h = 1469598103934665603ULL;
+        for (unsigned char c : body)
+        {
+            h ^= c;
+            h *= 1099511628211ULL;
+        }
+        char buf[48];
+        std::snprintf(buf, sizeof(buf), "\"%016llx-%zx\"", static_cast<unsigned long long>(h), body.size());
+        return buf;
+    }
+
+    std::string httpDateNow()
+    {
+        std::time_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+        std::tm tm{};
+#if defined(_WIN32) || defined(_WIN64)
+        gmtime_s(&tm, &now);
+#else
+        gmtime_r(&now, &tm);
+#endif
+        char buf[64];
+        std::strftime(buf, sizeof(buf), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+        return buf;
+    }
+
+    std::string trim(const std::string &s)
+    {
+        size_t begin = s.find_first_not_of(" \t");
+        if (begin == std::string::npos)
+        {
+            return "";
+        }
+        size_t end = s.find_last_not_of(" \t");
+        return s.substr(begin, end - begin + 1);
+    }
+}
+
+ResponseCache &ResponseCache::instance()
+{
+    static ResponseCache cache;
+    return cache;
+}
+
+void ResponseCache::registerEntry(const std::string &key, VersionFn version, BuildFn build, const std::string &content_type)
+{
+    auto entry = std::make_unique<Entry>();
+    entry->version = std::move(version);
+    entry->build = std::move(build);
+    entry->content_type = content_type;
+
+    std::lock_guard<std::mutex> lock(mtx_);
+    entries_[key] = std::move(entry);
+}
+
+std::shared_ptr<const CachedResponse> ResponseCache::get(const std::string &key)
+{
+    Entry *entry = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        auto it = entries_.find(key);
+        if (it == entries_.end())
+        {
+            return nullptr;
+        }
+        entry = it->second.get();
+    }
+
+    const uint64_t version = entry->version();
+    std::shared_ptr<const CachedResponse> current = std::atomic_load(&entry->current);
+    if (current && current->version == version)
+    {
+        return current;
+    }
+
+    std::lock_guard<std::mutex> build_lock(entry->build_mtx);
+    current = std::atomic_load(&entry->current);
+    if (current && current->version == version)
+    {
+        return current;
+    }
+
+    auto fresh = std::make_shared<CachedResponse>();
+    fresh->body = entry->build();
+    fresh->content_type = entry->content_type;
+    fresh->etag = computeEtag(fresh->body);
+    fresh->last_modified = httpDateNow();
+    fresh->version = version;
+    fresh->gzip_body = compressBody(fresh->body, ContentCoding::Gzip);
+    fresh->deflate_body = compressBody(fresh->body, ContentCoding::Deflate);
+    std::atomic_store(&entry->current, std::shared_ptr<const CachedResponse>(fresh));
+    LOG(LogLevel::INFO, "Response cache rebuilt for " << key << " (version " << version << ", " << fresh->body.size()
+                                                     << " bytes, gzip " << fresh->gzip_body.size() << " bytes)");
+    return fresh;
+}
+
+bool ResponseCache::etagMatches(const std::string &if_none_match, const std::string &etag)
+{
+    const std::string opaque = etag.rfind("W/", 0) == 0 ? etag.substr(2) : etag;
+    size_t pos = 0;
+    while (pos <= if_none_match.size())
+    {
+        size_t comma = if_none_match.find(',', pos);
+        std::string candidate = trim(if_none_match.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos));
+        if (candidate == "*")
+        {
+            return true;
+        }
+        if (candidate.rfind("W/", 0) == 0)
+        {
+            candidate = candidate.substr(2);
+        }
+        if (!candidate.empty() && candidate == opaque)
+        {
+            return true;
+        }
+        if (comma == std::string::npos)
+        {
+            break;
+        }
+        pos = comma + 1;
+    }
+    return false;
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include "http_compression.h"
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+/**
+ * CachedResponse - сериализованное тело ответа вместе с валидаторами.
+ * Неизменяемо после построения; раздаётся по shared_ptr, поэтому запросы
+ * отдают одни и те же байты без копирования.
+ */
+struct CachedResponse
+{
+    std::string body;
+    std::string content_type;
+    std::string etag;          // сильный ETag в кавычках: "<fnv64>-<size>"
+    std::string last_modified; // IMF-fixdate момента построения
+    uint64_t version = 0;
+
+    // Сжатые варианты строятся один раз вместе с телом (при загрузке каталога)
+    std::string gzip_body;
+    std::string deflate_body;
+
+    const std::string &bodyFor(ContentCoding coding) const
+    {
+        switch (coding)
+        {
+        case ContentCoding::Gzip:
+            return gzip_body.empty() ? body : gzip_body;
+        case ContentCoding::Deflate:
+            return deflate_body.empty() ? body : deflate_body;
+        default:
+            return body;
+        }
+    }
+};
+
+/**
+ * ResponseCache - кеш ответов для маршрутов, чьи данные меняются только вместе с версией
+ * источника (каталоги тарифов и точек перечитываются лишь при загрузке конфигурации).
+ * Маршрут регистрируется функцией версии и функцией сериализации; тело строится заново
+ * только когда версия изменилась.
+ */
+class ResponseCache
+{
+public:
+    using VersionFn = std::function<uint64_t()>;
+    using BuildFn = std::function<std::string()>;
+
+    static ResponseCache &instance();
+
+    void registerEntry(const std::string &key, VersionFn version, BuildFn build,
+                       const std::string &content_type = "application/json");
+
+    // Актуальный ответ для ключа (nullptr, если ключ не зарегистрирован)
+    std::shared_ptr<const CachedResponse> get(const std::string &key);
+
+    // Проверка If-None-Match (список ETag'ов или "*", слабое сравнение по RFC 9110)
+    static bool etagMatches(const std::string &if_none_match, const std::string &etag);
+
+private:
+    ResponseCache() = default;
+    ResponseCache(const ResponseCache &) = delete;
+    ResponseCache &operator=(const ResponseCache &) = delete;
+
+    struct Entry
+    {
+        VersionFn version;
+        BuildFn build;
+        std::string content_type;
+        std::mutex build_mtx; // одна пересборка за раз, остальные ждут готовый результат
+        std::shared_ptr<const CachedResponse> current;
+    };
+
+    std::mutex mtx_;
+    std::map<std::string, std::unique_ptr<Entry>> entries_;
+};
@@ -0,0 +1,189 @@
+#include "scheduled_jobs.h"
+#include "scheduler.h"
+#include "session_manager.h"
+#include "excel_generate.h"
+#include "trade_points.h"
+#include "database.h"
+#include "config.h"
+#include "logger.h"
+#include <chrono>
+#include <ctime>
+#include <sstream>
+
+namespace
+{
+    const char *const kChatRemindersJob = "chat_reminders";
+    const char *const kDailyReportsJob = "daily_reports";
+    const char *const kOtpExpiryJob = "otp_expiry";
+
+    std::string otpExpiryJobName(int64_t admin_id)
+    {
+        return std::string(kOtpExpiryJob) + ":" + std::to_string(admin_id);
+    }
+
+    // Вчерашняя дата по UTC: TIMESTAMP заявок пишется CURRENT_TIMESTAMP (UTC)
+    std::string yesterdayUtc()
+    {
+        const std::time_t yesterday = std::time(nullptr) - 86400;
+        std::tm utc{};
+        gmtime_r(&yesterday, &utc);
+        char buf[11];
+        std::strftime(buf, sizeof(buf), "%Y-%m-%d", &utc);
+        return buf;
+    }
+
+    // Telegram отказал окончательно: бот заблокирован (403 Forbidden) или чата нет (400 chat not found).
+    // Остальные ошибки (429, 5xx, сеть) временные
+    bool isPermanentDeliveryError(const std::string &error)
+    {
+        return error.find("Forbidden") != std::string::npos || error.find("chat not found") != std::string::npos;
+    }
+
+    // Напоминание назначенному админу; срок снимается, если Telegram сообщение принял или
+    // отклонил окончательно, при временной ошибке повтор на следующем запуске
+    void sendChatReminders(TgBot::Bot &bot)
+    {
+        for (const auto &chat : db_get_due_postponed_chats())
+        {
+            auto keyboard = std::make_shared<TgBot::InlineKeyboardMarkup>();
+            auto btn_contact = std::make_shared<TgBot::InlineKeyboardButton>();
+            btn_contact->text = "Начать переписку";
+            btn_contact->callbackData = "chat_start_" + std::to_string(chat.application_id) + "_" + std::to_string(chat.user_id);
+            keyboard->inlineKeyboard.push_back({btn_contact});
+
+            std::stringstream text;
+            text << "⏰ Напоминание: пора вернуться к отложенному чату по заявке №" << chat.application_id << "\n"
+                 << "Клиент: " << chat.name << ", " << chat.phone;
+            try
+            {
+                bot.getApi().sendMessage(chat.admin_id, text.str(), false, 0, keyboard);
+                db_clear_chat_postponed(chat.application_id);
+                LOG(LogLevel::INFO, "Scheduler: chat reminder for app ID " << chat.application_id << " sent to admin " << chat.admin_id);
+            }
+            catch (const TgBot::TgException &e)
+            {
+                if (!isPermanentDeliveryError(e.what()))
+                {
+                    LOG(LogLevel::L_WARNING, "Scheduler: chat reminder for app ID " << chat.application_id << " failed, will retry: " << e.what());
+                    continue;
+                }
+                db_clear_chat_postponed(chat.application_id);
+                LOG(LogLevel::L_WARNING, "Scheduler: chat reminder for app ID " << chat.application_id << " rejected: " << e.what());
+            }
+            catch (const std::exception &e)
+            {
+                LOG(LogLevel::L_WARNING, "Scheduler: chat reminder for app ID " << chat.application_id << " failed, will retry: " << e.what());
+            }
+        }
+    }
+
+    // Отчёт каждой точки за вчерашние сутки её одобренным админам (точки без заявок пропускаются).
+    // Курсоры отчётов идут по отдельному read-only соединению и не держат основное
+    void sendDailyReports(TgBot::Bot &bot)
+    {
+        const std::string day = yesterdayUtc();
+        sqlite3 *db = db_open_readonly(); // nullptr - отчёты по основному соединению
+        size_t sent = 0;
+        for (const auto &trade_point : get_all_trade_point_codes())
+        {
+            if (Scheduler::instance().stopping())
+            {
+                LOG(LogLevel::L_WARNING, "Scheduler: daily reports interrupted by shutdown");
+                break;
+            }
+            const std::vector<int64_t> admins = db_get_admin_ids_by_trade_point(trade_point);
+            if (admins.empty())
+            {
+                continue;
+            }
+            ReportFile report;
+            try
+            {
+                report = generate_excel_report(trade_point, {day, day}, db);
+            }
+            catch (const std::exception &e)
+            {
+                LOG(LogLevel::L_ERROR, "Scheduler: daily report for TP '" << trade_point << "' failed: " << e.what());
+                continue;
+            }
+            if (report.rows == 0)
+            {
+                continue;
+            }
+            // Один InputFile на всех админов точки: отчёт собирается один раз
+            auto file = std::make_shared<TgBot::InputFile>();
+            file->fileName = std::move(report.file_name);
+            file->mimeType = std::move(report.mime_type);
+            file->data = std::move(report.data);
+            for (int64_t admin_id : admins)
+            {
+                try
+                {
+                    bot.getApi().sendMessage(admin_id, "📊 Отчёт по точке " + trade_point + " за " + day + " (заявок: " + std::to_string(report.rows) + ")");
+                    bot.getApi().sendDocument(admin_id, file);
+                    ++sent;
+                }
+                catch (const std::exception &e)
+                {
+                    LOG(LogLevel::L_WARNING, "Scheduler: daily report for TP '" << trade_point << "' to admin " << admin_id << " failed: " << e.what());
+                }
+            }
+        }
+        db_close_readonly(db);
+        LOG(LogLevel::INFO, "Scheduler: daily reports for " << day << " sent " << sent << " times");
+    }
+
+    void expireOtp(TgBot::Bot &bot, const std::string &payload)
+    {
+        const int64_t admin_id = std::stoll(payload);
+        if (!SessionManager::instance().expireOtp(admin_id, std::chrono::seconds(config.admin_otp_ttl_sec)))
+        {
+            return;
+        }
+        LOG(LogLevel::INFO, "Scheduler: OTP for admin ID " << admin_id << " expired");
+        try
+        {
+            bot.getApi().sendMessage(admin_id, "Срок действия пароля истёк. Чтобы войти, откройте панель администратора заново.");
+        }
+        catch (const std::exception &e)
+        {
+            LOG(LogLevel::L_WARNING, "Scheduler: OTP expiry notice to admin " << admin_id << " failed: " << e.what());
+        }
+    }
+}
+
+void registerScheduledJobs(TgBot::Bot &bot)
+{
+    Scheduler &scheduler = Scheduler::instance();
+    scheduler.registerHandler(kChatRemindersJob, [&bot](const std::string &)
+                              { sendChatReminders(bot); });
+    scheduler.registerHandler(kDailyReportsJob, [&bot](const std::string &)
+                              { sendDailyReports(bot); });
+    scheduler.registerHandler(kOtpExpiryJob, [&bot](const std::string &payload)
+                              { expireOtp(bot, payload); });
+
+    if (!config.scheduler_chat_reminder_cron.empty())
+    {
+        scheduler.scheduleCron(kChatRemindersJob, kChatRemindersJob, config.scheduler_chat_reminder_cron);
+    }
+    if (!config.scheduler_daily_report_cron.empty())
+    {
+        scheduler.scheduleCron(kDailyReportsJob, kDailyReportsJob, config.scheduler_daily_report_cron);
+    }
+}
+
+void scheduleOtpExpiry(int64_t admin_id)
+{
+    if (config.admin_otp_ttl_sec <= 0)
+    {
+        return;
+    }
+    // +1: time() округляет вниз, а expireOtp сверяет полный ttl по steady_clock
+    const int64_t at = static_cast<int64_t>(std::time(nullptr)) + config.admin_otp_ttl_sec + 1;
+    Scheduler::instance().scheduleAt(otpExpiryJobName(admin_id), kOtpExpiryJob, std::to_string(admin_id), at);
+}
+
+void cancelOtpExpiry(int64_t admin_id)
+{
+    Scheduler::instance().cancel(otpExpiryJobName(admin_id));
+}
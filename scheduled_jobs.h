@@ -0,0 +1,12 @@
+#pragma once
+#include <tgbot/tgbot.h>
+#include <cstdint>
+
+// Задачи планировщика бота: напоминания об отложенных чатах, ежедневные отчёты точек
+// и истечение OTP админов. Регистрируются до Scheduler::start().
+void registerScheduledJobs(TgBot::Bot &bot);
+
+// Разовая задача: OTP админа удаляется через scheduler.otp_ttl_sec после выдачи
+void scheduleOtpExpiry(int64_t admin_id);
+// Пароль использован - задача истечения больше не нужна
+void cancelOtpExpiry(int64_t admin_id);
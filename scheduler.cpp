@@ -0,0 +1,529 @@
+#include "scheduler.h"
+#include "logger.h"
+#include "metrics.h"
+#include <chrono>
+#include <ctime>
+#include <sstream>
+
+namespace
+{
+    int64_t unixNow()
+    {
+        return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    Counter &jobRuns(const std::string &kind, const char *result)
+    {
+        return MetricsRegistry::instance().counter("bot_scheduler_job_runs_total", "Scheduled job runs by job kind and result",
+                                                   {{"kind", kind}, {"result", result}});
+    }
+
+    Histogram &jobDuration(const std::string &kind)
+    {
+        return MetricsRegistry::instance().histogram("bot_scheduler_job_duration_seconds", "Duration of scheduled job runs",
+                                                     {{"kind", kind}});
+    }
+
+    bool parseNumber(const std::string &text, int &value)
+    {
+        if (text.empty() || text.size() > 2)
+        {
+            return false;
+        }
+        value = 0;
+        for (char c : text)
+        {
+            if (c < '0' || c > '9')
+            {
+                return false;
+            }
+            value = value * 10 + (c - '0');
+        }
+        return true;
+    }
+
+    // Поле cron -> битовая маска значений [lo, hi]
+    bool parseField(const std::string &field, int lo, int hi, uint64_t &bits)
+    {
+        bits = 0;
+        size_t pos = 0;
+        while (pos <= field.size())
+        {
+            size_t comma = field.find(',', pos);
+            if (comma == std::string::npos)
+            {
+                comma = field.size();
+            }
+            const std::string item = field.substr(pos, comma - pos);
+            const size_t slash = item.find('/');
+            const std::string range = item.substr(0, slash);
+            int from = lo;
+            int to = hi;
+            int step = 1;
+            if (slash != std::string::npos && (!parseNumber(item.substr(slash + 1), step) || step == 0))
+            {
+                return false;
+            }
+            if (range != "*")
+            {
+                const size_t dash = range.find('-');
+                if (dash == std::string::npos)
+                {
+                    if (!parseNumber(range, from))
+                    {
+                        return false;
+                    }
+                    to = slash != std::string::npos ? hi : from; // "5/15" - от 5 до конца с шагом 15
+                }
+                else if (!parseNumber(range.substr(0, dash), from) || !parseNumber(range.substr(dash + 1), to))
+                {
+                    return false;
+                }
+            }
+            if (from < lo || to > hi || from > to)
+            {
+                return false;
+            }
+            for (int v = from; v <= to; v += step)
+            {
+                bits |= uint64_t(1) << v;
+            }
+            pos = comma + 1;
+        }
+        return bits != 0;
+    }
+
+    // Верхняя граница шагов поиска: у выполнимого выражения совпадение находится за сотни шагов
+    constexpr int kMaxCronSteps = 100000;
+}
+
+// ================== CronSchedule ==================
+
+bool CronSchedule::parse(const std::string &expr, CronSchedule &out)
+{
+    std::string text = expr;
+    if (text == "@hourly")
+        text = "0 * * * *";
+    else if (text == "@daily")
+        text = "0 0 * * *";
+    else if (text == "@weekly")
+        text = "0 0 * * 0";
+    else if (text == "@monthly")
+        text = "0 0 1 * *";
+
+    std::istringstream in(text);
+    std::string fields[5];
+    for (auto &field : fields)
+    {
+        if (!(in >> field))
+        {
+            return false;
+        }
+    }
+    std::string extra;
+    if (in >> extra)
+    {
+        return false;
+    }
+
+    CronSchedule cron;
+    uint64_t hours = 0, days = 0, months = 0, weekdays = 0;
+    if (!parseField(fields[0], 0, 59, cron.minutes_) || !parseField(fields[1], 0, 23, hours) ||
+        !parseField(fields[2], 1, 31, days) || !parseField(fields[3], 1, 12, months) ||
+        !parseField(fields[4], 0, 7, weekdays))
+    {
+        return false;
+    }
+    cron.hours_ = static_cast<uint32_t>(hours);
+    cron.days_ = static_cast<uint32_t>(days);
+    cron.months_ = static_cast<uint16_t>(months);
+    cron.weekdays_ = static_cast<uint8_t>((weekdays | (weekdays >> 7)) & 0x7F); // 7 - тоже воскресенье
+    cron.any_day_ = fields[2][0] == '*';
+    cron.any_weekday_ = fields[4][0] == '*';
+    out = cron;
+    return true;
+}
+
+int64_t CronSchedule::next(int64_t after) const
+{
+    std::time_t t = static_cast<std::time_t>(after - (after % 60 + 60) % 60 + 60);
+    std::tm tm{};
+    localtime_r(&t, &tm);
+    // Несовпадающее поле сдвигается на единицу с обнулением младших, mktime нормализует дату
+    // (в том числе переходы на летнее время)
+    for (int step = 0; step < kMaxCronSteps; ++step)
+    {
+        const bool day_of_month = (days_ >> tm.tm_mday) & 1;
+        const bool day_of_week = (weekdays_ >> tm.tm_wday) & 1;
+        const bool day = any_day_ || any_weekday_ ? day_of_month && day_of_week : day_of_month || day_of_week;
+        if (!((months_ >> (tm.tm_mon + 1)) & 1))
+        {
+            ++tm.tm_mon;
+            tm.tm_mday = 1;
+            tm.tm_hour = 0;
+            tm.tm_min = 0;
+        }
+        else if (!day)
+        {
+            ++tm.tm_mday;
+            tm.tm_hour = 0;
+            tm.tm_min = 0;
+        }
+        else if (!((hours_ >> tm.tm_hour) & 1))
+        {
+            ++tm.tm_hour;
+            tm.tm_min = 0;
+        }
+        else if (!((minutes_ >> tm.tm_min) & 1))
+        {
+            ++tm.tm_min;
+        }
+        else
+        {
+            return static_cast<int64_t>(t);
+        }
+        tm.tm_sec = 0;
+        tm.tm_isdst = -1;
+        t = std::mktime(&tm);
+        if (t == static_cast<std::time_t>(-1))
+        {
+            return 0;
+        }
+    }
+    return 0;
+}
+
+// ================== TimerWheel ==================
+
+void TimerWheel::reset(uint64_t now)
+{
+    for (auto &bucket : slots_)
+    {
+        bucket.clear();
+    }
+    expired_.clear();
+    current_ = now;
+}
+
+void TimerWheel::add(uint64_t id, uint64_t deadline)
+{
+    if (deadline <= current_)
+    {
+        expired_.push_back({id, deadline});
+        return;
+    }
+    place({id, deadline});
+}
+
+void TimerWheel::place(const Timer &timer)
+{
+    constexpr uint64_t kHorizon = uint64_t(1) << (kLevelBits * kLevels);
+    uint64_t delta = timer.deadline > current_ ? timer.deadline - current_ : 0;
+    uint64_t tick = timer.deadline;
+    if (delta >= kHorizon)
+    {
+        delta = kHorizon - 1;
+        tick = current_ + delta;
+    }
+    int level = 0;
+    while (level < kLevels - 1 && delta >= (uint64_t(1) << (kLevelBits * (level + 1))))
+    {
+        ++level;
+    }
+    slot(level, tick).push_back(timer);
+}
+
+void TimerWheel::advance(uint64_t now, std::vector<uint64_t> &due)
+{
+    for (const Timer &timer : expired_)
+    {
+        due.push_back(timer.id);
+    }
+    expired_.clear();
+
+    std::vector<Timer> bucket;
+    while (current_ < now)
+    {
+        ++current_;
+        // Каскад: когда младший уровень проходит через ноль, очередной слот старшего раскладывается ниже
+        for (int level = 1; level < kLevels; ++level)
+        {
+            if (current_ & ((uint64_t(1) << (kLevelBits * level)) - 1))
+            {
+                break;
+            }
+            bucket.swap(slot(level, current_));
+            for (const Timer &timer : bucket)
+            {
+                place(timer);
+            }
+            bucket.clear();
+        }
+        auto &current = slot(0, current_);
+        if (current.empty())
+        {
+            continue;
+        }
+        bucket.swap(current);
+        for (const Timer &timer : bucket)
+        {
+            if (timer.deadline <= current_)
+            {
+                due.push_back(timer.id);
+            }
+            else
+            {
+                place(timer); // таймер за горизонтом колеса
+            }
+        }
+        bucket.clear();
+    }
+}
+
+// ================== Scheduler ==================
+
+Scheduler &Scheduler::instance()
+{
+    static Scheduler instance;
+    return instance;
+}
+
+void Scheduler::registerHandler(const std::string &kind, JobHandler handler)
+{
+    std::lock_guard<std::mutex> lock(mtx_);
+    handlers_[kind] = std::move(handler);
+}
+
+bool Scheduler::scheduleCron(const std::string &name, const std::string &kind, const std::string &expr)
+{
+    CronSchedule cron;
+    const int64_t next_run = CronSchedule::parse(expr, cron) ? cron.next(unixNow()) : 0;
+    if (next_run == 0)
+    {
+        LOG(LogLevel::L_WARNING, "Scheduler: invalid cron expression '" << expr << "' for job '" << name << "'");
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mtx_);
+    Job &job = jobs_[name];
+    job.record = ScheduledJobRecord{name, kind, "", expr, next_run, 0};
+    job.cron = cron;
+    if (running_)
+    {
+        db_save_scheduled_job(job.record);
+        arm(job);
+    }
+    return true;
+}
+
+void Scheduler::scheduleAt(const std::string &name, const std::string &kind, const std::string &payload, int64_t at)
+{
+    std::lock_guard<std::mutex> lock(mtx_);
+    Job &job = jobs_[name];
+    job.record = ScheduledJobRecord{name, kind, payload, "", at, 0};
+    job.cron = CronSchedule();
+    db_save_scheduled_job(job.record);
+    arm(job);
+}
+
+void Scheduler::cancel(const std::string &name)
+{
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto it = jobs_.find(name);
+    if (it == jobs_.end())
+    {
+        return;
+    }
+    timers_.erase(it->second.timer);
+    jobs_.erase(it);
+    db_delete_scheduled_job(name);
+}
+
+size_t Scheduler::jobCount() const
+{
+    std::lock_guard<std::mutex> lock(mtx_);
+    return jobs_.size();
+}
+
+void Scheduler::start()
+{
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (running_)
+    {
+        return;
+    }
+    for (auto &stored : db_load_scheduled_jobs())
+    {
+        auto it = jobs_.find(stored.name);
+        if (stored.schedule.empty())
+        {
+            if (it == jobs_.end())
+            {
+                Job job;
+                job.record = std::move(stored);
+                jobs_.emplace(job.record.name, std::move(job));
+            }
+            continue;
+        }
+        if (it == jobs_.end())
+        {
+            LOG(LogLevel::INFO, "Scheduler: dropping job '" << stored.name << "' that is no longer registered");
+            db_delete_scheduled_job(stored.name);
+            continue;
+        }
+        // Расписание не менялось - продолжаем с сохранённого запуска (пропущенный выполнится сразу)
+        if (it->second.record.schedule == stored.schedule && it->second.record.kind == stored.kind)
+        {
+            it->second.record.next_run = stored.next_run;
+            it->second.record.last_run = stored.last_run;
+        }
+    }
+
+    wheel_.reset(static_cast<uint64_t>(unixNow()));
+    running_ = true;
+    stop_ = false;
+    for (auto &entry : jobs_)
+    {
+        if (!entry.second.record.schedule.empty())
+        {
+            db_save_scheduled_job(entry.second.record);
+        }
+        arm(entry.second);
+    }
+    thread_ = std::thread(&Scheduler::run, this);
+    LOG(LogLevel::INFO, "Scheduler started with " << jobs_.size() << " jobs");
+}
+
+void Scheduler::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (!running_)
+        {
+            return;
+        }
+        stop_ = true;
+    }
+    cv_.notify_all();
+    if (thread_.joinable())
+    {
+        thread_.join();
+    }
+    std::lock_guard<std::mutex> lock(mtx_);
+    running_ = false;
+    timers_.clear();
+    for (auto &entry : jobs_)
+    {
+        entry.second.timer = 0;
+    }
+    LOG(LogLevel::INFO, "Scheduler stopped.");
+}
+
+bool Scheduler::stopping() const
+{
+    std::lock_guard<std::mutex> lock(mtx_);
+    return stop_;
+}
+
+void Scheduler::arm(Job &job)
+{
+    if (!running_)
+    {
+        return;
+    }
+    timers_.erase(job.timer);
+    job.timer = next_timer_++;
+    timers_.emplace(job.timer, job.record.name);
+    wheel_.add(job.timer, job.record.next_run > 0 ? static_cast<uint64_t>(job.record.next_run) : 0);
+}
+
+void Scheduler::run()
+{
+    std::unique_lock<std::mutex> lock(mtx_);
+    std::vector<uint64_t> due;
+    while (!stop_)
+    {
+        // Просыпаемся на границе следующей секунды (тик колеса)
+        const std::chrono::system_clock::time_point next_tick(std::chrono::seconds(wheel_.current() + 1));
+        cv_.wait_until(lock, next_tick, [this]
+                       { return stop_; });
+        if (stop_)
+        {
+            break;
+        }
+        wheel_.advance(static_cast<uint64_t>(unixNow()), due);
+        for (uint64_t timer_id : due)
+        {
+            auto it = timers_.find(timer_id);
+            if (it == timers_.end() || stop_)
+            {
+                continue; // задача отменена или перепланирована
+            }
+            const std::string name = std::move(it->second);
+            timers_.erase(it);
+            execute(name, timer_id, lock);
+        }
+        due.clear();
+    }
+}
+
+void Scheduler::execute(const std::string &name, uint64_t timer_id, std::unique_lock<std::mutex> &lock)
+{
+    auto it = jobs_.find(name);
+    if (it == jobs_.end() || it->second.timer != timer_id)
+    {
+        return;
+    }
+    const ScheduledJobRecord record = it->second.record;
+    auto handler = handlers_.find(record.kind);
+    if (handler == handlers_.end())
+    {
+        // Задача остаётся в БД и выполнится после перезапуска, когда обработчик появится
+        LOG(LogLevel::L_WARNING, "Scheduler: no handler for job '" << name << "' of kind '" << record.kind << "'");
+        it->second.timer = 0;
+        return;
+    }
+    const JobHandler fn = handler->second;
+
+    lock.unlock();
+    const char *result = "ok";
+    {
+        ScopedLatency timer(jobDuration(record.kind));
+        try
+        {
+            fn(record.payload);
+        }
+        catch (const std::exception &e)
+        {
+            result = "error";
+            LOG(LogLevel::L_ERROR, "Scheduler: job '" << name << "' failed: " << e.what());
+        }
+    }
+    jobRuns(record.kind, result).inc();
+    lock.lock();
+
+    // Во время выполнения задачу могли отменить или поставить заново
+    it = jobs_.find(name);
+    if (it == jobs_.end() || it->second.timer != timer_id)
+    {
+        return;
+    }
+    Job &job = it->second;
+    if (job.record.schedule.empty())
+    {
+        db_delete_scheduled_job(name);
+        jobs_.erase(it);
+        return;
+    }
+    const int64_t now = unixNow();
+    job.record.last_run = now;
+    job.record.next_run = job.cron.next(now);
+    if (job.record.next_run == 0)
+    {
+        LOG(LogLevel::L_WARNING, "Scheduler: job '" << name << "' has no further runs, removing");
+        db_delete_scheduled_job(name);
+        jobs_.erase(it);
+        return;
+    }
+    db_save_scheduled_job(job.record);
+    arm(job);
+}
@@ -0,0 +1,133 @@
+#pragma once
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "database.h"
+
+// Расписание cron из пяти полей "минута час день месяц день_недели" по местному времени.
+// Поле: *, число, диапазон a-b, шаг */n или a-b/n, списки через запятую; день недели 0-7
+// (0 и 7 - воскресенье). Как в cron, если ограничены и день, и день недели, подходит любой.
+// Сокращения: @hourly, @daily, @weekly, @monthly.
+class CronSchedule
+{
+public:
+    // false - выражение не разобрано (out не изменяется)
+    static bool parse(const std::string &expr, CronSchedule &out);
+    // Первое совпадение строго позже after (unix-время); 0 - совпадений нет (например, 30 февраля)
+    int64_t next(int64_t after) const;
+
+private:
+    uint64_t minutes_ = 0;
+    uint32_t hours_ = 0;
+    uint32_t days_ = 0;     // биты 1-31
+    uint16_t months_ = 0;   // биты 1-12
+    uint8_t weekdays_ = 0;  // биты 0-6
+    bool any_day_ = true;
+    bool any_weekday_ = true;
+};
+
+/**
+ * TimerWheel - иерархическое колесо таймеров: 4 уровня по 64 слота, тик - секунда.
+ * Уровень n покрывает 64^(n+1) тиков (до ~194 суток); таймер дальше кладётся в самый
+ * дальний слот верхнего уровня и перекладывается при проходе. При переходе нижнего уровня
+ * через ноль слот следующего уровня раскладывается ниже, поэтому add и продвижение на тик
+ * стоят O(1) независимо от числа таймеров. Отмены нет: владелец игнорирует устаревшие id.
+ */
+class TimerWheel
+{
+public:
+    void reset(uint64_t now);
+    void add(uint64_t id, uint64_t deadline);
+    // Продвигает колесо до now включительно; id наступивших таймеров дописываются в due
+    void advance(uint64_t now, std::vector<uint64_t> &due);
+    uint64_t current() const { return current_; }
+
+private:
+    static constexpr int kLevelBits = 6;
+    static constexpr int kSlots = 1 << kLevelBits;
+    static constexpr int kLevels = 4;
+
+    struct Timer
+    {
+        uint64_t id;
+        uint64_t deadline;
+    };
+
+    void place(const Timer &timer);
+    std::vector<Timer> &slot(int level, uint64_t tick)
+    {
+        return slots_[level * kSlots + ((tick >> (kLevelBits * level)) & (kSlots - 1))];
+    }
+
+    std::array<std::vector<Timer>, kSlots * kLevels> slots_;
+    std::vector<Timer> expired_; // добавлены с уже наступившим сроком
+    uint64_t current_ = 0;
+};
+
+// Обработчик задачи: получает payload, сохранённый при постановке
+using JobHandler = std::function<void(const std::string &payload)>;
+
+/**
+ * Scheduler - планировщик задач бота на колесе таймеров с тиком в секунду.
+ * Повторяющаяся задача задаётся выражением cron, разовая - моментом запуска. Состояние
+ * (следующий и последний запуск, payload) хранится в таблице scheduled_jobs: после
+ * перезапуска разовые задачи восстанавливаются, а пропущенный за время простоя запуск
+ * повторяющейся выполняется один раз сразу после start(). Обработчик выбирается по kind,
+ * поэтому разовые задачи из БД исполняются кодом, зарегистрированным в текущем запуске.
+ * Задачи выполняются по очереди на потоке планировщика, параллельно потоку бота: в БД они
+ * ходят только через db_* функции (основное соединение сериализовано), длинные отчёты читают
+ * через read-only соединение, а Bot API вызывают через тот же потокобезопасный HTTP-клиент.
+ */
+class Scheduler
+{
+public:
+    static Scheduler &instance();
+
+    void registerHandler(const std::string &kind, JobHandler handler);
+    // Повторяющаяся задача (заменяет задачу с тем же именем); false - неверное выражение
+    bool scheduleCron(const std::string &name, const std::string &kind, const std::string &expr);
+    // Разовая задача на момент at (unix-время); задача с тем же именем заменяется
+    void scheduleAt(const std::string &name, const std::string &kind, const std::string &payload, int64_t at);
+    void cancel(const std::string &name);
+    size_t jobCount() const;
+
+    // Загружает состояние из БД и запускает поток; повторяющиеся задачи регистрируются до start(),
+    // сохранённые повторяющиеся задачи, которые в этом запуске не зарегистрированы, удаляются
+    void start();
+    // Останавливает поток (дожидается выполняемой задачи)
+    void stop();
+    // true после вызова stop(): длинные задачи могут прервать работу досрочно
+    bool stopping() const;
+
+private:
+    struct Job
+    {
+        ScheduledJobRecord record;
+        CronSchedule cron;
+        uint64_t timer = 0; // id в колесе; 0 - не взведена
+    };
+
+    Scheduler() = default;
+    // Ставит задачу в колесо (если поток запущен); mtx_ должен быть захвачен
+    void arm(Job &job);
+    void run();
+    // Выполняет наступившую задачу; mtx_ отпускается на время обработчика
+    void execute(const std::string &name, uint64_t timer, std::unique_lock<std::mutex> &lock);
+
+    mutable std::mutex mtx_;
+    std::condition_variable cv_;
+    std::unordered_map<std::string, JobHandler> handlers_;
+    std::unordered_map<std::string, Job> jobs_;
+    std::unordered_map<uint64_t, std::string> timers_; // взведённые таймеры -> имя задачи
+    uint64_t next_timer_ = 1;
+    TimerWheel wheel_;
+    std::thread thread_;
+    bool running_ = false;
+    bool stop_ = false;
+};
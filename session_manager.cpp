@@ -1,6 +1,9 @@
 #include "session_manager.h"
 #include "user_data_types.h"
+#include "user_data_codec.h"
 #include "super_admin.h"
+#include "logger.h"
+#include "metrics.h"
 
 SessionManager &SessionManager::instance()
 {
@@ -8,11 +11,156 @@ SessionManager &SessionManager::instance()
     return instance;
 }
 
+// ================== ГЛОБАЛЬНЫЕ ПЕРЕМЕННЫЕ ==================
+// Эти переменные остаются для совместимости с существующим кодом,
+// но фактические данные хранятся в SessionManager.
+// Определены здесь, а не в main.cpp, чтобы bot_logic линковался и в бенчмарки/bot_replay.
+UserSessionMap user_session_data;
+AdminModeMap admin_work_mode;
+
+namespace
+{
+    // Оценка памяти резидентной сессии: UserData, узлы map/LRU и строки (по размеру снимка)
+    constexpr size_t kResidentOverhead = sizeof(UserData) + 192;
+
+    Counter &cacheHits()
+    {
+        static Counter &c = MetricsRegistry::instance().counter("bot_session_cache_hits_total", "Session lookups served from memory");
+        return c;
+    }
+
+    Counter &cacheMisses()
+    {
+        static Counter &c = MetricsRegistry::instance().counter("bot_session_cache_misses_total", "Session lookups that loaded the session from the database");
+        return c;
+    }
+
+    Counter &evictions(const char *reason)
+    {
+        return MetricsRegistry::instance().counter("bot_session_evictions_total", "Sessions evicted from memory", {{"reason", reason}});
+    }
+}
+
+// ================== Residency ==================
+
+void SessionManager::touch(int64_t user_id, std::unique_lock<std::mutex> &lock)
+{
+    const auto now = std::chrono::steady_clock::now();
+    auto it = resident_.find(user_id);
+    if (it != resident_.end())
+    {
+        cacheHits().inc();
+        lru_.splice(lru_.begin(), lru_, it->second.lru);
+        it->second.last_access = now;
+        return;
+    }
+
+    // Промах: сначала ещё не записанный снимок, затем БД. mtx_ на время чтения отпускается
+    cacheMisses().inc();
+    lock.unlock();
+    SessionRecord record;
+    const bool found = findUnflushed(user_id, record) ? !record.data.empty() : db_load_session(user_id, record);
+    lock.lock();
+
+    if (resident_.count(user_id))
+    {
+        return; // загружена параллельно
+    }
+    if (found)
+    {
+        UserData &user = user_sessions_[user_id];
+        if (record.data.empty() || !decodeUserData(record.data.data(), record.data.size(), user))
+        {
+            user.state = static_cast<UserState>(record.state); // строка до миграции или повреждённый блоб
+        }
+        if (record.has_admin_mode)
+        {
+            admin_modes_[user_id] = static_cast<AdminWorkMode>(record.admin_mode);
+        }
+    }
+    lru_.push_front(user_id);
+    const size_t bytes = kResidentOverhead + record.data.size();
+    resident_.emplace(user_id, Residency{lru_.begin(), now, bytes});
+    resident_bytes_ += bytes;
+}
+
+void SessionManager::setEvictionPolicy(std::chrono::seconds idle_ttl, size_t max_bytes)
+{
+    std::lock_guard<std::mutex> lock(mtx_);
+    idle_ttl_ = idle_ttl;
+    max_bytes_ = max_bytes;
+    MetricsRegistry::instance().gaugeCallback("bot_session_memory_bytes", "Estimated memory held by resident sessions", [this]()
+                                              { return static_cast<double>(residentBytes()); });
+}
+
+size_t SessionManager::evictIdle()
+{
+    static Counter &expired = evictions("idle");
+    static Counter &over_budget = evictions("memory");
+
+    std::lock_guard<std::mutex> lock(mtx_);
+    for (int64_t user_id : removed_)
+    {
+        dropLocked(user_id);
+    }
+    removed_.clear();
+
+    const auto now = std::chrono::steady_clock::now();
+    size_t evicted = 0;
+    while (!lru_.empty())
+    {
+        const int64_t user_id = lru_.back();
+        auto it = resident_.find(user_id);
+        const bool idle = idle_ttl_.count() > 0 && now - it->second.last_access >= idle_ttl_;
+        const bool over = max_bytes_ > 0 && resident_bytes_ > max_bytes_;
+        if (!idle && !over)
+        {
+            break;
+        }
+
+        // Запись перед вытеснением: снимок уходит в очередь (неизменённый отсеется по хешу),
+        // и повторная загрузка до сброса возьмёт его оттуда
+        if (user_sessions_.count(user_id) || admin_modes_.count(user_id))
+        {
+            enqueue(snapshotLocked(user_id));
+        }
+        {
+            // Хеш нужен только резидентной сессии; без этого карта росла бы по всем пользователям
+            std::lock_guard<std::mutex> pending_lock(pending_mtx_);
+            queued_digest_.erase(user_id);
+        }
+        dropLocked(user_id);
+        (idle ? expired : over_budget).inc();
+        ++evicted;
+    }
+    return evicted;
+}
+
+void SessionManager::dropLocked(int64_t user_id)
+{
+    user_sessions_.erase(user_id);
+    admin_modes_.erase(user_id);
+    auto it = resident_.find(user_id);
+    if (it != resident_.end())
+    {
+        resident_bytes_ -= it->second.bytes;
+        lru_.erase(it->second.lru);
+        resident_.erase(it);
+    }
+}
+
+size_t SessionManager::residentBytes() const
+{
+    std::lock_guard<std::mutex> lock(mtx_);
+    return resident_bytes_;
+}
+
 // ================== User Data ==================
 
 UserData &SessionManager::getUserData(int64_t user_id)
 {
-    std::lock_guard<std::mutex> lock(mtx_);
+    std::unique_lock<std::mutex> lock(mtx_);
+    touch(user_id, lock);
     return user_sessions_[user_id];
 }
 
@@ -23,16 +171,44 @@ bool SessionManager::hasUserData(int64_t user_id) const
 }
 
 void SessionManager::removeUserData(int64_t user_id)
+{
+    {
+        // Вызывается и из HTTP API, а ссылки на UserData держит поток бота: память
+        // освобождает evictIdle между апдейтами, до этого снимки сессии не пишутся
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (resident_.count(user_id))
+        {
+            removed_.insert(user_id);
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(pending_mtx_);
+        pending_.erase(user_id);
+        queued_digest_.erase(user_id);
+        // Снимок уже пишется сбросом: пустой data удалит строку ещё раз при следующем сбросе
+        // (при откате пакета повтор не затирает более новую запись в pending_)
+        if (flushing_.count(user_id))
+        {
+            SessionRecord removal;
+            removal.user_id = user_id;
+            pending_[user_id] = std::move(removal);
+        }
+    }
+    db_delete_session(user_id);
+}
+
+size_t SessionManager::sessionCount() const
 {
     std::lock_guard<std::mutex> lock(mtx_);
-    user_sessions_.erase(user_id);
+    return user_sessions_.size();
 }
 
 // ================== Admin Mode ==================
 
-AdminWorkMode SessionManager::getAdminMode(int64_t user_id) const
+AdminWorkMode SessionManager::getAdminMode(int64_t user_id)
 {
-    std::lock_guard<std::mutex> lock(mtx_);
+    std::unique_lock<std::mutex> lock(mtx_);
+    touch(user_id, lock);
     auto it = admin_modes_.find(user_id);
     if (it != admin_modes_.end())
     {
@@ -43,16 +219,25 @@ AdminWorkMode SessionManager::getAdminMode(int64_t user_id) const
 
 void SessionManager::setAdminMode(int64_t user_id, AdminWorkMode mode)
 {
-    std::lock_guard<std::mutex> lock(mtx_);
+    std::unique_lock<std::mutex> lock(mtx_);
+    touch(user_id, lock);
     admin_modes_[user_id] = mode;
 }
 
-bool SessionManager::hasAdminMode(int64_t user_id) const
+bool SessionManager::hasAdminMode(int64_t user_id)
 {
-    std::lock_guard<std::mutex> lock(mtx_);
+    std::unique_lock<std::mutex> lock(mtx_);
+    touch(user_id, lock);
     return admin_modes_.count(user_id) > 0;
 }
 
+AdminWorkMode &SessionManager::adminModeRef(int64_t user_id)
+{
+    std::unique_lock<std::mutex> lock(mtx_);
+    touch(user_id, lock);
+    return admin_modes_[user_id];
+}
+
 // ================== OTP ==================
 
 std::string SessionManager::getOtp(int64_t user_id) const
@@ -61,7 +246,7 @@ std::string SessionManager::getOtp(int64_t user_id) const
     auto it = admin_otps_.find(user_id);
     if (it != admin_otps_.end())
     {
-        return it->second;
+        return it->second.code;
     }
     return "";
 }
@@ -69,7 +254,7 @@ std::string SessionManager::getOtp(int64_t user_id) const
 void SessionManager::setOtp(int64_t user_id, const std::string &otp)
 {
     std::lock_guard<std::mutex> lock(mtx_);
-    admin_otps_[user_id] = otp;
+    admin_otps_[user_id] = IssuedOtp{otp, std::chrono::steady_clock::now()};
 }
 
 bool SessionManager::hasOtp(int64_t user_id) const
@@ -84,14 +269,208 @@ void SessionManager::removeOtp(int64_t user_id)
     admin_otps_.erase(user_id);
 }
 
-// ================== Bulk Access (для загрузки из БД) ==================
+// Повторно выданный пароль моложе ttl не трогается: его срок считает своя задача
+bool SessionManager::expireOtp(int64_t user_id, std::chrono::seconds ttl)
+{
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto it = admin_otps_.find(user_id);
+    if (it == admin_otps_.end() || std::chrono::steady_clock::now() - it->second.issued < ttl)
+    {
+        return false;
+    }
+    admin_otps_.erase(it);
+    return true;
+}
+
+// ================== Write-behind ==================
+
+namespace
+{
+    uint64_t recordDigest(const SessionRecord &record)
+    {
+        uint64_t h = 1469598103934665603ULL;
+        auto mix = [&h](const void *data, size_t size)
+        {
+            const unsigned char *p = static_cast<const unsigned char *>(data);
+            for (size_t i = 0; i < size; ++i)
+            {
+                h ^= p[i];
+                h *= 1099511628211ULL;
+            }
+        };
+        mix(&record.state, sizeof(record.state));
+        const int admin_mode = record.has_admin_mode ? record.admin_mode : -1;
+        mix(&admin_mode, sizeof(admin_mode));
+        mix(record.data.data(), record.data.size());
+        return h;
+    }
+}
+
+SessionRecord SessionManager::snapshotLocked(int64_t user_id) const
+{
+    SessionRecord record;
+    record.user_id = user_id;
+    auto session = user_sessions_.find(user_id);
+    const UserData empty{};
+    const UserData &user = session != user_sessions_.end() ? session->second : empty;
+    record.state = static_cast<int>(user.state);
+    record.data = encodeUserData(user);
+    auto mode = admin_modes_.find(user_id);
+    if (mode != admin_modes_.end())
+    {
+        record.has_admin_mode = true;
+        record.admin_mode = static_cast<int>(mode->second);
+    }
+    return record;
+}
 
-std::map<int64_t, UserData> &SessionManager::getAllUserSessions()
+void SessionManager::markDirty(int64_t user_id)
 {
-    return user_sessions_;
+    SessionRecord record;
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (removed_.count(user_id) || (!user_sessions_.count(user_id) && !admin_modes_.count(user_id)))
+        {
+            return;
+        }
+        record = snapshotLocked(user_id);
+        // Оценка памяти уточняется по размеру свежего снимка
+        auto it = resident_.find(user_id);
+        if (it != resident_.end())
+        {
+            const size_t bytes = kResidentOverhead + record.data.size();
+            resident_bytes_ = resident_bytes_ - it->second.bytes + bytes;
+            it->second.bytes = bytes;
+        }
+    }
+    enqueue(std::move(record));
+}
+
+bool SessionManager::findUnflushed(int64_t user_id, SessionRecord &record) const
+{
+    std::lock_guard<std::mutex> lock(pending_mtx_);
+    auto it = pending_.find(user_id);
+    if (it == pending_.end())
+    {
+        it = flushing_.find(user_id);
+        if (it == flushing_.end())
+        {
+            return false;
+        }
+    }
+    record = it->second;
+    return true;
+}
+
+void SessionManager::enqueue(SessionRecord record)
+{
+    const uint64_t digest = recordDigest(record);
+    {
+        std::lock_guard<std::mutex> lock(pending_mtx_);
+        // Снимок не изменился с последней постановки в очередь - уже записан или ждёт записи
+        auto queued = queued_digest_.find(record.user_id);
+        if (queued != queued_digest_.end() && queued->second == digest)
+        {
+            return;
+        }
+        if (record.data.empty())
+        {
+            queued_digest_.erase(record.user_id);
+        }
+        else
+        {
+            queued_digest_[record.user_id] = digest;
+        }
+        if (write_behind_running_.load(std::memory_order_acquire))
+        {
+            pending_[record.user_id] = std::move(record);
+            return;
+        }
+    }
+    db_save_sessions({record});
+}
+
+size_t SessionManager::flushDirty()
+{
+    static Counter &failures = MetricsRegistry::instance().counter("bot_session_flush_failures_total", "Write-behind session flushes rolled back and re-queued");
+    std::vector<SessionRecord> batch;
+    {
+        std::lock_guard<std::mutex> lock(pending_mtx_);
+        if (pending_.empty())
+        {
+            return 0;
+        }
+        // Пакет остаётся виден загрузке сессий, пока не закоммичен
+        flushing_.swap(pending_);
+        batch.reserve(flushing_.size());
+        for (const auto &entry : flushing_)
+        {
+            batch.push_back(entry.second);
+        }
+    }
+
+    const bool saved = db_save_sessions(batch);
+
+    std::lock_guard<std::mutex> lock(pending_mtx_);
+    if (!saved)
+    {
+        // Повтор при следующем сбросе; более новые снимки, поставленные за это время, не затираются
+        failures.inc();
+        for (auto &entry : flushing_)
+        {
+            pending_.emplace(entry.first, std::move(entry.second));
+        }
+    }
+    flushing_.clear();
+    return saved ? batch.size() : 0;
+}
+
+void SessionManager::startWriteBehind(std::chrono::milliseconds interval)
+{
+    if (write_behind_running_.exchange(true))
+    {
+        return;
+    }
+    MetricsRegistry::instance().gaugeCallback("bot_sessions_dirty", "Sessions waiting for the write-behind flush", [this]()
+                                              { return static_cast<double>(dirtyCount()); });
+    {
+        std::lock_guard<std::mutex> lock(pending_mtx_);
+        stop_flusher_ = false;
+    }
+    flusher_ = std::thread([this, interval]()
+                           {
+                               std::unique_lock<std::mutex> lock(pending_mtx_);
+                               while (!stop_flusher_)
+                               {
+                                   flush_cv_.wait_for(lock, interval, [this]()
+                                                      { return stop_flusher_; });
+                                   lock.unlock();
+                                   flushDirty();
+                                   lock.lock();
+                               }
+                           });
+    LOG(LogLevel::INFO, "Session write-behind started, flush interval " << interval.count() << " ms.");
+}
+
+void SessionManager::stopWriteBehind()
+{
+    if (!write_behind_running_.load())
+    {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(pending_mtx_);
+        stop_flusher_ = true;
+    }
+    flush_cv_.notify_all();
+    flusher_.join();
+    write_behind_running_.store(false, std::memory_order_release);
+    size_t flushed = flushDirty();
+    LOG(LogLevel::INFO, "Session write-behind stopped, final flush wrote " << flushed << " sessions.");
 }
 
-std::map<int64_t, AdminWorkMode> &SessionManager::getAllAdminModes()
+size_t SessionManager::dirtyCount() const
 {
-    return admin_modes_;
+    std::lock_guard<std::mutex> lock(pending_mtx_);
+    return pending_.size();
 }
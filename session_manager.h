@@ -3,6 +3,14 @@
 #include <string>
 #include <cstdint>
 #include <mutex>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <list>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include "database.h"
 
 // Forward declarations
 struct UserData;
@@ -10,7 +18,15 @@ enum class AdminWorkMode;
 
 /**
  * SessionManager - Singleton для управления сессиями пользователей
- * Инкапсулирует глобальные переменные: user_session_data, admin_work_mode, admin_otps
+ * Инкапсулирует глобальные переменные user_session_data, admin_work_mode и OTP админов
+ *
+ * В памяти держится только рабочее множество: сессия (UserData и режим админа)
+ * подгружается из БД при первом обращении и вытесняется evictIdle() по простою
+ * дольше idle_ttl или, в порядке LRU, при превышении бюджета памяти. Перед
+ * вытеснением снимок ставится в очередь write-behind, а загрузка сначала смотрит
+ * в эту очередь, поэтому ещё не записанные изменения не теряются.
+ * Ссылки на UserData/AdminWorkMode живут до evictIdle(), которую вызывает поток
+ * бота между апдейтами.
  */
 class SessionManager
 {
@@ -20,33 +36,112 @@ public:
     // Управление данными пользователей
     UserData &getUserData(int64_t user_id);
     bool hasUserData(int64_t user_id) const;
+    // Отменяет незаписанный снимок, удаляет строку sessions и (на ближайшем evictIdle) сессию
+    // и режим из памяти; сессию удаляют только здесь, иначе write-behind вернёт строку
     void removeUserData(int64_t user_id);
+    size_t sessionCount() const;
 
     // Управление режимами работы админов
-    AdminWorkMode getAdminMode(int64_t user_id) const;
+    AdminWorkMode getAdminMode(int64_t user_id);
     void setAdminMode(int64_t user_id, AdminWorkMode mode);
-    bool hasAdminMode(int64_t user_id) const;
+    bool hasAdminMode(int64_t user_id);
 
     // Управление OTP для админов
     std::string getOtp(int64_t user_id) const;
     void setOtp(int64_t user_id, const std::string &otp);
     bool hasOtp(int64_t user_id) const;
     void removeOtp(int64_t user_id);
+    // Удаляет OTP, выданный не меньше ttl назад; true - пароль удалён
+    bool expireOtp(int64_t user_id, std::chrono::seconds ttl);
 
-    // Загрузка/сохранение состояний (для интеграции с БД)
-    std::map<int64_t, UserData> &getAllUserSessions();
-    std::map<int64_t, AdminWorkMode> &getAllAdminModes();
+    // Режим админа по ссылке (создаётся UNKNOWN) - для кода, меняющего его на месте
+    AdminWorkMode &adminModeRef(int64_t user_id);
+
+    // Вытеснение: max_bytes == 0 - без бюджета памяти, idle_ttl == 0 - без TTL
+    void setEvictionPolicy(std::chrono::seconds idle_ttl, size_t max_bytes);
+    // Вытесняет простаивающие сессии и сессии сверх бюджета; возвращает их число
+    size_t evictIdle();
+    size_t residentBytes() const;
+
+    // Отложенная запись (write-behind). markDirty снимает копию сессии и режима админа
+    // на вызывающем потоке (UserData меняется только потоком бота) и ставит её в очередь,
+    // если она отличается от последней записанной. Фоновый поток пишет очередь в БД
+    // одной транзакцией раз в interval. Без запущенного потока снимок пишется сразу.
+    void markDirty(int64_t user_id);
+    void startWriteBehind(std::chrono::milliseconds interval);
+    // Останавливает поток и записывает всё, что осталось в очереди
+    void stopWriteBehind();
+    // Записывает очередь сейчас; возвращает число записанных сессий
+    size_t flushDirty();
+    size_t dirtyCount() const;
 
 private:
     SessionManager() = default;
     ~SessionManager() = default;
 
+    // Ставит снимок в очередь (или пишет сразу, если поток не запущен)
+    void enqueue(SessionRecord record);
+    // Делает сессию резидентной (при промахе - загрузка из очереди записи или БД)
+    // и отмечает обращение в LRU; lock держит mtx_ и может временно отпускаться
+    void touch(int64_t user_id, std::unique_lock<std::mutex> &lock);
+    // Снимок сессии для записи; mtx_ должен быть захвачен
+    SessionRecord snapshotLocked(int64_t user_id) const;
+    // Убирает сессию из памяти без записи; mtx_ должен быть захвачен
+    void dropLocked(int64_t user_id);
+    // Последний не записанный в БД снимок (в очереди или в записываемом пакете)
+    bool findUnflushed(int64_t user_id, SessionRecord &record) const;
+
     SessionManager(const SessionManager &) = delete;
     SessionManager &operator=(const SessionManager &) = delete;
 
     std::map<int64_t, UserData> user_sessions_;
     std::map<int64_t, AdminWorkMode> admin_modes_;
-    std::map<int64_t, std::string> admin_otps_;
+    struct IssuedOtp
+    {
+        std::string code;
+        std::chrono::steady_clock::time_point issued;
+    };
+    std::map<int64_t, IssuedOtp> admin_otps_;
 
     mutable std::mutex mtx_;
+
+    // Резидентные сессии: список LRU (в начале - недавние) и учёт памяти
+    struct Residency
+    {
+        std::list<int64_t>::iterator lru;
+        std::chrono::steady_clock::time_point last_access;
+        size_t bytes;
+    };
+    std::list<int64_t> lru_;
+    std::unordered_map<int64_t, Residency> resident_;
+    std::unordered_set<int64_t> removed_; // удалены removeUserData, память освободит evictIdle
+    size_t resident_bytes_ = 0;
+    std::chrono::seconds idle_ttl_{0};
+    size_t max_bytes_ = 0;
+
+    // Очередь write-behind: последний снимок на пользователя и хеш последнего поставленного
+    // (хеш хранится, пока сессия резидентна)
+    mutable std::mutex pending_mtx_;
+    std::unordered_map<int64_t, SessionRecord> pending_;
+    std::unordered_map<int64_t, SessionRecord> flushing_; // пакет, который пишется сейчас
+    std::unordered_map<int64_t, uint64_t> queued_digest_;
+    std::condition_variable flush_cv_;
+    std::thread flusher_;
+    std::atomic<bool> write_behind_running_{false};
+    bool stop_flusher_ = false;
+};
+
+// Обёртки глобальных user_session_data / admin_work_mode с интерфейсом прежних std::map:
+// каждое обращение идёт через SessionManager (ленивая загрузка, учёт LRU)
+class UserSessionMap
+{
+public:
+    UserData &operator[](int64_t user_id) { return SessionManager::instance().getUserData(user_id); }
+};
+
+class AdminModeMap
+{
+public:
+    AdminWorkMode &operator[](int64_t user_id) { return SessionManager::instance().adminModeRef(user_id); }
+    size_t count(int64_t user_id) const { return SessionManager::instance().hasAdminMode(user_id) ? 1 : 0; }
 };
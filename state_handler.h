@@ -1,12 +1,8 @@
 #pragma once
 #include <tgbot/tgbot.h>
+#include <array>
 #include <memory>
-#include <unordered_map>
-#include <functional>
-
-// Forward declarations
-struct UserData;
-enum class UserState;
+#include "user_data_types.h"
 
 /**
  * IStateHandler - базовый интерфейс для обработчиков состояний
@@ -38,34 +34,46 @@ public:
 
 /**
  * StateHandlerRegistry - реестр обработчиков состояний (Singleton)
+ * Таблица std::array, индексируемая UserState, заполняется один раз при первом обращении
+ * (registerStateHandlers) и дальше не меняется: чтение из любых потоков без блокировок,
+ * обработчики отдаются простыми указателями без счётчиков ссылок.
  */
 class StateHandlerRegistry
 {
 public:
-    using HandlerPtr = std::shared_ptr<IStateHandler>;
-    using HandlerFactory = std::function<HandlerPtr()>;
+    using Handlers = std::array<std::unique_ptr<IStateHandler>, kUserStateCount>;
+
+    // Заполнение таблицы; доступно только на время построения реестра
+    class Builder
+    {
+    public:
+        template <typename Handler>
+        void add(UserState state)
+        {
+            handlers_[static_cast<size_t>(state)] = std::make_unique<Handler>();
+        }
 
-    static StateHandlerRegistry &instance();
+    private:
+        friend class StateHandlerRegistry;
+        explicit Builder(Handlers &handlers) : handlers_(handlers) {}
+        Handlers &handlers_;
+    };
 
-    void registerHandler(UserState state, HandlerFactory factory);
-    HandlerPtr getHandler(UserState state);
-    bool hasHandler(UserState state) const;
+    static const StateHandlerRegistry &instance();
+
+    // nullptr, если у состояния нет обработчика
+    IStateHandler *getHandler(UserState state) const
+    {
+        const size_t index = static_cast<size_t>(state);
+        return index < handlers_.size() ? handlers_[index].get() : nullptr;
+    }
+    bool hasHandler(UserState state) const { return getHandler(state) != nullptr; }
 
 private:
-    StateHandlerRegistry() = default;
-    std::unordered_map<int, HandlerFactory> factories_;
-    std::unordered_map<int, HandlerPtr> handlers_; // кеш
+    StateHandlerRegistry();
+    Handlers handlers_;
 };
 
-// Макрос для регистрации обработчиков
-#define REGISTER_STATE_HANDLER(state, handler_class)                                                                         \
-    namespace                                                                                                                \
-    {                                                                                                                        \
-        struct handler_class##_Registrar                                                                                     \
-        {                                                                                                                    \
-            handler_class##_Registrar()                                                                                      \
-            {                                                                                                                \
-                StateHandlerRegistry::instance().registerHandler(state, []() { return std::make_shared<handler_class>(); }); \
-            }                                                                                                                \
-        } handler_class##_registrar_instance;                                                                                \
-    }
+// Регистрирует все обработчики (handler_registration.cpp). Вызывается из конструктора
+// реестра, поэтому объектный файл с обработчиками всегда попадает в сборку из bot_logic.
+void registerStateHandlers(StateHandlerRegistry::Builder &builder);
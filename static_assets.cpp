@@ -0,0 +1,219 @@
+#include "static_assets.h"
+#include "http_compression.h"
+#include "logger.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    std::string contentHash(const std::string &body)
+    {
+        uint64_t h = 1469598103934665603ULL;
+        for (unsigned char c : body)
+        {
+            h ^= c;
+            h *= 1099511628211ULL;
+        }
+        char buf[17];
+        std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(h));
+        return buf;
+    }
+
+    bool endsWith(const std::string &s, const char *suffix)
+    {
+        const size_t n = std::char_traits<char>::length(suffix);
+        return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+    }
+
+    // Хеш, ETag и gzip-вариант по текущему body
+    void finalize(StaticAsset &asset)
+    {
+        asset.hash = contentHash(asset.body);
+        asset.etag = "\"" + asset.hash + "\"";
+        asset.gzip_body.clear();
+        if (isCompressibleContentType(asset.content_type))
+        {
+            std::string gz = compressBody(asset.body, ContentCoding::Gzip);
+            if (!gz.empty() && gz.size() < asset.body.size())
+            {
+                asset.gzip_body = std::move(gz);
+            }
+        }
+    }
+
+    // "admin/" + "../css/a.css" -> "css/a.css"; "" при выходе за корень
+    std::string resolveRelative(const std::string &base_dir, const std::string &ref)
+    {
+        std::vector<std::string> parts;
+        std::string combined = base_dir + ref;
+        size_t pos = 0;
+        while (pos <= combined.size())
+        {
+            size_t slash = combined.find('/', pos);
+            if (slash == std::string::npos)
+            {
+                slash = combined.size();
+            }
+            std::string part = combined.substr(pos, slash - pos);
+            pos = slash + 1;
+            if (part.empty() || part == ".")
+            {
+                continue;
+            }
+            if (part == "..")
+            {
+                if (parts.empty())
+                {
+                    return "";
+                }
+                parts.pop_back();
+                continue;
+            }
+            parts.push_back(std::move(part));
+        }
+        std::string result;
+        for (const auto &part : parts)
+        {
+            if (!result.empty())
+            {
+                result += '/';
+            }
+            result += part;
+        }
+        return result;
+    }
+}
+
+std::string StaticAssets::contentTypeFor(const std::string &path)
+{
+    static const std::pair<const char *, const char *> kTypes[] = {
+        {".html", "text/html; charset=utf-8"},
+        {".css", "text/css; charset=utf-8"},
+        {".js", "application/javascript"},
+        {".json", "application/json"},
+        {".svg", "image/svg+xml"},
+        {".png", "image/png"},
+        {".jpg", "image/jpeg"},
+        {".jpeg", "image/jpeg"},
+        {".gif", "image/gif"},
+        {".webp", "image/webp"},
+        {".ico", "image/x-icon"},
+        {".woff2", "font/woff2"},
+        {".webmanifest", "application/manifest+json"},
+        {".txt", "text/plain; charset=utf-8"},
+    };
+    for (const auto &type : kTypes)
+    {
+        if (endsWith(path, type.first))
+        {
+            return type.second;
+        }
+    }
+    return "application/octet-stream";
+}
+
+bool StaticAssets::load(const std::string &root)
+{
+    std::error_code ec;
+    if (!fs::is_directory(root, ec))
+    {
+        LOG(LogLevel::L_ERROR, "Static files root not found: " << root);
+        return false;
+    }
+
+    size_t total_bytes = 0;
+    size_t gzip_bytes = 0;
+    for (fs::recursive_directory_iterator it(root, ec), end; !ec && it != end; it.increment(ec))
+    {
+        if (!it->is_regular_file())
+        {
+            continue;
+        }
+        std::ifstream file(it->path(), std::ios::binary);
+        if (!file)
+        {
+            LOG(LogLevel::L_WARNING, "Cannot read static file: " << it->path().string());
+            continue;
+        }
+        std::ostringstream content;
+        content << file.rdbuf();
+
+        auto asset = std::make_shared<StaticAsset>();
+        const std::string path = it->path().lexically_relative(root).generic_string();
+        asset->body = content.str();
+        asset->content_type = contentTypeFor(path);
+        finalize(*asset);
+        assets_[path] = std::move(asset);
+    }
+
+    // Хеши ресурсов известны только после загрузки всех файлов, поэтому HTML дописывается вторым проходом
+    for (auto &entry : assets_)
+    {
+        if (endsWith(entry.first, ".html"))
+        {
+            entry.second->body = versionLinks(entry.first, entry.second->body);
+            finalize(*entry.second);
+        }
+        total_bytes += entry.second->body.size();
+        gzip_bytes += entry.second->gzip_body.empty() ? entry.second->body.size() : entry.second->gzip_body.size();
+    }
+
+    LOG(LogLevel::INFO, "Static files loaded from " << root << ": " << assets_.size() << " files, "
+                                                    << total_bytes << " bytes (" << gzip_bytes << " gzip)");
+    return true;
+}
+
+std::shared_ptr<const StaticAsset> StaticAssets::find(const std::string &path) const
+{
+    auto it = assets_.find(path);
+    return it == assets_.end() ? nullptr : it->second;
+}
+
+std::string StaticAssets::versionLinks(const std::string &html_path, const std::string &html) const
+{
+    const size_t slash = html_path.rfind('/');
+    const std::string base_dir = slash == std::string::npos ? "" : html_path.substr(0, slash + 1);
+
+    std::string out;
+    out.reserve(html.size() + 256);
+    size_t pos = 0;
+    while (pos < html.size())
+    {
+        size_t src = html.find("src=\"", pos);
+        size_t href = html.find("href=\"", pos);
+        size_t attr = std::min(src, href);
+        if (attr == std::string::npos)
+        {
+            break;
+        }
+        const size_t value_begin = attr + (attr == src ? 5 : 6);
+        const size_t value_end = html.find('"', value_begin);
+        if (value_end == std::string::npos)
+        {
+            break;
+        }
+        out.append(html, pos, value_end - pos);
+        pos = value_end;
+
+        // Только относительные ссылки без схемы, запроса и якоря
+        const std::string ref = html.substr(value_begin, value_end - value_begin);
+        if (ref.empty() || ref[0] == '/' || ref[0] == '#' || ref.find_first_of(":?#") != std::string::npos)
+        {
+            continue;
+        }
+        auto target = find(resolveRelative(base_dir, ref));
+        if (target)
+        {
+            out += "?v=";
+            out += target->hash;
+        }
+    }
+    out.append(html, pos, std::string::npos);
+    return out;
+}
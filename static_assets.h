@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <string>
+
+// Файл веб-приложения, загруженный в память вместе со сжатым вариантом
+struct StaticAsset
+{
+    std::string body;
+    std::string gzip_body; // пусто, если тип не сжимается или сжатие не дало выигрыша
+    std::string content_type;
+    std::string hash; // 16 hex-символов FNV-64 содержимого: ETag и параметр ?v= в ссылках
+    std::string etag; // сильный ETag в кавычках: "<hash>"
+};
+
+/**
+ * StaticAssets - каталог webapp/, целиком загруженный в память при старте HTTP-сервера.
+ * Для каждого файла заранее считаются gzip-вариант и хеш содержимого. Локальные ссылки
+ * src/href в HTML дополняются "?v=<hash>", поэтому JS/CSS можно кешировать надолго:
+ * после изменения файла у него меняется URL. После load() набор не меняется.
+ */
+class StaticAssets
+{
+public:
+    // Читает все файлы каталога root рекурсивно; false, если каталог не найден
+    bool load(const std::string &root);
+
+    // Файл по относительному пути ("index.html", "admin/js/admin.js"); nullptr, если нет
+    std::shared_ptr<const StaticAsset> find(const std::string &path) const;
+
+    size_t size() const { return assets_.size(); }
+
+    static std::string contentTypeFor(const std::string &path);
+
+private:
+    // Добавляет ?v=<hash> к локальным src/href HTML-файла, ссылающимся на загруженные файлы
+    std::string versionLinks(const std::string &html_path, const std::string &html) const;
+
+    std::map<std::string, std::shared_ptr<StaticAsset>> assets_;
+};
@@ -3,36 +3,20 @@
 #include "admin_panel.h"
 #include "config.h"
 #include "database.h"
+#include "session_manager.h"
 #include "application_flow.h"
 #include "logger.h"
 #include "trade_points.h"
 #include "user_data_types.h"
+#include "tracing.h"
+#include "report_export.h"
 #include <sstream>
 #include <random>
 #include <chrono>
 #include <stdexcept>
 
-class Timer {
-public:
-    Timer(TgBot::Bot& bot, int64_t chat_id) : bot_(bot), chat_id_(chat_id), start_(std::chrono::high_resolution_clock::now()) {}
-    ~Timer() {
-        auto end = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<double> diff = end - start_;
-        std::stringstream ss;
-        ss.precision(3);
-        ss << "Операция выполнена за " << std::fixed << diff.count() << " сек.";
-        LOG(LogLevel::INFO, "Timer for chat_id " << chat_id_ << ": " << ss.str());
-        bot_.getApi().sendMessage(chat_id_, ss.str());
-    }
-private:
-    TgBot::Bot& bot_;
-    int64_t chat_id_;
-    std::chrono::time_point<std::chrono::high_resolution_clock> start_;
-};
-
 void sendSuperAdminPanel(TgBot::Bot& bot, int64_t chat_id) {
     admin_work_mode[chat_id] = AdminWorkMode::ADMIN_VIEW;
-    db_save_admin_work_mode(chat_id, AdminWorkMode::ADMIN_VIEW);
     
     auto keyboard = std::make_shared<TgBot::ReplyKeyboardMarkup>();
     keyboard->resizeKeyboard = true;
@@ -51,7 +35,6 @@ void sendSuperAdminPanel(TgBot::Bot& bot, int64_t chat_id) {
 
 void sendAdminApprovalList(TgBot::Bot& bot, int64_t chat_id) {
     admin_work_mode[chat_id] = AdminWorkMode::APPROVING_ADMINS;
-    db_save_admin_work_mode(chat_id, AdminWorkMode::APPROVING_ADMINS);
     std::vector<AdminRequestData> requests = db_get_pending_admin_requests();
 
     auto keyboard = std::make_shared<TgBot::ReplyKeyboardMarkup>();
@@ -93,7 +76,6 @@ void sendAdminApprovalList(TgBot::Bot& bot, int64_t chat_id) {
 
 void sendAdminManagementPanel(TgBot::Bot& bot, int64_t chat_id) {
     admin_work_mode[chat_id] = AdminWorkMode::SA_MANAGE_ADMINS;
-    db_save_admin_work_mode(chat_id, AdminWorkMode::SA_MANAGE_ADMINS);
 
     std::vector<AdminRequestData> admins = db_get_all_admins();
     std::stringstream ss;
@@ -163,7 +145,6 @@ void sendTradePointSelectionForNewAdmin(TgBot::Bot& bot, int64_t chat_id) {
 
 void sendAllApplicationsOverview(TgBot::Bot& bot, int64_t chat_id) {
     admin_work_mode[chat_id] = AdminWorkMode::SA_AWAITING_TP_FOR_VIEW;
-    db_save_admin_work_mode(chat_id, AdminWorkMode::SA_AWAITING_TP_FOR_VIEW);
 
     std::vector<std::string> codes = get_all_trade_point_codes();
     if (codes.empty()) {
@@ -188,6 +169,11 @@ void sendAllApplicationsOverview(TgBot::Bot& bot, int64_t chat_id) {
         }
     }
 
+    auto export_btn = std::make_shared<TgBot::InlineKeyboardButton>();
+    export_btn->text = "📦 Выгрузить все точки";
+    export_btn->callbackData = "sa_export_all";
+    keyboard->inlineKeyboard.push_back({export_btn});
+
     auto back_btn = std::make_shared<TgBot::InlineKeyboardButton>();
     back_btn->text = "⬅️ Назад в панель ГА";
     back_btn->callbackData = "sa_back_to_panel";
@@ -200,6 +186,7 @@ void sendAllApplicationsOverview(TgBot::Bot& bot, int64_t chat_id) {
 
 
 void handle_super_admin_message(TgBot::Bot& bot, TgBot::Message::Ptr message) {
+    TRACE_SPAN("handler", __func__);
     int64_t chat_id = message->chat->id;
     const std::string& text = message->text;
     AdminWorkMode& current_mode = admin_work_mode[chat_id];
@@ -250,14 +237,11 @@ void handle_super_admin_message(TgBot::Bot& bot, TgBot::Message::Ptr message) {
         case AdminWorkMode::SA_MANAGE_ADMINS:
             if (text == "➕ Добавить админа") {
                 user_session_data[chat_id].state = UserState::AWAITING_ADMIN_TRADE_POINT_CHOICE;
-                db_save_user_state(chat_id, user_session_data[chat_id].state);
                 sendTradePointSelectionForNewAdmin(bot, chat_id);
                 current_mode = AdminWorkMode::SA_AWAITING_ADD_TP;
-                db_save_admin_work_mode(chat_id, current_mode);
                 LOG(LogLevel::INFO, "Super admin (ID: " << chat_id << ") started adding new admin.");
             } else if (text == "➖ Удалить админа") {
                 current_mode = AdminWorkMode::SA_AWAITING_DELETE_ID;
-                db_save_admin_work_mode(chat_id, current_mode);
                 bot.getApi().sendMessage(chat_id, "Введите User ID администратора для удаления:");
                 LOG(LogLevel::INFO, "Super admin (ID: " << chat_id << ") started deleting admin.");
             }
@@ -335,8 +319,8 @@ void handle_super_admin_message(TgBot::Bot& bot, TgBot::Message::Ptr message) {
 
                 db_delete_admin(admin_to_delete);
 
-                user_session_data.erase(admin_to_delete);
-                admin_work_mode.erase(admin_to_delete);
+                // Удаляет и сессию, и режим, в том числе строку sessions в БД
+                SessionManager::instance().removeUserData(admin_to_delete);
 
                 bot.getApi().sendMessage(chat_id, "✅ Администратор (ID: " + text + ") полностью удален.");
                 sendAdminManagementPanel(bot, chat_id);
@@ -357,6 +341,7 @@ void handle_super_admin_message(TgBot::Bot& bot, TgBot::Message::Ptr message) {
 }
 
 void handle_super_admin_callbacks(TgBot::Bot& bot, TgBot::CallbackQuery::Ptr query) {
+    TRACE_SPAN("handler", __func__);
     int64_t chat_id = query->message->chat->id;
     std::string callback_data = query->data;
     AdminWorkMode& current_mode = admin_work_mode[chat_id];
@@ -424,7 +409,6 @@ void handle_super_admin_callbacks(TgBot::Bot& bot, TgBot::CallbackQuery::Ptr que
             std::string selected_trade_point = callback_data.substr(std::string("add_admin_tp_select_").length());
             user_session_data[chat_id].temp_trade_point_code = selected_trade_point;
             current_mode = AdminWorkMode::SA_AWAITING_ADD_ID;
-            db_save_admin_work_mode(chat_id, current_mode);
             bot.getApi().answerCallbackQuery(query->id, "Выбрана точка: " + selected_trade_point);
             bot.getApi().sendMessage(chat_id, "Выбрана торговая точка: *" + selected_trade_point + "*. Теперь введите User ID нового администратора:", false, 0, nullptr, "Markdown");
             LOG(LogLevel::INFO, "Super admin (ID: " << chat_id << ") selected TP " << selected_trade_point << " for new admin.");
@@ -443,7 +427,6 @@ void handle_super_admin_callbacks(TgBot::Bot& bot, TgBot::CallbackQuery::Ptr que
             sendApplicationsForReview(bot, chat_id, trade_point);
 
             admin_work_mode[chat_id] = AdminWorkMode::ADMIN_VIEW;
-            db_save_admin_work_mode(chat_id, AdminWorkMode::ADMIN_VIEW);
 
             LOG(LogLevel::INFO, "Super admin (ID: " << chat_id << ") viewed applications for TP: " << trade_point);
         } else {
@@ -452,6 +435,26 @@ void handle_super_admin_callbacks(TgBot::Bot& bot, TgBot::CallbackQuery::Ptr que
         return;
     }
 
+    if (callback_data == "sa_export_all") {
+        if (chat_id != config.main_admin_id) {
+            bot.getApi().answerCallbackQuery(query->id, "Недостаточно прав.", true);
+            return;
+        }
+        bot.getApi().answerCallbackQuery(query->id);
+        std::vector<std::string> codes = get_all_trade_point_codes();
+        if (codes.empty()) {
+            bot.getApi().sendMessage(chat_id, "В базе нет ни одной торговой точки. Нечего выгружать.");
+            return;
+        }
+        // Выгрузка идёт в фоне: здесь только сообщение с прогрессом и запуск задачи
+        auto progress = bot.getApi().sendMessage(chat_id, "📦 Выгрузка всех точек: 0 из " + std::to_string(codes.size()) + "...");
+        if (!ReportExporter::instance().exportAll(bot, chat_id, progress->messageId, std::move(codes))) {
+            bot.getApi().editMessageText("Предыдущая выгрузка ещё не закончилась, дождитесь архива.", chat_id, progress->messageId);
+        }
+        LOG(LogLevel::INFO, "Super admin (ID: " << chat_id << ") started export of all trade points.");
+        return;
+    }
+
     if (callback_data == "sa_back_to_panel") {
         bot.getApi().answerCallbackQuery(query->id);
         sendSuperAdminPanel(bot, chat_id);
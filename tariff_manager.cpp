@@ -3,9 +3,28 @@
 #include <fstream>
 #include <nlohmann/json.hpp>
 #include <algorithm>
+#include <atomic>
 #include <set>
 
-std::vector<TariffPlan> tariff_plans;
+static std::atomic<uint64_t> tariff_catalog_version{0};
+static std::shared_ptr<const TariffCatalog> tariff_catalog = std::make_shared<TariffCatalog>();
+
+uint64_t get_tariff_catalog_version() {
+    return tariff_catalog_version.load(std::memory_order_acquire);
+}
+
+std::shared_ptr<const TariffCatalog> get_tariff_catalog() {
+    return std::atomic_load(&tariff_catalog);
+}
+
+int TariffCatalog::find(const std::string& id) const {
+    for (size_t i = 0; i < plans.size(); ++i) {
+        if (plans[i].id == id) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
 
 void load_tariff_plans(const std::string& filename) {
     std::ifstream file(filename);
@@ -22,7 +41,7 @@ void load_tariff_plans(const std::string& filename) {
             return;
         }
 
-        tariff_plans.clear();
+        std::vector<TariffPlan> plans;
 
         for (const auto& tariff_json : root) {
             TariffPlan tariff;
@@ -59,9 +78,16 @@ void load_tariff_plans(const std::string& filename) {
                 tariff.speeds.push_back(speed_option);
             }
             LOG(LogLevel::INFO, "Parsed tariff: " << tariff.name << " with ID: " << tariff.id);
-            tariff_plans.push_back(tariff);
+            plans.push_back(tariff);
         }
-        LOG(LogLevel::INFO, "Tariff plans loaded successfully from " << filename << ". Total tariffs: " << tariff_plans.size());
+        // Каталог заменяется целиком только после успешного разбора всего файла
+        auto catalog = std::make_shared<TariffCatalog>();
+        catalog->version = tariff_catalog_version.load(std::memory_order_relaxed) + 1;
+        catalog->plans = std::move(plans);
+        const size_t total = catalog->plans.size();
+        std::atomic_store(&tariff_catalog, std::shared_ptr<const TariffCatalog>(std::move(catalog)));
+        tariff_catalog_version.fetch_add(1, std::memory_order_release);
+        LOG(LogLevel::INFO, "Tariff plans loaded successfully from " << filename << ". Total tariffs: " << total);
     } catch (const nlohmann::json::exception& e) {
         LOG(LogLevel::L_ERROR, "Failed to parse tariff plans JSON or access data: " << e.what());
     } catch (const std::exception& e) {
@@ -71,25 +97,66 @@ void load_tariff_plans(const std::string& filename) {
 
 std::vector<std::string> get_all_tariff_main_ids() {
     std::vector<std::string> ids;
-    for (const auto& tariff : tariff_plans) {
+    const auto catalog = get_tariff_catalog();
+    for (const auto& tariff : catalog->plans) {
         ids.push_back(tariff.id);
     }
     return ids;
 }
 
 TariffPlan get_tariff_by_id(const std::string& id) {
-    for (const auto& tariff : tariff_plans) {
-        if (tariff.id == id) {
-            return tariff;
-        }
+    const auto catalog = get_tariff_catalog();
+    const int index = catalog->find(id);
+    if (index >= 0) {
+        return catalog->plans[index];
     }
     LOG(LogLevel::L_WARNING, "Tariff not found by ID: " << id);
     return TariffPlan{};
 }
 
+const TariffPlan& TariffSelection::plan() const {
+    static const TariffPlan empty{};
+    return catalog && has_tariff() ? catalog->plans[tariff] : empty;
+}
+
+const TariffSpeedOption& TariffSelection::speed_option() const {
+    static const TariffSpeedOption empty{};
+    return catalog && has_tariff() && has_speed() ? catalog->plans[tariff].speeds[speed] : empty;
+}
+
+bool TariffSelection::select_tariff(const std::string& id) {
+    auto current = get_tariff_catalog();
+    const int index = current->find(id);
+    if (index < 0) {
+        return false;
+    }
+    catalog = std::move(current);
+    tariff = static_cast<int16_t>(index);
+    speed = -1;
+    return true;
+}
+
+bool TariffSelection::select_speed(const std::string& value, const std::string& unit) {
+    const auto& speeds = plan().speeds;
+    for (size_t i = 0; i < speeds.size(); ++i) {
+        if (speeds[i].value == value && speeds[i].unit == unit) {
+            speed = static_cast<int16_t>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TariffSelection::clear() {
+    catalog.reset();
+    tariff = -1;
+    speed = -1;
+}
+
 std::vector<std::string> get_all_unique_speeds() {
     std::set<std::string> unique_speeds;
-    for (const auto& tariff : tariff_plans) {
+    const auto catalog = get_tariff_catalog();
+    for (const auto& tariff : catalog->plans) {
         for (const auto& speed_option : tariff.speeds) {
             unique_speeds.insert(speed_option.get_full_speed_text());
         }
@@ -174,12 +241,13 @@ TgBot::InlineKeyboardMarkup::Ptr create_tariff_main_buttons() {
     std::vector<TgBot::InlineKeyboardButton::Ptr> row;
     int buttons_per_row = 1;
 
-    if (tariff_plans.empty()) {
-        LOG(LogLevel::L_WARNING, "Attempted to create tariff buttons but tariff_plans vector is empty.");
+    const auto catalog = get_tariff_catalog();
+    if (catalog->plans.empty()) {
+        LOG(LogLevel::L_WARNING, "Attempted to create tariff buttons but the tariff catalog is empty.");
         return keyboard; // Возвращаем пустую клавиатуру
     }
 
-    for (const auto& tariff : tariff_plans) {
+    for (const auto& tariff : catalog->plans) {
         auto btn = std::make_shared<TgBot::InlineKeyboardButton>();
         btn->text = tariff.name;
         btn->callbackData = "show_tariff_detail_" + tariff.id;
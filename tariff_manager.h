@@ -1,8 +1,10 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
 #include <set>
 #include <tgbot/tgbot.h>
 #include <sstream>
@@ -40,9 +42,41 @@ struct TariffPlan {
     std::string get_tariff_description() const;
 };
 
-extern std::vector<TariffPlan> tariff_plans;
+// Неизменяемый снимок каталога тарифов - единственная копия каталога в памяти.
+// load_tariff_plans публикует новый снимок, прежний живёт, пока на него ссылается
+// хотя бы одна сессия или читатель.
+struct TariffCatalog {
+    uint64_t version = 0;
+    std::vector<TariffPlan> plans;
+
+    // Индекс тарифа по id; -1, если его нет
+    int find(const std::string& id) const;
+};
+
+std::shared_ptr<const TariffCatalog> get_tariff_catalog();
+
+// Выбор тарифа в сессии: снимок каталога и индексы в нём вместо копий TariffPlan/TariffSpeedOption
+struct TariffSelection {
+    std::shared_ptr<const TariffCatalog> catalog;
+    int16_t tariff = -1;
+    int16_t speed = -1;
+
+    bool has_tariff() const { return tariff >= 0; }
+    bool has_speed() const { return speed >= 0; }
+    // Пустой план/скорость, если ничего не выбрано
+    const TariffPlan& plan() const;
+    const TariffSpeedOption& speed_option() const;
+
+    // Выбирает тариф в текущем каталоге и сбрасывает скорость; false - тарифа нет
+    bool select_tariff(const std::string& id);
+    // Выбирает скорость выбранного тарифа; false - такой нет
+    bool select_speed(const std::string& value, const std::string& unit);
+    void clear();
+};
 
 void load_tariff_plans(const std::string& filename);
+// Версия каталога тарифов: увеличивается при каждой успешной загрузке (для кеша HTTP-ответов)
+uint64_t get_tariff_catalog_version();
 
 std::vector<std::string> get_all_tariff_main_ids();
 TariffPlan get_tariff_by_id(const std::string& id);
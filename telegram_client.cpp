@@ -0,0 +1,135 @@
+#include "telegram_client.h"
+#include "metrics.h"
+#include "tracing.h"
+#include "update_recorder.h"
+
+// Должно совпадать с http_server.cpp: httplib.h - header-only, разные настройки в разных TU нарушают ODR
+#define CPPHTTPLIB_OPENSSL_SUPPORT
+#include "httplib.h"
+
+namespace
+{
+    // "/bot<token>/sendMessage" -> "sendMessage" (токен не должен попасть в метки)
+    std::string apiMethodName(const std::string &path)
+    {
+        size_t pos = path.rfind('/');
+        return pos == std::string::npos ? path : path.substr(pos + 1);
+    }
+
+    // Таймаут вызовов, кроме getUpdates (с запасом на загрузку документов)
+    constexpr std::int32_t kApiCallTimeoutSec = 30;
+
+    /**
+     * Клиент для Bot API по обычному HTTP (BoostHttpOnlySslClient умеет только HTTPS:443).
+     * Используется, когда api_base_url указывает на локальный сервер -
+     * например, на стенд нагрузочного тестирования bot_loadtest.
+     */
+    class PlainHttpClient : public TgBot::HttpClient
+    {
+    public:
+        std::string makeRequest(const TgBot::Url &url, const std::vector<TgBot::HttpReqArg> &args) const override
+        {
+            // host содержит и порт: "127.0.0.1:8081"
+            httplib::Client client("http://" + url.host);
+            client.set_connection_timeout(5);
+            client.set_read_timeout(_timeout + 5);
+
+            std::string path = url.path;
+            if (!url.query.empty())
+            {
+                path += "?" + url.query;
+            }
+
+            httplib::Result result;
+            bool has_files = false;
+            for (const auto &arg : args)
+            {
+                has_files = has_files || arg.isFile;
+            }
+
+            if (args.empty())
+            {
+                result = client.Get(path);
+            }
+            else if (has_files)
+            {
+                httplib::UploadFormDataItems items;
+                for (const auto &arg : args)
+                {
+                    items.push_back({arg.name, arg.value, arg.isFile ? arg.fileName : std::string(),
+                                     arg.isFile ? arg.mimeType : std::string()});
+                }
+                result = client.Post(path, items);
+            }
+            else
+            {
+                httplib::Params params;
+                for (const auto &arg : args)
+                {
+                    params.emplace(arg.name, arg.value);
+                }
+                result = client.Post(path, params);
+            }
+
+            if (!result)
+            {
+                throw std::runtime_error("HTTP request to " + url.host + " failed: " + httplib::to_string(result.error()));
+            }
+            return result->body;
+        }
+    };
+}
+
+InstrumentedHttpClient::InstrumentedHttpClient() : inner_(std::make_unique<TgBot::BoostHttpOnlySslClient>()),
+                                                   plain_(std::make_unique<PlainHttpClient>()),
+                                                   poll_(std::make_unique<TgBot::BoostHttpOnlySslClient>()),
+                                                   plain_poll_(std::make_unique<PlainHttpClient>())
+{
+    inner_->_timeout = kApiCallTimeoutSec;
+    plain_->_timeout = kApiCallTimeoutSec;
+}
+
+InstrumentedHttpClient::~InstrumentedHttpClient() = default;
+
+std::string InstrumentedHttpClient::makeRequest(const TgBot::Url &url, const std::vector<TgBot::HttpReqArg> &args) const
+{
+    std::string method = apiMethodName(url.path);
+    const bool plain = url.protocol == "http";
+    TgBot::HttpClient *selected = plain ? plain_.get() : inner_.get();
+    if (method == "getUpdates")
+    {
+        // TgLongPoll выставляет _timeout у клиента, переданного в Bot; пишется и читается
+        // только потоком long poll, остальные клиенты его не наследуют
+        selected = plain ? plain_poll_.get() : poll_.get();
+        selected->_timeout = _timeout;
+    }
+    TgBot::HttpClient &client = *selected;
+
+    auto &registry = MetricsRegistry::instance();
+    Histogram &latency = registry.histogram("bot_telegram_api_duration_seconds",
+                                            "Latency of outbound Telegram Bot API calls", {{"method", method}});
+    try
+    {
+        ScopedLatency timer(latency);
+        TraceSpan span("telegram", method);
+        std::string response = client.makeRequest(url, args);
+        if (response.find("\"ok\":false") != std::string::npos)
+        {
+            registry.counter("bot_telegram_api_errors_total", "Failed Telegram Bot API calls",
+                             {{"method", method}, {"kind", "api"}})
+                .inc();
+        }
+        else if (method == "getUpdates" && UpdateRecorder::instance().enabled())
+        {
+            UpdateRecorder::instance().recordGetUpdatesResponse(response);
+        }
+        return response;
+    }
+    catch (...)
+    {
+        registry.counter("bot_telegram_api_errors_total", "Failed Telegram Bot API calls",
+                         {{"method", method}, {"kind", "transport"}})
+            .inc();
+        throw;
+    }
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <tgbot/tgbot.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * InstrumentedHttpClient - обёртка над HTTP-клиентом tgbot-cpp.
+ * Все исходящие вызовы Telegram Bot API проходят через неё, что позволяет
+ * замерять латентность и ошибки по каждому методу (sendMessage, editMessageText, ...).
+ * Запросы к http://-адресам (локальный стенд Bot API) идут через отдельный plain-HTTP клиент.
+ * getUpdates (long poll) идёт через свои внутренние клиенты с таймаутом, который TgLongPoll
+ * выставляет в _timeout этого объекта; его вызывает только поток long poll. Остальные методы
+ * вызываются из любых потоков (бот, HTTP API, выгрузка, планировщик) через клиенты с
+ * фиксированным таймаутом, который после конструктора никто не меняет.
+ */
+class InstrumentedHttpClient : public TgBot::HttpClient
+{
+public:
+    InstrumentedHttpClient();
+    ~InstrumentedHttpClient() override;
+
+    std::string makeRequest(const TgBot::Url &url, const std::vector<TgBot::HttpReqArg> &args) const override;
+
+private:
+    std::unique_ptr<TgBot::HttpClient> inner_;
+    std::unique_ptr<TgBot::HttpClient> plain_;
+    std::unique_ptr<TgBot::HttpClient> poll_;
+    std::unique_ptr<TgBot::HttpClient> plain_poll_;
+};
@@ -0,0 +1,99 @@
+#include "tracing.h"
+#include <nlohmann/json.hpp>
+
+Tracer &Tracer::instance()
+{
+    static Tracer tracer;
+    return tracer;
+}
+
+Tracer::ThreadBuffer &Tracer::localBuffer()
+{
+    thread_local std::shared_ptr<ThreadBuffer> buffer;
+    if (!buffer)
+    {
+        buffer = std::make_shared<ThreadBuffer>();
+        buffer->tid = next_tid_.fetch_add(1, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(registry_mtx_);
+        buffers_.push_back(buffer);
+    }
+    return *buffer;
+}
+
+void Tracer::start()
+{
+    {
+        std::lock_guard<std::mutex> lock(registry_mtx_);
+        for (auto &buffer : buffers_)
+        {
+            std::lock_guard<std::mutex> buffer_lock(buffer->mtx);
+            buffer->events.clear();
+            buffer->dropped = 0;
+        }
+    }
+    enabled_.store(true, std::memory_order_relaxed);
+}
+
+void Tracer::stop()
+{
+    enabled_.store(false, std::memory_order_relaxed);
+}
+
+void Tracer::record(const char *category, std::string name, Clock::time_point start, Clock::time_point end)
+{
+    if (!enabled())
+    {
+        return;
+    }
+    auto ts = std::chrono::duration_cast<std::chrono::microseconds>(start - epoch_).count();
+    auto dur = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+    ThreadBuffer &buffer = localBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mtx);
+    if (buffer.events.size() >= kMaxEventsPerThread)
+    {
+        ++buffer.dropped;
+        return;
+    }
+    buffer.events.push_back({category, std::move(name), ts, dur});
+}
+
+std::string Tracer::exportChromeJson() const
+{
+    nlohmann::json events = nlohmann::json::array();
+    size_t dropped = 0;
+
+    std::lock_guard<std::mutex> lock(registry_mtx_);
+    for (const auto &buffer : buffers_)
+    {
+        std::lock_guard<std::mutex> buffer_lock(buffer->mtx);
+        dropped += buffer->dropped;
+        for (const auto &event : buffer->events)
+        {
+            events.push_back({{"name", event.name},
+                              {"cat", event.category},
+                              {"ph", "X"},
+                              {"ts", event.ts_us},
+                              {"dur", event.dur_us},
+                              {"pid", 1},
+                              {"tid", buffer->tid}});
+        }
+    }
+
+    nlohmann::json result = {{"traceEvents", events},
+                             {"displayTimeUnit", "ms"},
+                             {"otherData", {{"droppedEvents", dropped}}}};
+    return result.dump();
+}
+
+size_t Tracer::eventCount() const
+{
+    size_t total = 0;
+    std::lock_guard<std::mutex> lock(registry_mtx_);
+    for (const auto &buffer : buffers_)
+    {
+        std::lock_guard<std::mutex> buffer_lock(buffer->mtx);
+        total += buffer->events.size();
+    }
+    return total;
+}
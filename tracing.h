@@ -0,0 +1,119 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * Tracer - запись вложенных спанов обработки апдейта (dispatch -> handler -> db_* -> sendMessage)
+ * с выгрузкой в формате Chrome trace-event JSON (chrome://tracing, ui.perfetto.dev).
+ * Включается во время работы через HTTP API. Когда трассировка выключена,
+ * спан стоит одну relaxed-загрузку атомарного флага.
+ */
+class Tracer
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static Tracer &instance();
+
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    // Очищает буферы и включает запись
+    void start();
+    void stop();
+
+    // Добавляет завершённый спан в буфер текущего потока
+    void record(const char *category, std::string name, Clock::time_point start, Clock::time_point end);
+
+    std::string exportChromeJson() const;
+    size_t eventCount() const;
+
+    // Ограничение на количество событий в буфере одного потока
+    static constexpr size_t kMaxEventsPerThread = 200000;
+
+private:
+    Tracer() : epoch_(Clock::now()) {}
+    Tracer(const Tracer &) = delete;
+    Tracer &operator=(const Tracer &) = delete;
+
+    struct TraceEvent
+    {
+        const char *category;
+        std::string name;
+        int64_t ts_us;
+        int64_t dur_us;
+    };
+
+    // Буфер потока: пишет только владелец, мьютекс нужен лишь для выгрузки/очистки
+    struct ThreadBuffer
+    {
+        std::mutex mtx;
+        std::vector<TraceEvent> events;
+        uint32_t tid = 0;
+        size_t dropped = 0;
+    };
+
+    ThreadBuffer &localBuffer();
+
+    std::atomic<bool> enabled_{false};
+    const Clock::time_point epoch_;
+    std::atomic<uint32_t> next_tid_{1};
+
+    mutable std::mutex registry_mtx_;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+};
+
+/**
+ * TraceSpan - RAII-спан; при выключенной трассировке ничего не делает
+ */
+class TraceSpan
+{
+public:
+    TraceSpan(const char *category, const char *name)
+        : category_(category), static_name_(name), active_(Tracer::instance().enabled())
+    {
+        if (active_)
+        {
+            start_ = Tracer::Clock::now();
+        }
+    }
+
+    TraceSpan(const char *category, const std::string &name)
+        : category_(category), active_(Tracer::instance().enabled())
+    {
+        if (active_)
+        {
+            dynamic_name_ = name;
+            start_ = Tracer::Clock::now();
+        }
+    }
+
+    ~TraceSpan()
+    {
+        if (active_)
+        {
+            Tracer::instance().record(category_, static_name_ ? std::string(static_name_) : std::move(dynamic_name_),
+                                      start_, Tracer::Clock::now());
+        }
+    }
+
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+private:
+    const char *category_;
+    const char *static_name_ = nullptr;
+    std::string dynamic_name_;
+    bool active_;
+    Tracer::Clock::time_point start_;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+// Спан до конца текущей области видимости
+#define TRACE_SPAN(category, name) TraceSpan TRACE_CONCAT(trace_span_, __LINE__)(category, name)
@@ -1,11 +1,13 @@
 #include "trade_points.h"
 #include <nlohmann/json.hpp>
+#include <atomic>
 #include <fstream>
 #include <stdexcept>
 #include <vector>
 #include "logger.h"
 
 static nlohmann::json trade_points_data;
+static std::atomic<uint64_t> trade_points_version{0};
 
 void load_trade_points(const std::string &path)
 {
@@ -18,6 +20,7 @@ void load_trade_points(const std::string &path)
     try
     {
         trade_points_data = nlohmann::json::parse(f);
+        trade_points_version.fetch_add(1, std::memory_order_release);
         LOG(LogLevel::INFO, "Trade points loaded successfully from " << path);
     }
     catch (const nlohmann::json::parse_error &e)
@@ -60,4 +63,9 @@ std::vector<TradePoint> get_all_trade_points()
                           point.at("address").get<std::string>()});
     }
     return points;
-}
\ No newline at end of file
+}
+
+uint64_t get_trade_points_version()
+{
+    return trade_points_version.load(std::memory_order_acquire);
+}
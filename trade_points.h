@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <map> // Добавлено для map в get_all_trade_point_codes_with_addresses
@@ -13,4 +14,5 @@ struct TradePoint
 void load_trade_points(const std::string &path = "trade_points.json");
 bool get_address_by_code(const std::string &code, std::string &address);
 std::vector<std::string> get_all_trade_point_codes(); // Возвращает только коды
-std::vector<TradePoint> get_all_trade_points();       // Возвращает полные данные
\ No newline at end of file
+std::vector<TradePoint> get_all_trade_points();       // Возвращает полные данные
+uint64_t get_trade_points_version();                  // Увеличивается при каждой загрузке (для кеша HTTP-ответов)
\ No newline at end of file
@@ -0,0 +1,251 @@
+#include "update_dispatch.h"
+#include <nlohmann/json.hpp>
+#include <sstream>
+#include <string>
+#include "main.h"
+#include "config.h"
+#include "database.h"
+#include "session_manager.h"
+#include "trade_points.h"
+#include "application_flow.h"
+#include "admin_panel.h"
+#include "super_admin.h"
+#include "logger.h"
+#include "user_data_types.h"
+#include "metrics.h"
+#include "tracing.h"
+
+// Гистограмма латентности обработки входящего апдейта по его типу
+static Histogram &updateLatency(const std::string &type)
+{
+    return MetricsRegistry::instance().histogram("bot_update_duration_seconds", "Time spent handling an incoming update", {{"type", type}});
+}
+
+// После обработки апдейта ставит сессию чата в очередь на запись (обработчики меняют
+// поля UserData напрямую, и снимок нужен уже после всех изменений) и вытесняет
+// простаивающие сессии - здесь ссылок на UserData/AdminWorkMode уже никто не держит.
+// Поэтому обработчикам markDirty нужен, только если они меняют сессию другого чата
+struct SessionDirtyGuard
+{
+    int64_t chat_id;
+    ~SessionDirtyGuard()
+    {
+        SessionManager &sessions = SessionManager::instance();
+        sessions.markDirty(chat_id);
+        sessions.evictIdle();
+    }
+};
+
+void registerUpdateHandlers(TgBot::Bot &bot)
+{
+    bot.getEvents().onCommand("start", [&bot](TgBot::Message::Ptr message)
+                              {
+                                  ScopedLatency latency(updateLatency("command"));
+                                  TRACE_SPAN("dispatch", "command");
+                                  int64_t chat_id = message->chat->id;
+                                  SessionDirtyGuard dirty{chat_id};
+                                  LOG(LogLevel::INFO, "Received /start command from chat ID: " << chat_id);
+                                  if (chat_id == config.main_admin_id)
+                                  {
+                                      admin_work_mode[chat_id] = AdminWorkMode::ADMIN_VIEW;
+                                      sendSuperAdminPanel(bot, chat_id);
+                                  }
+                                  else
+                                  {
+                                      sendMainMenu(bot, chat_id);
+                                  }
+                              });
+
+    bot.getEvents().onAnyMessage([&bot](TgBot::Message::Ptr message)
+                                 {
+                                     ScopedLatency latency(updateLatency(message->webAppData ? "webapp_data" : "message"));
+                                     TRACE_SPAN("dispatch", message->webAppData ? "webapp_data" : "message");
+                                     int64_t chat_id = message->chat->id;
+                                     SessionDirtyGuard dirty{chat_id};
+                                     std::string text = message->text;
+                                     LOG(LogLevel::INFO, "Received message from chat ID: " << chat_id << ", text: " << text);
+
+                                     // --- СПЕЦИАЛЬНАЯ ОБРАБОТКА ДЛЯ ГЛАВНОГО АДМИНА ---
+                                     if (chat_id == config.main_admin_id)
+                                     {
+                                         // Режим подгружается из БД вместе с сессией при первом обращении
+                                         AdminWorkMode current_mode = SessionManager::instance().getAdminMode(chat_id);
+                                         LOG(LogLevel::INFO, "Message from main admin (ID: " << chat_id << "), detected work mode: " << static_cast<int>(current_mode));
+
+                                         UserData &user = user_session_data[chat_id];
+                                         if (user.state == UserState::ADMIN_REPLYING_TO_USER || user.state == UserState::AWAITING_ADMIN_PASSWORD)
+                                         {
+                                             handle_admin_panel_message(bot, message);
+                                             return;
+                                         }
+
+                                         handle_super_admin_message(bot, message);
+                                         return;
+                                     }
+
+                                     // --- ОБРАБОТКА СООБЩЕНИЙ ОБЫЧНЫХ ПОЛЬЗОВАТЕЛЕЙ И ОБЫЧНЫХ АДМИНОВ ---
+                                     if (!db_get_bot_status())
+                                     {
+                                         bot.getApi().sendMessage(chat_id, "Бот временно недоступен для обработки запросов. Пожалуйста, попробуйте позже.");
+                                         LOG(LogLevel::INFO, "Rejected message from user " << chat_id << " because bot is inactive.");
+                                         return;
+                                     }
+
+                                     UserData &user = user_session_data[chat_id];
+
+                                     // --- ОБРАБОТКА ДАННЫХ ИЗ WEBAPP ---
+                                     if (message->webAppData != nullptr)
+                                     {
+                                         LOG(LogLevel::INFO, "Received WebApp data from chat ID: " << chat_id);
+                                         try
+                                         {
+                                             nlohmann::json data = nlohmann::json::parse(message->webAppData->data);
+
+                                             // Заполняем UserData из JSON
+                                             user.flyer_code = data.value("tradePoint", "");
+                                             user.final_tariff_string = data.value("tariff", "") + " (" + data.value("speed", "") + ")";
+                                             user.name = data.value("name", "");
+                                             user.phone = data.value("phone", "");
+                                             user.email = data.value("email", "");
+                                             user.city = data.value("city", "");
+                                             user.street = data.value("street", "");
+                                             user.house = data.value("house", "");
+                                             user.apartment = data.value("apartment", "не указана");
+                                             user.needs_tv_box = data.value("needsTvBox", false);
+
+                                             // Получаем адрес офиса по коду торговой точки
+                                             std::string office_address;
+                                             get_address_by_code(user.flyer_code, office_address);
+
+                                             // Расчёт стоимости с учётом аренды роутера и ТВ-приставки
+                                             int tariff_price = 0;
+                                             int router_rental = 149; // Фиксированная аренда роутера
+                                             int tv_box_rental = 0;
+                                             try
+                                             {
+                                                 tariff_price = std::stoi(data.value("price", "0"));
+                                             }
+                                             catch (...)
+                                             {
+                                             }
+
+                                             if (user.needs_tv_box)
+                                             {
+                                                 tv_box_rental = 149; // Аренда ТВ-приставки
+                                             }
+
+                                             int total_monthly = tariff_price + router_rental + tv_box_rental;
+
+                                             std::string full_address = "г. " + user.city + ", ул. " + user.street + ", д. " + user.house;
+                                             if (!user.apartment.empty() && user.apartment != "не указана")
+                                             {
+                                                 full_address += ", кв. " + user.apartment;
+                                             }
+
+                                             const ApplicationInsertResult saved = db_add_application(chat_id, user, full_address, total_monthly);
+                                             if (saved.outcome == ApplicationInsertOutcome::Failed)
+                                             {
+                                                 // Данные формы остаются в сессии, меню с WebApp не сменяется - можно отправить снова
+                                                 LOG(LogLevel::L_ERROR, "WebApp application from " << chat_id << " was not saved");
+                                                 bot.getApi().sendMessage(chat_id, failedApplicationText());
+                                                 return;
+                                             }
+                                             if (saved.outcome == ApplicationInsertOutcome::Linked || saved.outcome == ApplicationInsertOutcome::Rejected)
+                                             {
+                                                 LOG(LogLevel::INFO, "WebApp application from " << chat_id << " duplicates #" << saved.original_id);
+                                                 bot.getApi().sendMessage(chat_id, duplicateApplicationText(saved.original_id));
+                                                 sendPostApplicationMenu(bot, chat_id);
+                                                 return;
+                                             }
+
+                                             std::stringstream confirmation;
+                                             confirmation << "✅ *Ваша заявка принята!*\n\n"
+                                                          << "Скоро с вами свяжутся для уточнения деталей.\n\n";
+                                             if (!office_address.empty())
+                                             {
+                                                 confirmation << "Для подключения интернета подойдите по адресу:\n*"
+                                                              << office_address << "*\n\n"
+                                                              << "**Не забудьте взять с собой паспорт!**";
+                                             }
+
+                                             bot.getApi().sendMessage(chat_id, confirmation.str(), false, 0, nullptr, "Markdown");
+
+                                             LOG(LogLevel::INFO, "WebApp application saved for user " << chat_id << ", total: " << total_monthly);
+                                         }
+                                         catch (const std::exception &e)
+                                         {
+                                             LOG(LogLevel::L_ERROR, "Failed to parse WebApp data: " << e.what());
+                                             bot.getApi().sendMessage(chat_id, "Ошибка обработки заявки. Попробуйте ещё раз.");
+                                         }
+                                         sendPostApplicationMenu(bot, chat_id);
+                                         return;
+                                     }
+
+                                     if (handle_main_menu_buttons(bot, message))
+                                     {
+                                         return;
+                                     }
+
+                                     std::string admin_trade_point;
+                                     if (db_is_admin_approved(chat_id, admin_trade_point))
+                                     {
+                                         if (user.state == UserState::ADMIN_REPLYING_TO_USER || user.state == UserState::AWAITING_ADMIN_PASSWORD)
+                                         {
+                                             handle_admin_panel_message(bot, message);
+                                             return;
+                                         }
+                                     }
+
+                                     switch (user.state)
+                                     {
+                                     case UserState::AWAITING_ADMIN_NAME:
+                                     case UserState::AWAITING_ADMIN_PASSWORD:
+                                     case UserState::ADMIN_PANEL:
+                                     case UserState::ADMIN_REPLYING_TO_USER:
+                                         handle_admin_panel_message(bot, message);
+                                         break;
+                                     default:
+                                         handle_client_message(bot, message);
+                                         break;
+                                     }
+                                 });
+
+    bot.getEvents().onCallbackQuery([&bot](TgBot::CallbackQuery::Ptr query)
+                                    {
+                                        ScopedLatency latency(updateLatency("callback_query"));
+                                        TRACE_SPAN("dispatch", "callback_query");
+                                        int64_t chat_id = query->message->chat->id;
+                                        SessionDirtyGuard dirty{chat_id};
+                                        LOG(LogLevel::INFO, "Received callback query from chat ID: " << chat_id << ", data: " << query->data);
+
+                                        // Режим подгружается из БД вместе с сессией при первом обращении
+                                        AdminWorkMode current_mode = SessionManager::instance().getAdminMode(chat_id);
+                                        LOG(LogLevel::INFO, "Callback query from chat ID: " << chat_id << ", detected work mode: " << static_cast<int>(current_mode));
+
+                                        if (chat_id == config.main_admin_id)
+                                        {
+                                            handle_super_admin_callbacks(bot, query);
+                                            if (query->data.rfind("admin_tp_", 0) == 0 || query->data.rfind("approve_", 0) == 0 || query->data.rfind("decline_", 0) == 0 || query->data.rfind("status_", 0) == 0 || query->data.rfind("contact_user_", 0) == 0 || query->data.rfind("chat_start_", 0) == 0)
+                                            {
+                                                handle_admin_callbacks(bot, query);
+                                            }
+                                            return;
+                                        }
+
+                                        if (!db_get_bot_status())
+                                        {
+                                            bot.getApi().answerCallbackQuery(query->id, "Бот временно недоступен.");
+                                            LOG(LogLevel::INFO, "Rejected callback from user " << chat_id << " because bot is inactive.");
+                                            return;
+                                        }
+
+                                        if (query->data.rfind("admin_tp_", 0) == 0 || query->data.rfind("approve_", 0) == 0 || query->data.rfind("decline_", 0) == 0 || query->data.rfind("status_", 0) == 0 || query->data.rfind("contact_user_", 0) == 0 || query->data.rfind("chat_start_", 0) == 0)
+                                        {
+                                            handle_admin_callbacks(bot, query);
+                                        }
+                                        else
+                                        {
+                                            handle_client_callback(bot, query);
+                                        }
+                                    });
+}
@@ -0,0 +1,7 @@
+#pragma once
+#include <tgbot/tgbot.h>
+
+// Подписывает бота на входящие апдейты (/start, сообщения, callback-запросы)
+// и направляет их в обработчики клиентов, админов и главного админа.
+// Используется основным ботом и драйвером воспроизведения bot_replay.
+void registerUpdateHandlers(TgBot::Bot &bot);
@@ -0,0 +1,243 @@
+#include "update_recorder.h"
+#include "logger.h"
+#include <chrono>
+#include <random>
+
+using json = nlohmann::json;
+
+namespace
+{
+    // Объекты, внутри которых поле "id" - это ID пользователя или чата
+    bool isIdentityObject(const std::string &key)
+    {
+        return key == "from" || key == "chat" || key == "user" || key == "sender_chat";
+    }
+
+    uint64_t nextRandom(uint64_t &state)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+
+    void appendCodePoint(std::string &out, uint32_t cp)
+    {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+UpdateRecorder &UpdateRecorder::instance()
+{
+    static UpdateRecorder recorder;
+    return recorder;
+}
+
+bool UpdateRecorder::open(const std::string &path, const std::vector<std::string> &scrub_fields,
+                          const std::vector<std::string> &keep_texts, bool pseudonymize_ids, int64_t keep_id)
+{
+    std::lock_guard<std::mutex> lock(mtx_);
+    file_.open(path, std::ios::app);
+    if (!file_.is_open())
+    {
+        LOG(LogLevel::L_ERROR, "Failed to open update recording file " << path);
+        return false;
+    }
+    scrub_fields_ = std::set<std::string>(scrub_fields.begin(), scrub_fields.end());
+    keep_texts_ = std::set<std::string>(keep_texts.begin(), keep_texts.end());
+    pseudonymize_ids_ = pseudonymize_ids;
+    keep_id_ = keep_id;
+    std::random_device rd;
+    salt_ = (static_cast<uint64_t>(rd()) << 32) ^ rd();
+    enabled_.store(true, std::memory_order_relaxed);
+    LOG(LogLevel::INFO, "Recording incoming updates to " << path);
+    return true;
+}
+
+void UpdateRecorder::close()
+{
+    enabled_.store(false, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (file_.is_open())
+    {
+        file_.close();
+    }
+}
+
+void UpdateRecorder::recordGetUpdatesResponse(const std::string &body)
+{
+    if (!enabled())
+    {
+        return;
+    }
+    int64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                         std::chrono::system_clock::now().time_since_epoch())
+                         .count();
+    try
+    {
+        json response = json::parse(body);
+        if (!response.value("ok", false) || !response.contains("result") || !response["result"].is_array() ||
+            response["result"].empty())
+        {
+            return;
+        }
+
+        std::string lines;
+        for (const auto &update : response["result"])
+        {
+            json scrubbed = scrub(update);
+            scrubbed["recorded_at_ms"] = now_ms;
+            lines += scrubbed.dump();
+            lines += '\n';
+        }
+
+        std::lock_guard<std::mutex> lock(mtx_);
+        file_ << lines;
+        file_.flush();
+    }
+    catch (const std::exception &e)
+    {
+        LOG(LogLevel::L_WARNING, "Failed to record getUpdates response: " << e.what());
+    }
+}
+
+json UpdateRecorder::scrub(const json &update) const
+{
+    json copy = update;
+    scrubNode(copy, "");
+    return copy;
+}
+
+void UpdateRecorder::scrubNode(json &node, const std::string &parent_key) const
+{
+    if (node.is_array())
+    {
+        for (auto &item : node)
+        {
+            scrubNode(item, parent_key);
+        }
+        return;
+    }
+    if (!node.is_object())
+    {
+        return;
+    }
+
+    for (auto &item : node.items())
+    {
+        const std::string &key = item.key();
+        json &value = item.value();
+
+        if (value.is_number_integer() && pseudonymize_ids_ &&
+            ((key == "id" && isIdentityObject(parent_key)) || key == "user_id"))
+        {
+            value = pseudonymizeId(value.get<int64_t>());
+        }
+        else if (value.is_string() && key == "data" && parent_key == "web_app_data")
+        {
+            // Данные WebApp - вложенный JSON с анкетой, маскируем его поля
+            try
+            {
+                json inner = json::parse(value.get<std::string>());
+                scrubNode(inner, key);
+                value = inner.dump();
+            }
+            catch (const json::parse_error &)
+            {
+                value = maskString(value.get<std::string>());
+            }
+        }
+        else if (value.is_string() && scrub_fields_.count(key))
+        {
+            const std::string text = value.get<std::string>();
+            // Команды и кнопки меню нужны для воспроизведения сценария
+            bool keep = key == "text" && (text.rfind('/', 0) == 0 || keep_texts_.count(text));
+            if (!keep)
+            {
+                value = maskString(text);
+            }
+        }
+        else if (value.is_structured())
+        {
+            scrubNode(value, key);
+        }
+    }
+}
+
+std::string UpdateRecorder::maskString(const std::string &value) const
+{
+    uint64_t state = hash(value) | 1;
+    size_t digits = 0;
+    for (char c : value)
+    {
+        digits += (c >= '0' && c <= '9');
+    }
+    // Телефон из 11 цифр (+7/8...) сохраняет код страны, иначе он перестанет проходить валидацию
+    bool keep_first_digit = digits == 11;
+
+    std::string out;
+    out.reserve(value.size());
+    for (size_t i = 0; i < value.size(); ++i)
+    {
+        unsigned char c = static_cast<unsigned char>(value[i]);
+        if (c >= '0' && c <= '9')
+        {
+            out += keep_first_digit ? static_cast<char>(c) : static_cast<char>('0' + nextRandom(state) % 10);
+            keep_first_digit = false;
+        }
+        else if (c >= 'a' && c <= 'z')
+        {
+            out += static_cast<char>('a' + nextRandom(state) % 26);
+        }
+        else if (c >= 'A' && c <= 'Z')
+        {
+            out += static_cast<char>('A' + nextRandom(state) % 26);
+        }
+        else if ((c == 0xD0 || c == 0xD1) && i + 1 < value.size())
+        {
+            uint32_t cp = ((c & 0x1F) << 6) | (static_cast<unsigned char>(value[i + 1]) & 0x3F);
+            if (cp == 0x401 || (cp >= 0x410 && cp <= 0x42F))
+            {
+                appendCodePoint(out, 0x410 + nextRandom(state) % 32);
+            }
+            else if (cp == 0x451 || (cp >= 0x430 && cp <= 0x44F))
+            {
+                appendCodePoint(out, 0x430 + nextRandom(state) % 32);
+            }
+            else
+            {
+                out.append(value, i, 2);
+            }
+            ++i;
+        }
+        else
+        {
+            out += static_cast<char>(c);
+        }
+    }
+    return out;
+}
+
+int64_t UpdateRecorder::pseudonymizeId(int64_t id) const
+{
+    if (id == keep_id_)
+    {
+        return id;
+    }
+    // Группы и каналы (отрицательные ID) остаются отрицательными
+    int64_t alias = 1000000000 + static_cast<int64_t>(hash(std::to_string(id)) % 1000000000);
+    return id < 0 ? -alias : alias;
+}
+
+uint64_t UpdateRecorder::hash(const std::string &value) const
+{
+    // FNV-1a с солью запуска
+    uint64_t h = 1469598103934665603ULL ^ salt_;
+    for (unsigned char c : value)
+    {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
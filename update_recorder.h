@@ -0,0 +1,54 @@
+#pragma once
+#include <nlohmann/json.hpp>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+/**
+ * UpdateRecorder - запись входящих апдейтов в JSONL (один Update на строку) для bot_replay.
+ * Апдейты берутся из сырого ответа getUpdates в InstrumentedHttpClient.
+ * Перед записью персональные данные маскируются с сохранением формы, чтобы
+ * при воспроизведении проходила та же валидация: телефон остаётся телефоном, email - email'ом.
+ * Маска детерминирована в пределах одного запуска (одинаковые значения -> одинаковые маски),
+ * соль случайная и нигде не сохраняется.
+ */
+class UpdateRecorder
+{
+public:
+    static UpdateRecorder &instance();
+
+    bool open(const std::string &path, const std::vector<std::string> &scrub_fields,
+              const std::vector<std::string> &keep_texts, bool pseudonymize_ids, int64_t keep_id);
+    void close();
+
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    // Разбирает ответ getUpdates и дописывает каждый апдейт с меткой recorded_at_ms
+    void recordGetUpdatesResponse(const std::string &body);
+
+    nlohmann::json scrub(const nlohmann::json &update) const;
+
+private:
+    UpdateRecorder() = default;
+    UpdateRecorder(const UpdateRecorder &) = delete;
+    UpdateRecorder &operator=(const UpdateRecorder &) = delete;
+
+    void scrubNode(nlohmann::json &node, const std::string &parent_key) const;
+    std::string maskString(const std::string &value) const;
+    int64_t pseudonymizeId(int64_t id) const;
+    uint64_t hash(const std::string &value) const;
+
+    std::atomic<bool> enabled_{false};
+    std::mutex mtx_;
+    std::ofstream file_;
+
+    std::set<std::string> scrub_fields_;
+    std::set<std::string> keep_texts_;
+    bool pseudonymize_ids_ = true;
+    int64_t keep_id_ = 0;
+    uint64_t salt_ = 0;
+};
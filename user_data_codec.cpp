@@ -0,0 +1,212 @@
+#include "user_data_codec.h"
+#include "user_data_types.h"
+
+namespace
+{
+    enum Flags : uint8_t
+    {
+        kNeedsTvBox = 1 << 0,
+        kIsEditing = 1 << 1,
+    };
+
+    void putVarint(std::string &out, uint64_t v)
+    {
+        while (v >= 0x80)
+        {
+            out += static_cast<char>((v & 0x7F) | 0x80);
+            v >>= 7;
+        }
+        out += static_cast<char>(v);
+    }
+
+    void putSigned(std::string &out, int64_t v)
+    {
+        putVarint(out, (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63));
+    }
+
+    void putString(std::string &out, const std::string &s)
+    {
+        putVarint(out, s.size());
+        out += s;
+    }
+
+    // Последовательное чтение с проверкой границ; после первой ошибки все чтения неуспешны
+    class Reader
+    {
+    public:
+        Reader(const uint8_t *p, size_t size) : p_(p), end_(p + size) {}
+
+        bool varint(uint64_t &v)
+        {
+            v = 0;
+            for (int shift = 0; shift < 64; shift += 7)
+            {
+                if (p_ == end_)
+                {
+                    return fail();
+                }
+                const uint8_t byte = *p_++;
+                v |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if (!(byte & 0x80))
+                {
+                    return true;
+                }
+            }
+            return fail();
+        }
+
+        bool signedInt(int64_t &v)
+        {
+            uint64_t raw;
+            if (!varint(raw))
+            {
+                return false;
+            }
+            v = static_cast<int64_t>(raw >> 1) ^ -static_cast<int64_t>(raw & 1);
+            return true;
+        }
+
+        bool string(std::string &s)
+        {
+            uint64_t len;
+            if (!varint(len))
+            {
+                return false;
+            }
+            if (len > static_cast<uint64_t>(end_ - p_))
+            {
+                return fail();
+            }
+            s.assign(reinterpret_cast<const char *>(p_), static_cast<size_t>(len));
+            p_ += len;
+            return true;
+        }
+
+        bool byte(uint8_t &b)
+        {
+            if (p_ == end_)
+            {
+                return fail();
+            }
+            b = *p_++;
+            return true;
+        }
+
+    private:
+        bool fail()
+        {
+            p_ = end_;
+            return false;
+        }
+
+        const uint8_t *p_;
+        const uint8_t *end_;
+    };
+}
+
+std::string encodeUserData(const UserData &user)
+{
+    std::string out;
+    out.reserve(128);
+    out += static_cast<char>(kUserDataFormatVersion);
+
+    putVarint(out, static_cast<uint64_t>(user.state));
+    uint8_t flags = 0;
+    if (user.needs_tv_box)
+        flags |= kNeedsTvBox;
+    if (user.is_editing)
+        flags |= kIsEditing;
+    out += static_cast<char>(flags);
+
+    putString(out, user.admin_trade_point);
+    putString(out, user.admin_name);
+    putSigned(out, user.new_admin_id_to_approve);
+    putString(out, user.temp_trade_point_code);
+    putString(out, user.flyer_code);
+    putString(out, user.office_address);
+
+    // Тариф - id в каталоге, скорость - номер в его списке (0 - не выбрана)
+    // (индекс тарифа в снимке каталога между перезапусками не стабилен, поэтому id)
+    putString(out, user.tariff.plan().id);
+    putVarint(out, user.tariff.has_speed() ? static_cast<uint64_t>(user.tariff.speed) + 1 : 0);
+
+    putString(out, user.final_tariff_string);
+    putSigned(out, user.base_price);
+    putString(out, user.name);
+    putString(out, user.phone);
+    putVarint(out, static_cast<uint64_t>(user.preferred_messenger));
+    putString(out, user.email);
+    putString(out, user.city);
+    putString(out, user.street);
+    putString(out, user.house);
+    putString(out, user.house_body);
+    putString(out, user.apartment);
+    putSigned(out, user.reply_to_user_id);
+    putSigned(out, user.current_application_id);
+    return out;
+}
+
+bool decodeUserData(const void *data, size_t size, UserData &user)
+{
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    if (size == 0 || bytes[0] == 0 || bytes[0] > kUserDataFormatVersion)
+    {
+        return false;
+    }
+    Reader r(bytes + 1, size - 1);
+    UserData decoded{};
+
+    uint64_t state = 0;
+    uint8_t flags = 0;
+    std::string tariff_id;
+    uint64_t speed_index = 0;
+    int64_t base_price = 0;
+    int64_t application_id = 0;
+    uint64_t messenger = 0;
+    std::string messenger_name; // версия 1 хранила название строкой
+    const uint8_t version = bytes[0];
+    const bool ok =
+        r.varint(state) && r.byte(flags) &&
+        r.string(decoded.admin_trade_point) && r.string(decoded.admin_name) &&
+        r.signedInt(decoded.new_admin_id_to_approve) && r.string(decoded.temp_trade_point_code) &&
+        r.string(decoded.flyer_code) && r.string(decoded.office_address) &&
+        r.string(tariff_id) && r.varint(speed_index) &&
+        r.string(decoded.final_tariff_string) && r.signedInt(base_price) &&
+        r.string(decoded.name) && r.string(decoded.phone) &&
+        (version >= 2 ? r.varint(messenger) : r.string(messenger_name)) &&
+        r.string(decoded.email) && r.string(decoded.city) && r.string(decoded.street) &&
+        r.string(decoded.house) && r.string(decoded.house_body) && r.string(decoded.apartment) &&
+        r.signedInt(decoded.reply_to_user_id) && r.signedInt(application_id);
+    if (!ok)
+    {
+        return false;
+    }
+
+    decoded.state = static_cast<UserState>(state);
+    decoded.needs_tv_box = flags & kNeedsTvBox;
+    decoded.is_editing = flags & kIsEditing;
+    decoded.base_price = static_cast<int>(base_price);
+    decoded.current_application_id = application_id;
+    if (version >= 2)
+    {
+        decoded.preferred_messenger = messenger <= static_cast<uint64_t>(Messenger::MAX) ? static_cast<Messenger>(messenger) : Messenger::NONE;
+    }
+    else
+    {
+        for (Messenger m : {Messenger::TELEGRAM, Messenger::WHATSAPP, Messenger::MAX})
+        {
+            if (messenger_name == messengerName(m))
+            {
+                decoded.preferred_messenger = m;
+            }
+        }
+    }
+    // Тариф мог исчезнуть из каталога после перезапуска - тогда выбор просто сбрасывается
+    if (!tariff_id.empty() && decoded.tariff.select_tariff(tariff_id) &&
+        speed_index > 0 && speed_index <= decoded.tariff.plan().speeds.size())
+    {
+        decoded.tariff.speed = static_cast<int16_t>(speed_index - 1);
+    }
+    user = std::move(decoded);
+    return true;
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+struct UserData;
+
+/**
+ * Компактная бинарная сериализация UserData для колонки sessions.DATA.
+ * Формат: байт версии, затем поля в фиксированном порядке - целые как varint
+ * (знаковые через zigzag), строки как varint-длина + байты, флаги одним байтом.
+ * Тариф хранится ссылкой на каталог (id + номер скорости), а не копией плана.
+ * Новая версия дописывает поля в конец или меняет кодировку поля; декодер читает
+ * блобы всех предыдущих версий (поля, которых в них нет, остаются по умолчанию).
+ */
+constexpr uint8_t kUserDataFormatVersion = 2; // 2: мессенджер - код Messenger вместо строки
+
+std::string encodeUserData(const UserData &user);
+
+// false - блоб повреждён или записан более новой версией (user не изменяется)
+bool decodeUserData(const void *data, size_t size, UserData &user);
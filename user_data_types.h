@@ -42,6 +42,34 @@ enum class UserState
     ADMIN_REPLYING_TO_USER // <--- ДОБАВЛЕНО
 };
 
+// Число состояний UserState (размер таблиц, индексируемых состоянием); ADMIN_REPLYING_TO_USER - последнее
+constexpr size_t kUserStateCount = static_cast<size_t>(UserState::ADMIN_REPLYING_TO_USER) + 1;
+
+// Предпочтительный мессенджер клиента для связи
+enum class Messenger : uint8_t
+{
+    NONE,
+    TELEGRAM,
+    WHATSAPP,
+    MAX
+};
+
+// Название мессенджера для сообщений и заявок ("" - не выбран)
+inline const char *messengerName(Messenger messenger)
+{
+    switch (messenger)
+    {
+    case Messenger::TELEGRAM:
+        return "Telegram";
+    case Messenger::WHATSAPP:
+        return "What'sApp";
+    case Messenger::MAX:
+        return "MAX";
+    default:
+        return "";
+    }
+}
+
 // Структура для хранения данных о заявке для отчета.
 struct ApplicationDataForReport
 {
@@ -58,37 +86,40 @@ struct ApplicationDataForReport
 };
 
 // Структура для хранения данных пользователя в сессии.
+// Тариф хранится ссылкой на снимок каталога, мелкие поля собраны вместе, чтобы не было выравнивания.
 struct UserData
 {
     UserState state = UserState::NONE;
+    int base_price = 0;
+    Messenger preferred_messenger = Messenger::NONE;
+    bool needs_tv_box = false;
+    bool is_editing = false;
+
+    int64_t new_admin_id_to_approve = 0;
+    int64_t reply_to_user_id = 0;
+    long long current_application_id = 0;
+
     std::string admin_trade_point;
     std::string admin_name;
-    int64_t new_admin_id_to_approve = 0;
     std::string temp_trade_point_code;
     std::string flyer_code;
     std::string office_address;
 
-    TariffPlan selected_tariff;
-    TariffSpeedOption selected_speed_option;
-
-    bool needs_tv_box = false;
+    TariffSelection tariff;
     std::string final_tariff_string;
-    int base_price = 0;
 
     std::string name;
     std::string phone;
-    std::string preferred_messenger;
     std::string email;
     std::string city;
     std::string street;
     std::string house;
     std::string house_body;
     std::string apartment;
-    bool is_editing = false;
-    int64_t reply_to_user_id = 0;
-    long long current_application_id = 0;
 };
 
-extern std::map<int64_t, std::string> &admin_otps;
-extern std::map<int64_t, UserData> &user_session_data;
-extern std::map<int64_t, AdminWorkMode> &admin_work_mode;
+// Обёртки над SessionManager (определены в session_manager.h)
+class UserSessionMap;
+class AdminModeMap;
+extern UserSessionMap user_session_data;
+extern AdminModeMap admin_work_mode;
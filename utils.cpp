@@ -1,18 +1,119 @@
 #include "utils.h"
-#include <algorithm>
-#include <cctype>
-#include <regex> // <-- Add this line
 
-bool isNotEmpty(const std::string& text) { return !text.empty(); }
+namespace {
+    bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+    // \w из прежнего регулярного выражения
+    bool isWordChar(char c) {
+        return isDigit(c) || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+    }
+
+    bool isEmailChar(char c) { return isWordChar(c) || c == '.' || c == '-'; }
+
+    // Длина пробельного символа в начале s (0 - не пробел)
+    size_t leadingSpaceLength(std::string_view s) {
+        const auto b = [&](size_t i) { return static_cast<unsigned char>(s[i]); };
+        const unsigned char c = b(0);
+        if (c == ' ' || (c >= '\t' && c <= '\r'))
+            return 1;
+        if (s.size() >= 2 && c == 0xC2 && (b(1) == 0xA0 || b(1) == 0x85)) // U+00A0, U+0085
+            return 2;
+        if (s.size() < 3)
+            return 0;
+        if (c == 0xE2 && b(1) == 0x80 && (b(2) <= 0x8B || b(2) == 0xA8 || b(2) == 0xA9 || b(2) == 0xAF)) // U+2000-U+200B, U+2028, U+2029, U+202F
+            return 3;
+        if ((c == 0xE2 && b(1) == 0x81 && b(2) == 0x9F) ||  // U+205F
+            (c == 0xE3 && b(1) == 0x80 && b(2) == 0x80) ||  // U+3000
+            (c == 0xE1 && b(1) == 0x9A && b(2) == 0x80) ||  // U+1680
+            (c == 0xEF && b(1) == 0xBB && b(2) == 0xBF))    // U+FEFF (BOM)
+            return 3;
+        return 0;
+    }
+
+    // Длина пробельного символа в конце s: последовательность UTF-8 не длиннее 3 байт
+    size_t trailingSpaceLength(std::string_view s) {
+        for (size_t len = 1; len <= 3 && len <= s.size(); ++len) {
+            if (leadingSpaceLength(s.substr(s.size() - len)) == len)
+                return len;
+        }
+        return 0;
+    }
+}
+
+bool isNotEmpty(std::string_view text) { return !text.empty(); }
+
+bool normalizePhone(std::string_view input, NormalizedPhone& out) {
+    char digits[11];
+    size_t count = 0;
+    for (char c : input) {
+        if (!isDigit(c))
+            continue;
+        if (count == sizeof(digits))
+            return false;
+        digits[count++] = c;
+    }
+    const char* national = digits;
+    if (count == 11 && (digits[0] == '7' || digits[0] == '8')) {
+        ++national;
+        --count;
+    }
+    if (count != 10)
+        return false;
+    out.data[0] = '+';
+    out.data[1] = '7';
+    for (size_t i = 0; i < 10; ++i)
+        out.data[2 + i] = national[i];
+    out.size = 12;
+    return true;
+}
 
 bool isValidPhone(std::string& phone) {
-    phone.erase(std::remove_if(phone.begin(), phone.end(), [](char c) { return !std::isdigit(c); }), phone.end());
-    if (phone.length() == 11 && (phone[0] == '7' || phone[0] == '8')) { phone = phone.substr(1); }
-    return phone.length() == 10;
+    NormalizedPhone normalized;
+    if (normalizePhone(phone, normalized)) {
+        phone.assign(normalized.national().data(), normalized.national().size());
+        return true;
+    }
+    // Как и раньше, неверный номер тоже очищается от посторонних символов
+    size_t n = 0;
+    for (char c : phone) {
+        if (isDigit(c))
+            phone[n++] = c;
+    }
+    phone.resize(n);
+    return false;
 }
 
-bool isValidEmail(const std::string& email) {
-    // Это более простое и совместимое регулярное выражение
-    const std::regex pattern(R"(^([\w\.\-]+)@([\w\.\-]+)\.([\w]{2,})$)");
-    return std::regex_match(email, pattern);
-}
\ No newline at end of file
+bool isValidEmail(std::string_view email) {
+    const size_t at = email.find('@');
+    if (at == 0 || at == std::string_view::npos)
+        return false;
+    for (size_t i = 0; i < at; ++i) {
+        if (!isEmailChar(email[i]))
+            return false;
+    }
+    const std::string_view domain = email.substr(at + 1);
+    const size_t dot = domain.rfind('.');
+    if (dot == 0 || dot == std::string_view::npos || domain.size() - dot - 1 < 2)
+        return false;
+    for (size_t i = 0; i < domain.size(); ++i) {
+        if (i > dot ? !isWordChar(domain[i]) : !isEmailChar(domain[i]))
+            return false;
+    }
+    return true;
+}
+
+std::string_view trimText(std::string_view text) {
+    while (!text.empty()) {
+        const size_t len = leadingSpaceLength(text);
+        if (len == 0)
+            break;
+        text.remove_prefix(len);
+    }
+    while (!text.empty()) {
+        const size_t len = trailingSpaceLength(text);
+        if (len == 0)
+            break;
+        text.remove_suffix(len);
+    }
+    return text;
+}
@@ -1,6 +1,31 @@
 #pragma once
+#include <cstddef>
 #include <string>
+#include <string_view>
 
-bool isNotEmpty(const std::string& text);
+// Проверки ввода анкеты работают со string_view и не выделяют память
+
+// Номер в формате E.164 ("+7XXXXXXXXXX") в буфере фиксированного размера
+struct NormalizedPhone {
+    static constexpr size_t kMaxSize = 16; // '+' и до 15 цифр
+    char data[kMaxSize];
+    size_t size = 0;
+
+    std::string_view e164() const { return std::string_view(data, size); }
+    // 10 цифр без кода страны - формат, в котором номер хранится в заявках
+    std::string_view national() const { return e164().substr(2); }
+};
+
+bool isNotEmpty(std::string_view text);
+
+// Российский номер: 10 цифр, либо 11 с первой 7 или 8; все символы кроме цифр игнорируются
+bool normalizePhone(std::string_view input, NormalizedPhone& out);
+// То же, но заменяет phone на 10 цифр номера (если номер верный)
 bool isValidPhone(std::string& phone);
-bool isValidEmail(const std::string& email);
\ No newline at end of file
+
+// local@domain.tld: local и domain из [A-Za-z0-9_.-], tld - не короче 2 символов [A-Za-z0-9_]
+bool isValidEmail(std::string_view email);
+
+// Убирает пробельные символы по краям, включая юникодные (NBSP, U+2000-U+200B, U+3000, BOM...);
+// многобайтовые последовательности UTF-8 не разрезаются
+std::string_view trimText(std::string_view text);
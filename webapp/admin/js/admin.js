@@ -12,12 +12,29 @@ let tradePoints = [];
 let tariffs = [];
 let botActive = true;
 
+// ========== AUTH ==========
+// Внутри Telegram запросы подписываются initData (проверяется сервером при webapp_auth.required)
+const tgInitData = window.Telegram?.WebApp?.initData || '';
+
+function apiFetch(url, options = {}) {
+    if (tgInitData) {
+        options.headers = { ...(options.headers || {}), 'Authorization': `tma ${tgInitData}` };
+    }
+    return fetch(url, options);
+}
+
+// EventSource не умеет задавать заголовки, поэтому initData передаётся в запросе
+function initDataQuery() {
+    return tgInitData ? `?initData=${encodeURIComponent(tgInitData)}` : '';
+}
+
 // ========== INITIALIZATION ==========
 document.addEventListener('DOMContentLoaded', () => {
     initNavigation();
     updateTime();
     setInterval(updateTime, 1000);
     loadAllData();
+    connectEvents();
 });
 
 function initNavigation() {
@@ -114,13 +131,13 @@ async function loadAllData() {
 }
 
 async function loadApplications() {
-    const response = await fetch(`${API_BASE}/applications`);
+    const response = await apiFetch(`${API_BASE}/applications`);
     if (!response.ok) throw new Error('Failed to load applications');
     applications = await response.json();
 }
 
 async function loadAdmins() {
-    const response = await fetch(`${API_BASE}/admins`);
+    const response = await apiFetch(`${API_BASE}/admins`);
     if (!response.ok) throw new Error('Failed to load admins');
     const data = await response.json();
     admins = data.admins || [];
@@ -128,19 +145,19 @@ async function loadAdmins() {
 }
 
 async function loadTradePoints() {
-    const response = await fetch(`${API_BASE}/trade-points`);
+    const response = await apiFetch(`${API_BASE}/trade-points`);
     if (!response.ok) throw new Error('Failed to load trade points');
     tradePoints = await response.json();
 }
 
 async function loadTariffs() {
-    const response = await fetch(`${API_BASE}/tariffs`);
+    const response = await apiFetch(`${API_BASE}/tariffs`);
     if (!response.ok) throw new Error('Failed to load tariffs');
     tariffs = await response.json();
 }
 
 async function loadBotStatus() {
-    const response = await fetch(`${API_BASE}/status`);
+    const response = await apiFetch(`${API_BASE}/status`);
     if (!response.ok) throw new Error('Failed to load bot status');
     const data = await response.json();
     botActive = data.active;
@@ -149,7 +166,7 @@ async function loadBotStatus() {
 
 async function loadStats() {
     try {
-        const response = await fetch(`${API_BASE}/stats`);
+        const response = await apiFetch(`${API_BASE}/stats`);
         if (response.ok) {
             const stats = await response.json();
             document.getElementById('statTotal').textContent = stats.totalApplications || 0;
@@ -166,6 +183,86 @@ function refreshData() {
     loadAllData();
 }
 
+// ========== LIVE UPDATES (SSE) ==========
+// Сервер присылает дельты через /api/events; списки целиком перечитываются только по resync
+let eventSource = null;
+
+function connectEvents() {
+    if (!window.EventSource) return;
+
+    eventSource = new EventSource(`${API_BASE}/events${initDataQuery()}`);
+
+    eventSource.addEventListener('application_created', (e) => {
+        const app = JSON.parse(e.data);
+        if (!applications.some(a => a.id === app.id)) {
+            applications.unshift(app);
+        }
+        renderApplicationsTable();
+        updateDashboard();
+    });
+
+    eventSource.addEventListener('application_status', (e) => {
+        const { id, status } = JSON.parse(e.data);
+        const app = applications.find(a => a.id === id);
+        if (app) {
+            app.status = status;
+            renderApplicationsTable();
+            updateDashboard();
+        }
+    });
+
+    eventSource.addEventListener('admin_requested', (e) => {
+        const req = JSON.parse(e.data);
+        pendingRequests = pendingRequests.filter(r => r.userId !== req.userId);
+        pendingRequests.push(req);
+        renderPendingRequests();
+    });
+
+    eventSource.addEventListener('admin_approved', (e) => {
+        const { userId } = JSON.parse(e.data);
+        const req = pendingRequests.find(r => r.userId === userId);
+        if (!req) {
+            loadAdmins().then(() => { renderAdminsList(); renderPendingRequests(); });
+            return;
+        }
+        pendingRequests = pendingRequests.filter(r => r.userId !== userId);
+        if (!admins.some(a => a.userId === userId)) {
+            admins.push({ ...req, status: 'active' });
+        }
+        renderAdminsList();
+        renderPendingRequests();
+    });
+
+    eventSource.addEventListener('admin_added', (e) => {
+        const admin = JSON.parse(e.data);
+        admins = admins.filter(a => a.userId !== admin.userId);
+        admins.push({ ...admin, status: 'active' });
+        pendingRequests = pendingRequests.filter(r => r.userId !== admin.userId);
+        renderAdminsList();
+        renderPendingRequests();
+    });
+
+    const removeAdmin = (e) => {
+        const { userId } = JSON.parse(e.data);
+        admins = admins.filter(a => a.userId !== userId);
+        pendingRequests = pendingRequests.filter(r => r.userId !== userId);
+        renderAdminsList();
+        renderPendingRequests();
+    };
+    eventSource.addEventListener('admin_declined', removeAdmin);
+    eventSource.addEventListener('admin_deleted', removeAdmin);
+
+    // Пропущенные события не восстановить - перечитываем всё
+    eventSource.addEventListener('resync', () => loadAllData());
+
+    eventSource.onerror = () => {
+        // Обрыв EventSource переподключает сам (с Last-Event-ID); закрытый поток (503) - повтор через 30 с
+        if (eventSource.readyState === EventSource.CLOSED) {
+            setTimeout(connectEvents, 30000);
+        }
+    };
+}
+
 // ========== RENDERING ==========
 function renderAll() {
     updateDashboard();
@@ -467,7 +564,7 @@ async function toggleBot() {
     updateBotStatusUI();
 
     try {
-        await fetch(`${API_BASE}/status`, {
+        await apiFetch(`${API_BASE}/status`, {
             method: 'POST',
             headers: { 'Content-Type': 'application/json' },
             body: JSON.stringify({ active: botActive })
@@ -548,7 +645,7 @@ async function addAdmin() {
     }
 
     try {
-        const response = await fetch(`${API_BASE}/admins`, {
+        const response = await apiFetch(`${API_BASE}/admins`, {
             method: 'POST',
             headers: { 'Content-Type': 'application/json' },
             body: JSON.stringify({ userId: parseInt(userId), name, tradePoint })
@@ -571,7 +668,7 @@ async function deleteAdmin(userId) {
     if (!confirm('Удалить этого администратора?')) return;
 
     try {
-        await fetch(`${API_BASE}/admins/${userId}`, { method: 'DELETE' });
+        await apiFetch(`${API_BASE}/admins/${userId}`, { method: 'DELETE' });
         await loadAdmins();
         renderAdminsList();
     } catch (error) {
@@ -581,7 +678,7 @@ async function deleteAdmin(userId) {
 
 async function approveAdmin(userId) {
     try {
-        await fetch(`${API_BASE}/admins/${userId}/approve`, { method: 'POST' });
+        await apiFetch(`${API_BASE}/admins/${userId}/approve`, { method: 'POST' });
         await loadAdmins();
         renderAdminsList();
         renderPendingRequests();
@@ -592,7 +689,7 @@ async function approveAdmin(userId) {
 
 async function declineAdmin(userId) {
     try {
-        await fetch(`${API_BASE}/admins/${userId}/decline`, { method: 'POST' });
+        await apiFetch(`${API_BASE}/admins/${userId}/decline`, { method: 'POST' });
         await loadAdmins();
         renderPendingRequests();
     } catch (error) {
@@ -607,7 +704,7 @@ async function updateApplicationStatus(appId, newStatus) {
         app.status = newStatus;
 
         try {
-            await fetch(`${API_BASE}/applications/${appId}/status`, {
+            await apiFetch(`${API_BASE}/applications/${appId}/status`, {
                 method: 'PATCH',
                 headers: { 'Content-Type': 'application/json' },
                 body: JSON.stringify({ status: newStatus })
@@ -646,7 +743,7 @@ async function addTradePoint() {
     }
 
     try {
-        const response = await fetch(`${API_BASE}/trade-points`, {
+        const response = await apiFetch(`${API_BASE}/trade-points`, {
             method: 'POST',
             headers: { 'Content-Type': 'application/json' },
             body: JSON.stringify({ code, address })
@@ -680,7 +777,7 @@ async function deleteTradePoint(code) {
     if (!confirm(`Удалить торговую точку ${code}?`)) return;
 
     try {
-        const response = await fetch(`${API_BASE}/trade-points/${code}`, { method: 'DELETE' });
+        const response = await apiFetch(`${API_BASE}/trade-points/${code}`, { method: 'DELETE' });
         if (response.ok) {
             await loadTradePoints();
             renderTradePoints();
@@ -743,7 +840,7 @@ async function sendBroadcast() {
     if (!confirm('Отправить сообщение всем пользователям?')) return;
 
     try {
-        await fetch(`${API_BASE}/broadcast`, {
+        await apiFetch(`${API_BASE}/broadcast`, {
             method: 'POST',
             headers: { 'Content-Type': 'application/json' },
             body: JSON.stringify({ message })